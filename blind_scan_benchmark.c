@@ -0,0 +1,338 @@
+/**
+ * @file blind_scan_benchmark.c
+ *
+ * @brief Benchmark of blind scan of the UHF band against the tdp_api simulator (see tdp_sim.c).
+ *
+ * Usage: blind_scan_benchmark [directory]
+ * Band 474-858 MHz is scanned in 8 MHz steps with growing number of occupied
+ * frequencies, once with one bandwidth per frequency and once with two. Every
+ * occupied frequency carries small capture (PAT and two PMTs) of its own
+ * transport stream, captures are written to given directory (default /tmp) and
+ * channel database of the scan is written there as well. Scan fails unless the
+ * database holds two channels per occupied frequency. Simulated lock time is
+ * taken from TDP_SIM_LOCK_DELAY_MS
+ * (default 100 ms). Total band scan time is printed next to the time empty
+ * frequencies would take if every one of them waited out fixed lock timeout.
+ */
+
+#include "stream_controller.h"
+#include "channel_database.h"
+#include "section_assembler.h"
+#include "timer_controller.h"
+#include "event_loop.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/* helper keywords needed only for benchmark */
+#define BENCHMARK_BAND_START 474 // MHz
+#define BENCHMARK_BAND_END 858
+#define BENCHMARK_BAND_STEP 8
+#define BENCHMARK_FIXED_LOCK_WAIT 10 // s, lock wait of tuning without early abort
+#define BENCHMARK_POLL_MS 10
+#define BENCHMARK_CAPTURE_REPEAT 100 // table packets in capture, capture is looped by simulator
+#define BENCHMARK_FILE_NAME_SIZE 512
+#define BENCHMARK_LIST_SIZE 512
+#define BENCHMARK_CAPTURE_FILE "blind_scan_benchmark_%u.ts" // filled in with frequency in MHz
+#define BENCHMARK_CHANNELS_PER_CAPTURE 2
+
+/* helper variables needed only for benchmark */
+static timerHandle pollTimer;
+
+/* helper functions needed only for benchmark */
+static uint8_t writeCapture(const char *fileName, uint16_t transportStreamId);
+static void writeSectionPacket(FILE *file, uint16_t pid, uint8_t continuityCounter, uint8_t *section, uint16_t size);
+static uint16_t finishSection(uint8_t *section, uint16_t size);
+static double runCase(uint32_t occupiedCount, uint32_t bandwidthCount);
+static uint32_t storedChannelCount();
+static void scanPoll();
+static double elapsedSeconds(const struct timespec *start, const struct timespec *end);
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t occupiedCounts[] = {1, 6, 24};
+    const char *directory = argc > 1 ? argv[1] : "/tmp";
+    uint32_t frequencyCount = (BENCHMARK_BAND_END - BENCHMARK_BAND_START) / BENCHMARK_BAND_STEP + 1;
+    uint32_t emptyCount;
+    uint32_t bandwidthCount;
+    uint32_t i;
+    double seconds;
+
+    if (chdir(directory))
+    {
+        printf("Entering %s failed!\n", directory);
+        return 1;
+    }
+
+    printf("band %u-%u MHz, step %u MHz, %u frequencies\n", BENCHMARK_BAND_START, BENCHMARK_BAND_END, BENCHMARK_BAND_STEP,
+           frequencyCount);
+
+    for (bandwidthCount = 1; bandwidthCount <= 2; bandwidthCount++)
+    {
+        for (i = 0; i < sizeof(occupiedCounts) / sizeof(occupiedCounts[0]); i++)
+        {
+            seconds = runCase(occupiedCounts[i], bandwidthCount);
+            if (seconds < 0)
+            {
+                printf("Scan failed!\n");
+                unlink(CHANNEL_DATABASE_FILE);
+                return 1;
+            }
+
+            /* frequency which locked is not tried with other bandwidths */
+            emptyCount = (frequencyCount - occupiedCounts[i]) * bandwidthCount;
+            printf("%u bandwidths %3u occupied %4u empty tries %9.1f ms total %6.1f ms per try, fixed lock wait %6u s\n",
+                   bandwidthCount, occupiedCounts[i], emptyCount, seconds * 1e3,
+                   seconds * 1e3 / (emptyCount + occupiedCounts[i]), emptyCount * BENCHMARK_FIXED_LOCK_WAIT);
+        }
+    }
+
+    unlink(CHANNEL_DATABASE_FILE);
+
+    return 0;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for writing capture with PAT of given transport stream and PMT of two programs, returns 0 on error.*/
+static uint8_t writeCapture(const char *fileName, uint16_t transportStreamId)
+{
+    static const uint8_t pmtBody[] = {
+        0xE0, 0x00, 0xF0, 0x00, // PCR PID filled in, no program descriptors
+        0x02, 0xE0, 0x00, 0xF0, 0x00,  // MPEG-2 video
+        0x03, 0xE0, 0x00, 0xF0, 0x00}; // MPEG audio
+    uint8_t pat[TS_PACKET_SIZE];
+    uint8_t pmt[2][TS_PACKET_SIZE];
+    uint16_t patSize;
+    uint16_t pmtSize[2];
+    uint16_t pmtPid;
+    FILE *file;
+    uint32_t i;
+    uint32_t j;
+
+    /* PAT with network entry and programs 1 and 2 */
+    memset(pat, 0, sizeof(pat));
+    pat[0] = 0x00;
+    pat[3] = transportStreamId >> 8;
+    pat[4] = transportStreamId & 0xFF;
+    for (i = 0; i < 3; i++)
+    {
+        pmtPid = i ? 0x0100 * i : 0x0010;
+        pat[8 + 4 * i + 1] = i;
+        pat[8 + 4 * i + 2] = 0xE0 | (pmtPid >> 8);
+        pat[8 + 4 * i + 3] = pmtPid & 0xFF;
+    }
+    patSize = finishSection(pat, 8 + 12);
+
+    /* PMT of program n on PID 0x0n00, video on 0x0n01 and audio on 0x0n02 */
+    for (i = 0; i < 2; i++)
+    {
+        memset(pmt[i], 0, TS_PACKET_SIZE);
+        memcpy(pmt[i] + 8, pmtBody, sizeof(pmtBody));
+        pmt[i][0] = 0x02;
+        pmt[i][4] = i + 1;
+        pmt[i][8] = 0xE0 | (i + 1);
+        pmt[i][9] = 0x01;
+        pmt[i][13] = 0xE0 | (i + 1);
+        pmt[i][14] = 0x01;
+        pmt[i][18] = 0xE0 | (i + 1);
+        pmt[i][19] = 0x02;
+        pmtSize[i] = finishSection(pmt[i], 8 + sizeof(pmtBody));
+    }
+
+    if ((file = fopen(fileName, "wb")) == NULL)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < BENCHMARK_CAPTURE_REPEAT; i++)
+    {
+        writeSectionPacket(file, 0x0000, i, pat, patSize);
+        for (j = 0; j < 2; j++)
+        {
+            writeSectionPacket(file, 0x0100 * (j + 1), i, pmt[j], pmtSize[j]);
+        }
+    }
+
+    return fclose(file) == 0;
+}
+
+/*Function for writing section which fits in one packet.*/
+static void writeSectionPacket(FILE *file, uint16_t pid, uint8_t continuityCounter, uint8_t *section, uint16_t size)
+{
+    uint8_t packet[TS_PACKET_SIZE];
+
+    memset(packet, 0xFF, TS_PACKET_SIZE);
+    packet[0] = TS_SYNC_BYTE;
+    packet[1] = 0x40 | (pid >> 8); // payload unit start
+    packet[2] = pid & 0xFF;
+    packet[3] = 0x10 | (continuityCounter & 0x0F);
+    packet[4] = 0x00; // pointer field
+    memcpy(packet + 5, section, size);
+
+    fwrite(packet, 1, TS_PACKET_SIZE, file);
+}
+
+/*Function for filling section length, common header fields and CRC, returns whole section size.*/
+static uint16_t finishSection(uint8_t *section, uint16_t size)
+{
+    uint16_t sectionLength = size + 4 - 3;
+    uint32_t crc;
+
+    section[1] = 0xB0 | (sectionLength >> 8);
+    section[2] = sectionLength & 0xFF;
+    section[5] = 0xC1;
+    section[6] = 0x00;
+    section[7] = 0x00;
+
+    crc = sectionCrc32(section, size);
+    section[size] = crc >> 24;
+    section[size + 1] = (crc >> 16) & 0xFF;
+    section[size + 2] = (crc >> 8) & 0xFF;
+    section[size + 3] = crc & 0xFF;
+
+    return size + 4;
+}
+
+/*Function for scanning band with given number of occupied frequencies, returns seconds or -1 on error.*/
+static double runCase(uint32_t occupiedCount, uint32_t bandwidthCount)
+{
+    uint32_t frequencyCount = (BENCHMARK_BAND_END - BENCHMARK_BAND_START) / BENCHMARK_BAND_STEP + 1;
+    char frequencies[BENCHMARK_LIST_SIZE];
+    char envName[BENCHMARK_FILE_NAME_SIZE];
+    char fileName[BENCHMARK_FILE_NAME_SIZE];
+    size_t length = 0;
+    initialConfig config;
+    struct timespec start;
+    struct timespec end;
+    int32_t nullFd;
+    int32_t stdoutFd;
+    uint8_t failed = 0;
+    uint32_t frequency;
+    uint32_t storedCount;
+    uint32_t i;
+
+    /* occupied frequencies are spread over band, tuner starts on first one, every one carries own transport stream */
+    memset(&config, 0, sizeof(initialConfig));
+    for (i = 0; i < occupiedCount; i++)
+    {
+        frequency = BENCHMARK_BAND_START + i * frequencyCount / occupiedCount * BENCHMARK_BAND_STEP;
+        length += snprintf(frequencies + length, BENCHMARK_LIST_SIZE - length, "%s%u", i ? "," : "", frequency);
+
+        snprintf(fileName, BENCHMARK_FILE_NAME_SIZE, BENCHMARK_CAPTURE_FILE, frequency);
+        snprintf(envName, BENCHMARK_FILE_NAME_SIZE, "TDP_SIM_TS_FILE_%u", frequency);
+        if (!writeCapture(fileName, i + 1))
+        {
+            printf("Writing %s failed!\n", fileName);
+            failed = 1;
+        }
+        setenv(envName, fileName, 1);
+    }
+    setenv("TDP_SIM_FREQUENCIES", frequencies, 1);
+
+    config.transponder.frequency = BENCHMARK_BAND_START;
+    config.transponder.bandwidth = 8;
+    config.transponder.module = DVB_T;
+    config.blindScanSet = 1;
+    config.blindScan.startFrequency = BENCHMARK_BAND_START;
+    config.blindScan.endFrequency = BENCHMARK_BAND_END;
+    config.blindScan.step = BENCHMARK_BAND_STEP;
+    config.blindScan.bandwidths[0] = 8;
+    config.blindScan.bandwidths[1] = 7;
+    config.blindScan.bandwidthCount = bandwidthCount;
+    config.blindScan.module = DVB_T;
+    unlink(CHANNEL_DATABASE_FILE);
+
+    /* stream controller reports every step, only timing is of interest here */
+    fflush(stdout);
+    stdoutFd = dup(STDOUT_FILENO);
+    nullFd = open("/dev/null", O_WRONLY);
+    dup2(nullFd, STDOUT_FILENO);
+
+    failed = failed || eventLoopInit() != EVENT_LOOP_NO_ERROR || timerControllerInit() != TIMER_CONTROLLER_NO_ERROR ||
+             streamControllerInit(&config) != STREAM_CONTROLLER_NO_ERROR;
+
+    if (!failed)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        failed = channelsSetup() != STREAM_CONTROLLER_NO_ERROR;
+        if (!failed)
+        {
+            timerSetAndStartMs(&pollTimer, BENCHMARK_POLL_MS, scanPoll);
+            eventLoopRun();
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        streamControllerDeinit();
+    }
+    timerControllerDeinit();
+    eventLoopDeinit();
+
+    fflush(stdout);
+    dup2(stdoutFd, STDOUT_FILENO);
+    close(stdoutFd);
+    close(nullFd);
+
+    /* scan which skipped occupied frequency would be faster, it does not count */
+    storedCount = failed ? 0 : storedChannelCount();
+    if (!failed && storedCount != occupiedCount * BENCHMARK_CHANNELS_PER_CAPTURE)
+    {
+        printf("%u occupied frequencies, %u channels expected, %u stored\n", occupiedCount,
+               occupiedCount * BENCHMARK_CHANNELS_PER_CAPTURE, storedCount);
+        failed = 1;
+    }
+
+    for (i = 0; i < occupiedCount; i++)
+    {
+        frequency = BENCHMARK_BAND_START + i * frequencyCount / occupiedCount * BENCHMARK_BAND_STEP;
+        snprintf(fileName, BENCHMARK_FILE_NAME_SIZE, BENCHMARK_CAPTURE_FILE, frequency);
+        snprintf(envName, BENCHMARK_FILE_NAME_SIZE, "TDP_SIM_TS_FILE_%u", frequency);
+        unlink(fileName);
+        unsetenv(envName);
+    }
+
+    return failed ? -1 : elapsedSeconds(&start, &end);
+}
+
+/*Function for counting channels in database written by scan, returns 0 if it cannot be loaded.*/
+static uint32_t storedChannelCount()
+{
+    Channels channels;
+    uint32_t count;
+    uint32_t i;
+
+    memset(&channels, 0, sizeof(Channels));
+    if (channelDatabaseLoad(CHANNEL_DATABASE_FILE, BENCHMARK_BAND_START, &channels) != CHANNEL_DATABASE_NO_ERROR)
+    {
+        return 0;
+    }
+
+    count = channels.channelCount;
+    for (i = 0; i < channels.channelCount; i++)
+    {
+        free(channels.channel[i].subtitles);
+    }
+    free(channels.channel);
+
+    return count;
+}
+
+/*Function for stopping event loop once scan is done, scan is checked every BENCHMARK_POLL_MS.*/
+static void scanPoll()
+{
+    pollTimer = 0;
+
+    if (channelsSetupRunning())
+    {
+        timerSetAndStartMs(&pollTimer, BENCHMARK_POLL_MS, scanPoll);
+        return;
+    }
+
+    eventLoopStop();
+}
+
+static double elapsedSeconds(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
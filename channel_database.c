@@ -0,0 +1,244 @@
+#include "channel_database.h"
+
+#include "section_assembler.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* helper keywords needed only for channel database module */
+#define TEMPORARY_SUFFIX ".tmp"
+
+/* helper functions needed only for channel database module */
+static void recordToChannel(const channelDatabaseRecord *record, channelData *channel);
+static void channelToRecord(const channelData *channel, channelDatabaseRecord *record);
+static channelDatabaseStatus writeAll(int32_t fileDescriptor, const uint8_t *data, size_t size);
+
+channelDatabaseStatus channelDatabaseLoad(const char *fileName, uint32_t frequency, Channels *channels)
+{
+    int32_t fileDescriptor;
+    struct stat fileStat;
+    uint8_t *mapping;
+    const channelDatabaseHeader *header;
+    const channelDatabaseRecord *records;
+    channelDatabaseStatus status = CHANNEL_DATABASE_ERROR;
+    uint32_t i;
+
+    fileDescriptor = open(fileName, O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        return CHANNEL_DATABASE_ERROR;
+    }
+
+    if (fstat(fileDescriptor, &fileStat) || fileStat.st_size < (off_t)sizeof(channelDatabaseHeader))
+    {
+        close(fileDescriptor);
+        return CHANNEL_DATABASE_ERROR;
+    }
+
+    mapping = (uint8_t *)mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    close(fileDescriptor);
+    if (mapping == MAP_FAILED)
+    {
+        return CHANNEL_DATABASE_ERROR;
+    }
+
+    header = (const channelDatabaseHeader *)mapping;
+    records = (const channelDatabaseRecord *)(mapping + sizeof(channelDatabaseHeader));
+
+    /* record count is checked against file size by division, so large count cannot overflow size on 32-bit */
+    if (header->magic != CHANNEL_DATABASE_MAGIC || header->formatVersion != CHANNEL_DATABASE_FORMAT_VERSION ||
+        header->frequency != frequency || !header->channelCount ||
+        (fileStat.st_size - sizeof(channelDatabaseHeader)) % sizeof(channelDatabaseRecord) ||
+        (fileStat.st_size - sizeof(channelDatabaseHeader)) / sizeof(channelDatabaseRecord) != header->channelCount ||
+        header->crc != sectionCrc32((const uint8_t *)records, header->channelCount * sizeof(channelDatabaseRecord)))
+    {
+        printf("channelDatabaseLoad: %s is stale or corrupted\n", fileName);
+        munmap(mapping, fileStat.st_size);
+        return CHANNEL_DATABASE_ERROR;
+    }
+
+    channels->channel = (channelData *)calloc(header->channelCount, sizeof(channelData));
+    if (channels->channel)
+    {
+        for (i = 0; i < header->channelCount; i++)
+        {
+            recordToChannel(&records[i], &channels->channel[i]);
+        }
+        channels->channelCount = header->channelCount;
+        channels->transportStreamId = header->transportStreamId;
+        channels->patVersion = header->patVersion;
+        channels->scanListCrc = header->scanListCrc;
+        channels->scanTime = header->scanTime;
+        status = CHANNEL_DATABASE_NO_ERROR;
+    }
+
+    munmap(mapping, fileStat.st_size);
+    return status;
+}
+
+channelDatabaseStatus channelDatabaseSave(const char *fileName, uint32_t frequency, Channels *channels)
+{
+    size_t size;
+    uint8_t *data;
+    channelDatabaseHeader *header;
+    channelDatabaseRecord *records;
+    char *temporaryName;
+    int32_t fileDescriptor;
+    channelDatabaseStatus status;
+    uint32_t i;
+
+    /* size is computed in 64 bits, count which does not fit size_t on 32-bit is refused */
+    if ((uint64_t)channels->channelCount * sizeof(channelDatabaseRecord) > SIZE_MAX - sizeof(channelDatabaseHeader))
+    {
+        return CHANNEL_DATABASE_ERROR;
+    }
+    size = sizeof(channelDatabaseHeader) + (size_t)channels->channelCount * sizeof(channelDatabaseRecord);
+
+    data = (uint8_t *)calloc(1, size);
+    temporaryName = (char *)malloc(strlen(fileName) + sizeof(TEMPORARY_SUFFIX));
+    if (!data || !temporaryName)
+    {
+        free(data);
+        free(temporaryName);
+        return CHANNEL_DATABASE_ERROR;
+    }
+
+    header = (channelDatabaseHeader *)data;
+    records = (channelDatabaseRecord *)(data + sizeof(channelDatabaseHeader));
+
+    for (i = 0; i < channels->channelCount; i++)
+    {
+        channelToRecord(&channels->channel[i], &records[i]);
+    }
+
+    header->magic = CHANNEL_DATABASE_MAGIC;
+    header->formatVersion = CHANNEL_DATABASE_FORMAT_VERSION;
+    header->transportStreamId = channels->transportStreamId;
+    header->frequency = frequency;
+    header->patVersion = channels->patVersion;
+    header->channelCount = channels->channelCount;
+    header->scanListCrc = channels->scanListCrc;
+    header->scanTime = channels->scanTime;
+    header->crc = sectionCrc32((const uint8_t *)records, channels->channelCount * sizeof(channelDatabaseRecord));
+
+    /* write complete file aside and rename it over the old one */
+    sprintf(temporaryName, "%s%s", fileName, TEMPORARY_SUFFIX);
+    fileDescriptor = open(temporaryName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fileDescriptor < 0)
+    {
+        free(data);
+        free(temporaryName);
+        return CHANNEL_DATABASE_ERROR;
+    }
+
+    status = writeAll(fileDescriptor, data, size);
+    if (fsync(fileDescriptor))
+    {
+        status = CHANNEL_DATABASE_ERROR;
+    }
+    close(fileDescriptor);
+
+    if (status != CHANNEL_DATABASE_NO_ERROR || rename(temporaryName, fileName))
+    {
+        unlink(temporaryName);
+        status = CHANNEL_DATABASE_ERROR;
+    }
+
+    free(data);
+    free(temporaryName);
+    return status;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for filling channel from database record, show data is left for EIT.*/
+static void recordToChannel(const channelDatabaseRecord *record, channelData *channel)
+{
+    uint8_t subtitleCount = record->subtitleCount;
+
+    if (subtitleCount > CHANNEL_DATABASE_MAX_SUBTITLES)
+    {
+        subtitleCount = CHANNEL_DATABASE_MAX_SUBTITLES;
+    }
+
+    channel->pmtProgramNumber = record->programNumber;
+    channel->pmtPid = record->pmtPid;
+    channel->pmtVersion = record->pmtVersion;
+    channel->transportStreamId = record->transportStreamId;
+    channel->transponder.frequency = record->frequency;
+    channel->transponder.bandwidth = record->bandwidth;
+    channel->transponder.module = (t_Module)record->module;
+
+    channel->channelInit.audioPID = record->audioPID;
+    channel->channelInit.videoPID = record->videoPID;
+    channel->channelInit.audioType = (tStreamType)record->audioType;
+    channel->channelInit.videoType = (tStreamType)record->videoType;
+
+    channel->presentShowStartTime = CONFIGURATION_PARSER_NOT_SET;
+    channel->presentShowDuration = CONFIGURATION_PARSER_NOT_SET;
+    channel->followingShowStartTime = CONFIGURATION_PARSER_NOT_SET;
+    channel->followingShowDuration = CONFIGURATION_PARSER_NOT_SET;
+
+    channel->subtitleCount = 0;
+    channel->subtitles = NULL;
+    if (subtitleCount)
+    {
+        channel->subtitles = (char *)malloc(subtitleCount * SUBTITLE_CHARACTERS_COUNT + 1);
+        if (channel->subtitles)
+        {
+            memcpy(channel->subtitles, record->subtitles, subtitleCount * SUBTITLE_CHARACTERS_COUNT);
+            channel->subtitles[subtitleCount * SUBTITLE_CHARACTERS_COUNT] = '\0';
+            channel->subtitleCount = subtitleCount;
+        }
+    }
+}
+
+/*Function for filling database record from channel.*/
+static void channelToRecord(const channelData *channel, channelDatabaseRecord *record)
+{
+    uint8_t subtitleCount = channel->subtitles ? channel->subtitleCount : 0;
+
+    if (subtitleCount > CHANNEL_DATABASE_MAX_SUBTITLES)
+    {
+        subtitleCount = CHANNEL_DATABASE_MAX_SUBTITLES;
+    }
+
+    record->programNumber = channel->pmtProgramNumber;
+    record->pmtPid = channel->pmtPid;
+    record->pmtVersion = channel->pmtVersion;
+    record->subtitleCount = subtitleCount;
+    record->transportStreamId = channel->transportStreamId;
+    record->frequency = channel->transponder.frequency;
+    record->bandwidth = channel->transponder.bandwidth;
+    record->module = channel->transponder.module;
+
+    record->audioPID = channel->channelInit.audioPID;
+    record->videoPID = channel->channelInit.videoPID;
+    record->audioType = channel->channelInit.audioType;
+    record->videoType = channel->channelInit.videoType;
+
+    memcpy(record->subtitles, channel->subtitles, subtitleCount * SUBTITLE_CHARACTERS_COUNT);
+}
+
+/*Function for writing whole buffer to file.*/
+static channelDatabaseStatus writeAll(int32_t fileDescriptor, const uint8_t *data, size_t size)
+{
+    ssize_t written;
+
+    while (size)
+    {
+        written = write(fileDescriptor, data, size);
+        if (written <= 0)
+        {
+            return CHANNEL_DATABASE_ERROR;
+        }
+        data += written;
+        size -= written;
+    }
+
+    return CHANNEL_DATABASE_NO_ERROR;
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
@@ -0,0 +1,79 @@
+#ifndef _CHANNEL_DATABASE_H_
+#define _CHANNEL_DATABASE_H_
+
+#include "stream_controller.h"
+#include "tables_parser.h"
+
+#define CHANNEL_DATABASE_FILE "channels.db"
+#define CHANNEL_DATABASE_MAGIC 0x42444843 // "CHDB"
+#define CHANNEL_DATABASE_FORMAT_VERSION 3
+#define CHANNEL_DATABASE_MAX_SUBTITLES 16
+
+typedef enum _channelDatabaseStatus
+{
+    CHANNEL_DATABASE_NO_ERROR = 0,
+    CHANNEL_DATABASE_ERROR
+} channelDatabaseStatus;
+
+/* file starts with header followed by channelCount fixed size records */
+typedef struct _channelDatabaseHeader
+{
+    uint32_t magic;
+    uint16_t formatVersion;
+    uint16_t transportStreamId; // of first transponder
+    uint32_t frequency;         // of first transponder
+    uint8_t patVersion;
+    uint8_t reserved[3];
+    uint32_t channelCount;
+    uint32_t scanListCrc; // CRC-32/MPEG-2 of transponders scanned
+    int64_t scanTime;     // seconds since epoch of full scan
+    uint32_t crc;         // CRC-32/MPEG-2 of all records
+    uint32_t padding;
+} channelDatabaseHeader;
+
+typedef struct _channelDatabaseRecord
+{
+    uint16_t programNumber;
+    uint16_t pmtPid;
+    uint8_t pmtVersion;
+    uint8_t subtitleCount;
+    uint16_t transportStreamId;
+    uint32_t frequency; // transponder the channel is received from
+    uint32_t bandwidth;
+    int32_t module;
+    uint32_t audioPID;
+    uint32_t videoPID;
+    int32_t audioType;
+    int32_t videoType;
+    char subtitles[CHANNEL_DATABASE_MAX_SUBTITLES * SUBTITLE_CHARACTERS_COUNT];
+} channelDatabaseRecord;
+
+/****************************************************************************
+ * @brief    Function for loading channel list saved by previous run.
+ *           File is memory mapped and validated (magic, format version,
+ *           frequency, size and CRC) before any record is used.
+ *
+ * @param    fileName - [in] Path to channel database file.
+ *           frequency - [in] Frequency in MHz the list has to belong to.
+ *           channels - [out] Channel list, allocated on success.
+ *
+ * @return   CHANNEL_DATABASE_NO_ERROR, if list is loaded.
+ *           CHANNEL_DATABASE_ERROR, if file is missing, stale or corrupted.
+****************************************************************************/
+channelDatabaseStatus channelDatabaseLoad(const char *fileName, uint32_t frequency, Channels *channels);
+
+/****************************************************************************
+ * @brief    Function for saving channel list. List is written to a temporary
+ *           file which then replaces the old one, so readers see either the
+ *           old or the new database, never a partial one.
+ *
+ * @param    fileName - [in] Path to channel database file.
+ *           frequency - [in] Frequency in MHz the list belongs to.
+ *           channels - [in] Channel list to save.
+ *
+ * @return   CHANNEL_DATABASE_NO_ERROR, if there are no errors.
+ *           CHANNEL_DATABASE_ERROR, in case of an error.
+****************************************************************************/
+channelDatabaseStatus channelDatabaseSave(const char *fileName, uint32_t frequency, Channels *channels);
+
+#endif // _CHANNEL_DATABASE_H_
@@ -0,0 +1,64 @@
+#include "command_queue.h"
+
+#include <string.h>
+
+void commandQueueReset(commandQueue *queue)
+{
+    memset(queue, 0, sizeof(commandQueue));
+}
+
+commandQueueStatus commandQueuePush(commandQueue *queue, const command *newCommand)
+{
+    uint32_t tail = queue->tail;
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+    if (tail - head == COMMAND_QUEUE_SIZE)
+    {
+        __atomic_store_n(&queue->dropped, queue->dropped + 1, __ATOMIC_RELAXED);
+        return COMMAND_QUEUE_FULL;
+    }
+
+    queue->commands[tail & (COMMAND_QUEUE_SIZE - 1)] = *newCommand;
+
+    /* release store publishes command before consumer can see new tail */
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&queue->pushed, queue->pushed + 1, __ATOMIC_RELAXED);
+    if (tail + 1 - head > queue->maxDepth)
+    {
+        __atomic_store_n(&queue->maxDepth, tail + 1 - head, __ATOMIC_RELAXED);
+    }
+
+    return COMMAND_QUEUE_NO_ERROR;
+}
+
+commandQueueStatus commandQueuePop(commandQueue *queue, command *nextCommand)
+{
+    uint32_t head = queue->head;
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+    {
+        return COMMAND_QUEUE_EMPTY;
+    }
+
+    *nextCommand = queue->commands[head & (COMMAND_QUEUE_SIZE - 1)];
+
+    /* slot may be reused by producer only after command is copied out */
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+
+    return COMMAND_QUEUE_NO_ERROR;
+}
+
+commandQueueStatistics commandQueueGetStatistics(commandQueue *queue)
+{
+    commandQueueStatistics statistics;
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+    statistics.pushed = __atomic_load_n(&queue->pushed, __ATOMIC_RELAXED);
+    statistics.dropped = __atomic_load_n(&queue->dropped, __ATOMIC_RELAXED);
+    statistics.maxDepth = __atomic_load_n(&queue->maxDepth, __ATOMIC_RELAXED);
+    statistics.depth = tail - head;
+
+    return statistics;
+}
@@ -0,0 +1,87 @@
+#ifndef _COMMAND_QUEUE_H_
+#define _COMMAND_QUEUE_H_
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#define COMMAND_QUEUE_SIZE 64 // commands, power of two
+#define COMMAND_QUEUE_CACHE_LINE 64
+
+typedef enum _commandQueueStatus
+{
+    COMMAND_QUEUE_NO_ERROR = 0,
+    COMMAND_QUEUE_FULL, // command was dropped
+    COMMAND_QUEUE_EMPTY
+} commandQueueStatus;
+
+typedef enum _commandType
+{
+    COMMAND_CHANNEL_UP = 0,
+    COMMAND_CHANNEL_DOWN,
+    COMMAND_CHANNEL_DIGIT, // digit is in argument
+    COMMAND_VOLUME_UP,
+    COMMAND_VOLUME_DOWN,
+    COMMAND_VOLUME_MUTE,
+    COMMAND_CHANNEL_INFO,
+    COMMAND_EXIT
+} commandType;
+
+/* decoded key press, time is key press time on CLOCK_MONOTONIC when timeValid is set */
+typedef struct _command
+{
+    commandType type;
+    uint8_t argument;
+    uint8_t timeValid;
+    struct timeval time;
+} command;
+
+typedef struct _commandQueueStatistics
+{
+    uint32_t pushed;
+    uint32_t dropped;
+    uint32_t depth;    // commands waiting now
+    uint32_t maxDepth; // most commands ever waiting
+} commandQueueStatistics;
+
+/* single producer, single consumer ring, indexes are on own cache lines so the two threads do not share one */
+typedef struct _commandQueue
+{
+    uint32_t tail __attribute__((aligned(COMMAND_QUEUE_CACHE_LINE))); // written by producer
+    uint32_t pushed;
+    uint32_t dropped;
+    uint32_t maxDepth;
+    uint32_t head __attribute__((aligned(COMMAND_QUEUE_CACHE_LINE))); // written by consumer
+    command commands[COMMAND_QUEUE_SIZE] __attribute__((aligned(COMMAND_QUEUE_CACHE_LINE)));
+} commandQueue;
+
+/*Function for emptying queue and resetting counters, neither thread may use queue meanwhile.*/
+void commandQueueReset(commandQueue *queue);
+
+/****************************************************************************
+ * @brief    Function for adding command to queue, called only from producer
+ *           thread. Never blocks, command is dropped when queue is full.
+ *
+ * @param    queue - [in] Command queue.
+ *           newCommand - [in] Command to copy into queue.
+ *
+ * @return   COMMAND_QUEUE_NO_ERROR, if command was added.
+ *           COMMAND_QUEUE_FULL, if command was dropped.
+****************************************************************************/
+commandQueueStatus commandQueuePush(commandQueue *queue, const command *newCommand);
+
+/****************************************************************************
+ * @brief    Function for taking oldest command from queue, called only from
+ *           consumer thread.
+ *
+ * @param    queue - [in] Command queue.
+ *           nextCommand - [out] Taken command.
+ *
+ * @return   COMMAND_QUEUE_NO_ERROR, if command was taken.
+ *           COMMAND_QUEUE_EMPTY, if there are no commands.
+****************************************************************************/
+commandQueueStatus commandQueuePop(commandQueue *queue, command *nextCommand);
+
+/*Function for getting queue depth and counters, can be called from any thread.*/
+commandQueueStatistics commandQueueGetStatistics(commandQueue *queue);
+
+#endif // _COMMAND_QUEUE_H_
@@ -0,0 +1,214 @@
+#include "config_watcher.h"
+#include "stream_controller.h"
+#include "timer_controller.h"
+#include "event_loop.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+/* helper keywords needed only for config watcher module */
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO)
+#define EVENT_BUFFER_SIZE 4096
+
+/* helper variables needed only for config watcher module */
+static char *watchedFile;
+static const char *watchedName; // file name without directory, as reported by inotify
+static initialConfig *currentConfig;
+static int32_t inotifyFd = -1;
+static timerHandle reloadTimer;
+
+/* helper functions needed only for config watcher module */
+static void inotifyReadable(int32_t fd, uint32_t events);
+static void reloadConfiguration();
+static uint8_t transponderChanged(transponderInit *current, transponderInit *changed);
+static uint8_t transponderListChanged(initialConfig *current, initialConfig *changed);
+static uint8_t channelChanged(startingChannelInit *current, startingChannelInit *changed);
+
+configWatcherStatus configWatcherInit(char *fileName, initialConfig *config)
+{
+    char directory[PATH_MAX];
+    const char *slash = strrchr(fileName, '/');
+
+    watchedFile = fileName;
+    watchedName = slash ? slash + 1 : fileName;
+    currentConfig = config;
+
+    if (!slash)
+    {
+        strcpy(directory, ".");
+    }
+    else if (slash == fileName)
+    {
+        strcpy(directory, "/");
+    }
+    else if (slash - fileName < PATH_MAX)
+    {
+        memcpy(directory, fileName, slash - fileName);
+        directory[slash - fileName] = '\0';
+    }
+    else
+    {
+        printf("configWatcherInit: path too long\n");
+        return CONFIG_WATCHER_ERROR;
+    }
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+    {
+        printf("configWatcherInit: %s\n", strerror(errno));
+        return CONFIG_WATCHER_ERROR;
+    }
+
+    if (inotify_add_watch(inotifyFd, directory, WATCH_EVENTS) < 0)
+    {
+        printf("configWatcherInit: watching %s fail (%s)\n", directory, strerror(errno));
+        close(inotifyFd);
+        inotifyFd = -1;
+        return CONFIG_WATCHER_ERROR;
+    }
+
+    if (eventLoopAddSource(inotifyFd, inotifyReadable) != EVENT_LOOP_NO_ERROR)
+    {
+        close(inotifyFd);
+        inotifyFd = -1;
+        return CONFIG_WATCHER_ERROR;
+    }
+
+    return CONFIG_WATCHER_NO_ERROR;
+}
+
+configWatcherStatus configWatcherDeinit()
+{
+    if (inotifyFd < 0)
+    {
+        return CONFIG_WATCHER_ERROR;
+    }
+
+    timerStopAndDelete(&reloadTimer);
+    eventLoopRemoveSource(inotifyFd);
+    close(inotifyFd);
+    inotifyFd = -1;
+
+    return CONFIG_WATCHER_NO_ERROR;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for reading inotify events of watched directory, reload is delayed until file stops changing.*/
+static void inotifyReadable(int32_t fd, uint32_t events)
+{
+    char buffer[EVENT_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event *event;
+    ssize_t length;
+    char *position;
+
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (position = buffer; position < buffer + length; position += sizeof(struct inotify_event) + event->len)
+        {
+            event = (const struct inotify_event *)position;
+            if (event->len && !strcmp(event->name, watchedName))
+            {
+                timerSetAndStartMs(&reloadTimer, CONFIG_WATCHER_SETTLE_MS, reloadConfiguration);
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * @brief    Function for parsing changed configuration file at timer trigger
+ *           and applying differences. Invalid file is reported and ignored,
+ *           running configuration stays in use.
+****************************************************************************/
+static void reloadConfiguration()
+{
+    initialConfig changed;
+
+    reloadTimer = 0;
+
+    printf("Configuration file %s changed\n", watchedFile);
+    if (parseConfigurationFile(watchedFile, &changed) != CONFIGURATION_PARSER_NO_ERROR)
+    {
+        printf("Configuration reload failed, previous configuration kept\n");
+        return;
+    }
+
+    if (transponderChanged(&currentConfig->transponder, &changed.transponder) || transponderListChanged(currentConfig, &changed))
+    {
+        printf("Configuration reload: transponders changed, tuning\n");
+        if (tuneTransponder(&changed) != STREAM_CONTROLLER_NO_ERROR)
+        {
+            printf("Configuration reload: tuneTransponder fail, previous configuration kept\n");
+            freeConfiguration(&changed);
+
+            /* streams and scan of running configuration were already stopped, it is tuned again */
+            if (tuneTransponder(currentConfig) != STREAM_CONTROLLER_NO_ERROR)
+            {
+                printf("Configuration reload: tuning previous transponder fail\n");
+            }
+            return;
+        }
+    }
+    else if (channelChanged(&currentConfig->startingChannel, &changed.startingChannel))
+    {
+        /* streams whose PID and type did not change are kept */
+        printf("Configuration reload: starting channel changed\n");
+        if (startPlayerStream(&changed.startingChannel) != STREAM_CONTROLLER_NO_ERROR)
+        {
+            printf("Configuration reload: startPlayerStream fail\n");
+        }
+    }
+    else
+    {
+        printf("Configuration reload: nothing to apply\n");
+    }
+
+    freeConfiguration(currentConfig);
+    *currentConfig = changed;
+}
+
+static uint8_t transponderChanged(transponderInit *current, transponderInit *changed)
+{
+    return current->frequency != changed->frequency || current->bandwidth != changed->bandwidth ||
+           current->module != changed->module;
+}
+
+/*Function for checking if scanned transponders or blind scan band changed, order counts as it decides order of channels.*/
+static uint8_t transponderListChanged(initialConfig *current, initialConfig *changed)
+{
+    uint32_t i;
+
+    if (current->transponderCount != changed->transponderCount || current->blindScanSet != changed->blindScanSet)
+    {
+        return 1;
+    }
+
+    if (current->blindScanSet && (current->blindScan.startFrequency != changed->blindScan.startFrequency ||
+                                  current->blindScan.endFrequency != changed->blindScan.endFrequency ||
+                                  current->blindScan.step != changed->blindScan.step ||
+                                  current->blindScan.module != changed->blindScan.module ||
+                                  current->blindScan.bandwidthCount != changed->blindScan.bandwidthCount ||
+                                  memcmp(current->blindScan.bandwidths, changed->blindScan.bandwidths,
+                                         current->blindScan.bandwidthCount * sizeof(uint32_t))))
+    {
+        return 1;
+    }
+
+    for (i = 0; i < current->transponderCount; i++)
+    {
+        if (transponderChanged(&current->transponders[i], &changed->transponders[i]))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static uint8_t channelChanged(startingChannelInit *current, startingChannelInit *changed)
+{
+    return current->audioPID != changed->audioPID || current->videoPID != changed->videoPID ||
+           current->audioType != changed->audioType || current->videoType != changed->videoType;
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
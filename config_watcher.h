@@ -0,0 +1,33 @@
+#ifndef _CONFIG_WATCHER_H_
+#define _CONFIG_WATCHER_H_
+
+#include "configuration_parser.h"
+
+#define CONFIG_WATCHER_SETTLE_MS 200 // file is reparsed once writes to it stop for this long
+
+typedef enum _configWatcherStatus
+{
+    CONFIG_WATCHER_NO_ERROR = 0,
+    CONFIG_WATCHER_ERROR
+} configWatcherStatus;
+
+/****************************************************************************
+ * @brief    Function for watching configuration file with inotify on event
+ *           loop. Directory of file is watched, so file replaced by rename
+ *           (as editors save) is noticed too. Changed file is parsed again
+ *           and only what differs is applied: tuner is locked again only if
+ *           transponder changed, starting channel streams are changed only if
+ *           their PIDs or types changed.
+ *
+ * @param    fileName - [in] Path of configuration file, has to stay valid until deinit.
+ *           config - [in] Configuration parsed at start, replaced on every applied reload.
+ *
+ * @return   CONFIG_WATCHER_NO_ERROR, if there are no errors.
+ *           CONFIG_WATCHER_ERROR, in case of an error.
+****************************************************************************/
+configWatcherStatus configWatcherInit(char *fileName, initialConfig *config);
+
+/*Function for stopping configuration file watch.*/
+configWatcherStatus configWatcherDeinit();
+
+#endif // _CONFIG_WATCHER_H_
@@ -1,12 +1,20 @@
 #include "configuration_parser.h"
 
+#include <stdlib.h>
+
 /* helper keywords needed only for configuration parser module */
 #define CONFIG_FILE_EXTENSION ".xml"
 #define INITIAL_CONFIG "initial_config"
 #define TRANSPONDER "transponder"
 #define STARTING_CHANNEL "starting_channel"
+#define CHANNEL "channel"
+#define BLIND_SCAN "blind_scan"
+#define START_FREQUENCY "start_frequency"
+#define END_FREQUENCY "end_frequency"
+#define STEP "step"
 #define FREQUENCY "frequency"
 #define BANDWIDTH "bandwidth"
+#define BANDWIDTH_MISSPELLED "bandwith" // accepted as well, shipped config.xml uses it
 #define MODULE "module"
 #define AUDIO_PID "audio_pid"
 #define VIDEO_PID "video_pid"
@@ -15,8 +23,10 @@
 #define MODULE_DVBT "DVB-T"
 #define MODULE_DVBT2 "DVB-T2"
 
-#define BUFFER_MAX 50     // maximum characters per line
-#define KEY_BUFFER_MAX 20 // maximum keyword characters
+#define READ_BUFFER_SIZE 4096 // file is read in blocks, lines may be of any length
+#define KEY_BUFFER_MAX 20     // maximum keyword characters, longer element names never match
+#define VALUE_BUFFER_MAX 20   // maximum value characters, longer values are cut
+#define LIST_INITIAL_SIZE 4   // list capacity is doubled when full
 
 /* macro function needed only for configuration parser module */
 #define ASSERT_PARSING_RESULT(x, y)            \
@@ -30,8 +40,56 @@
         }                                      \
     }
 
+typedef enum _xmlToken
+{
+    XML_TOKEN_OPEN = 0, // <name> or <name/>
+    XML_TOKEN_CLOSE,    // </name>, also returned right after <name/>
+    XML_TOKEN_END,
+    XML_TOKEN_ERROR
+} xmlToken;
+
+/* streaming tokenizer, text between tags is collected into value while tags are read */
+typedef struct _xmlTokenizer
+{
+    FILE *file;
+    char buffer[READ_BUFFER_SIZE];
+    size_t length;
+    size_t position;
+    char name[KEY_BUFFER_MAX];
+    char value[VALUE_BUFFER_MAX]; // trimmed text since last open tag
+    uint8_t valueLength;
+    uint8_t valuePending;  // whitespace seen after value text, added only if more text follows
+    uint8_t closePending;  // <name/> is reported as open and close
+    uint32_t line;
+} xmlTokenizer;
+
+/* element whose fields are being read */
+typedef enum _configSection
+{
+    SECTION_NONE = 0,
+    SECTION_TRANSPONDER,
+    SECTION_STARTING_CHANNEL,
+    SECTION_CHANNEL,
+    SECTION_BLIND_SCAN
+} configSection;
+
 /* helper functions needed only for configuration parser module */
+static xmlToken nextToken(xmlTokenizer *tokenizer);
+static int32_t nextChar(xmlTokenizer *tokenizer);
+static void addValueChar(xmlTokenizer *tokenizer, int32_t character);
+static configurationParserStatus readTagName(xmlTokenizer *tokenizer, int32_t character, uint8_t *selfClosing);
+static configurationParserStatus skipMarkup(xmlTokenizer *tokenizer);
+static void *appendEntry(void **list, uint32_t *count, uint32_t *capacity, size_t entrySize);
+static void setTransponderField(transponderInit *transponder, const char *key, const char *value);
+static void setChannelField(startingChannelInit *channel, const char *key, const char *value);
+static void setBlindScanField(blindScanInit *blindScan, const char *key, const char *value);
+static void initTransponder(transponderInit *transponder);
+static void initChannel(startingChannelInit *channel);
+static void initBlindScan(blindScanInit *blindScan);
 static void initValues(initialConfig *config);
+static configurationParserStatus checkTransponder(transponderInit *transponder);
+static configurationParserStatus checkChannel(startingChannelInit *channel);
+static configurationParserStatus checkBlindScan(blindScanInit *blindScan);
 static configurationParserStatus checkValues(initialConfig *config);
 static void printValues(initialConfig *config);
 
@@ -53,169 +111,467 @@ configurationParserStatus parseConfigurationFile(char *fileName, initialConfig *
         return CONFIGURATION_PARSER_ERROR;
     }
 
-    FILE *filePointer;
-    if ((filePointer = fopen(fileName, "r")) == NULL)
+    xmlTokenizer *tokenizer = malloc(sizeof(xmlTokenizer));
+    if (tokenizer == NULL)
+    {
+        printf("Error allocating memory !\n");
+        return CONFIGURATION_PARSER_ERROR;
+    }
+
+    if ((tokenizer->file = fopen(fileName, "r")) == NULL)
     {
         printf("Error opening configuration file.\n");
+        free(tokenizer);
         return CONFIGURATION_PARSER_ERROR;
     }
+    tokenizer->length = 0;
+    tokenizer->position = 0;
+    tokenizer->valueLength = 0;
+    tokenizer->valuePending = 0;
+    tokenizer->closePending = 0;
+    tokenizer->line = 1;
 
     initValues(config);
 
-    // https://stackoverflow.com/questions/22330969/using-fscanf-vs-fgets-and-sscanf
-    char buffer[BUFFER_MAX] = {0};  // buffer for storing read lines
-    char key[KEY_BUFFER_MAX] = {0}; // buffer for storing read keywords
-
-    /* helper flags */
-    int initialConfigFlag = 0;
-    int transponderFlag = 0;
-    int startingChannelFlag = 0;
-    int isStartingChannelSet = 0;
-    int isTranspoderSet = 0;
+    uint32_t transponderCapacity = 0;
+    uint32_t presetChannelCapacity = 0;
+    uint8_t initialConfigFlag = 0;
+    uint8_t isStartingChannelSet = 0;
+    configSection section = SECTION_NONE;
+    transponderInit *transponder = NULL;
+    startingChannelInit *channel = NULL;
+    startingChannelInit ignoredChannel;
+    configurationParserStatus status = CONFIGURATION_PARSER_NO_ERROR;
+    xmlToken token;
+
+    /* single forward pass, fields are stored as their closing tags are read */
+    while ((token = nextToken(tokenizer)) != XML_TOKEN_END)
+    {
+        if (token == XML_TOKEN_ERROR)
+        {
+            printf("Configuration file is not well-formed (line %u).\n", tokenizer->line);
+            status = CONFIGURATION_PARSER_ERROR;
+            break;
+        }
 
-    long initialConfigFilePointerLocation = 0; // stores filePointer location after initial_config keyword is read
+        if (!initialConfigFlag)
+        {
+            initialConfigFlag = token == XML_TOKEN_OPEN && !strcmp(tokenizer->name, INITIAL_CONFIG);
+            continue;
+        }
 
-    while (fgets(buffer, BUFFER_MAX, filePointer) != NULL)
-    {
-        if (sscanf(buffer, "<%[^>]", key) == 1)
+        if (token == XML_TOKEN_OPEN && section == SECTION_NONE)
         {
-            if (!strcmp(key, INITIAL_CONFIG))
+            if (!strcmp(tokenizer->name, TRANSPONDER))
             {
-                initialConfigFlag = 1;
-                initialConfigFilePointerLocation = ftell(filePointer);
+                transponder = appendEntry((void **)&config->transponders, &config->transponderCount, &transponderCapacity,
+                                          sizeof(transponderInit));
+                section = SECTION_TRANSPONDER;
+            }
+            else if (!strcmp(tokenizer->name, STARTING_CHANNEL))
+            {
+                /* only first starting channel is used, later ones are read into scratch entry */
+                channel = isStartingChannelSet ? &ignoredChannel : &config->startingChannel;
+                section = SECTION_STARTING_CHANNEL;
+            }
+            else if (!strcmp(tokenizer->name, CHANNEL))
+            {
+                channel = appendEntry((void **)&config->presetChannels, &config->presetChannelCount, &presetChannelCapacity,
+                                      sizeof(startingChannelInit));
+                section = SECTION_CHANNEL;
+            }
+            else if (!strcmp(tokenizer->name, BLIND_SCAN))
+            {
+                /* later blind scan elements replace earlier one */
+                config->blindScanSet = 1;
+                initBlindScan(&config->blindScan);
+                section = SECTION_BLIND_SCAN;
             }
-        }
 
-        while (initialConfigFlag)
+            if ((section == SECTION_TRANSPONDER && transponder == NULL) || (section == SECTION_CHANNEL && channel == NULL))
+            {
+                printf("Error allocating memory !\n");
+                status = CONFIGURATION_PARSER_ERROR;
+                break;
+            }
+            if (section == SECTION_TRANSPONDER)
+            {
+                initTransponder(transponder);
+            }
+            else if (section == SECTION_STARTING_CHANNEL || section == SECTION_CHANNEL)
+            {
+                initChannel(channel);
+            }
+        }
+        else if (token == XML_TOKEN_CLOSE)
         {
-            /* transponder node */
-            if (sscanf(buffer, " <%[^>]", key) == 1)
+            if (section == SECTION_NONE)
             {
-                if (!strcmp(key, TRANSPONDER) && !isTranspoderSet)
+                /* rest of file is not read */
+                if (!strcmp(tokenizer->name, INITIAL_CONFIG))
                 {
-                    transponderFlag = 1;
+                    break;
                 }
-
-                while (transponderFlag)
-                {
-                    if (sscanf(buffer, " <frequency>%[^<]", key) == 1)
-                    {
-                        config->transponder.frequency = atoi(key);
-                    }
-
-                    if (sscanf(buffer, " <bandwidth>%[^<]", key) == 1)
-                    {
-                        config->transponder.bandwidth = atoi(key);
-                    }
-
-                    if (sscanf(buffer, " <module>%[^<]", key) == 1)
-                    {
-                        if (!strcmp(key, MODULE_DVBT))
-                        {
-                            config->transponder.module = DVB_T;
-                        }
-                        if (!strcmp(key, MODULE_DVBT2))
-                        {
-                            config->transponder.module = DVB_T2;
-                        }
-                    }
-
-                    if (sscanf(buffer, " </%[^>]", key) == 1)
-                    {
-                        if (!strcmp(key, TRANSPONDER))
-                        {
-                            transponderFlag = 0;
-                            isTranspoderSet = 1;
-                            if (isTranspoderSet && !isStartingChannelSet)
-                            {
-                                fseek(filePointer, initialConfigFilePointerLocation, SEEK_SET);
-                            }
-                        }
-                    }
-                    fgets(buffer, BUFFER_MAX, filePointer);
-                } // transponder flag while
-            }     // transponder node if
-
-            /* starting_channel node */
-            if (sscanf(buffer, " <%[^>]", key) == 1)
+            }
+            else if (!strcmp(tokenizer->name, TRANSPONDER) || !strcmp(tokenizer->name, STARTING_CHANNEL) ||
+                     !strcmp(tokenizer->name, CHANNEL) || !strcmp(tokenizer->name, BLIND_SCAN))
             {
-                if (!strcmp(key, STARTING_CHANNEL) && !isStartingChannelSet)
-                {
-                    startingChannelFlag = 1;
-                }
-
-                while (startingChannelFlag)
-                {
-                    if (sscanf(buffer, " <audio_pid>%[^<]", key) == 1)
-                    {
-                        config->startingChannel.audioPID = atoi(key);
-                    }
-
-                    if (sscanf(buffer, " <video_pid>%[^<]", key) == 1)
-                    {
-                        config->startingChannel.videoPID = atoi(key);
-                    }
-
-                    if (sscanf(buffer, " <audio_type>%[^<]", key) == 1)
-                    {
-                        if (!strcmp(key, "ac3"))
-                        {
-                            config->startingChannel.audioType = AUDIO_TYPE_DOLBY_AC3;
-                        }
-                        if (!strcmp(key, "mpeg"))
-                        {
-                            config->startingChannel.audioType = AUDIO_TYPE_MPEG_AUDIO;
-                        }
-                    }
-
-                    if (sscanf(buffer, " <video_type>%[^<]", key) == 1)
-                    {
-                        if (!strcmp(key, "mpeg2"))
-                        {
-                            config->startingChannel.videoType = VIDEO_TYPE_MPEG2;
-                        }
-                    }
-
-                    if (sscanf(buffer, " </%[^>]", key) == 1)
-                    {
-                        if (!strcmp(key, STARTING_CHANNEL))
-                        {
-                            startingChannelFlag = 0;
-                            isStartingChannelSet = 1;
-                            if (isStartingChannelSet && !isTranspoderSet)
-                            {
-                                fseek(filePointer, initialConfigFilePointerLocation, SEEK_SET); // returns filePointer back to set location
-                            }
-                        }
-                    }
-                    fgets(buffer, BUFFER_MAX, filePointer);
-                } // starting_channel flag while
-            }     // starting_channel node if
-
-            if (sscanf(buffer, " </%[^>]", key) == 1)
+                isStartingChannelSet |= section == SECTION_STARTING_CHANNEL;
+                section = SECTION_NONE;
+            }
+            else if (section == SECTION_TRANSPONDER)
             {
-                if (!strcmp(key, INITIAL_CONFIG))
-                {
-                    initialConfigFlag = 0;
-                }
+                setTransponderField(transponder, tokenizer->name, tokenizer->value);
             }
-            fgets(buffer, BUFFER_MAX, filePointer);
-        } // while initialConfigFlag
-    }     // main while exit
+            else if (section == SECTION_BLIND_SCAN)
+            {
+                setBlindScanField(&config->blindScan, tokenizer->name, tokenizer->value);
+            }
+            else
+            {
+                setChannelField(channel, tokenizer->name, tokenizer->value);
+            }
+        }
+    }
 
-    fclose(filePointer);
+    fclose(tokenizer->file);
+    free(tokenizer);
 
-    if (checkValues(config) == CONFIGURATION_PARSER_NO_ERROR)
+    if (config->transponderCount)
+    {
+        config->transponder = config->transponders[0];
+    }
+
+    if (status == CONFIGURATION_PARSER_NO_ERROR && checkValues(config) == CONFIGURATION_PARSER_NO_ERROR)
     {
         printf("Configuration file parsed!\n");
         printValues(config);
         return CONFIGURATION_PARSER_NO_ERROR;
     }
 
+    freeConfiguration(config);
     printf("Configuration file parsing failed!\n");
     return CONFIGURATION_PARSER_ERROR;
 }
 
+void freeConfiguration(initialConfig *config)
+{
+    free(config->transponders);
+    config->transponders = NULL;
+    config->transponderCount = 0;
+
+    free(config->presetChannels);
+    config->presetChannels = NULL;
+    config->presetChannelCount = 0;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/****************************************************************************
+ * @brief    Function for reading next tag. Text read on the way is kept in
+ *           value, so on close tag value holds text of closed element.
+ *           Declarations, comments and attributes are skipped.
+ *
+ * @param    tokenizer - [in] Tokenizer with opened file.
+ *
+ * @return   XML_TOKEN_OPEN or XML_TOKEN_CLOSE, tag name is in name.
+ *           XML_TOKEN_END, at end of file.
+ *           XML_TOKEN_ERROR, if file ends inside of tag.
+****************************************************************************/
+static xmlToken nextToken(xmlTokenizer *tokenizer)
+{
+    int32_t character;
+    uint8_t selfClosing;
+
+    if (tokenizer->closePending)
+    {
+        tokenizer->closePending = 0;
+        tokenizer->value[0] = '\0';
+        return XML_TOKEN_CLOSE;
+    }
+
+    while ((character = nextChar(tokenizer)) != EOF)
+    {
+        if (character != '<')
+        {
+            addValueChar(tokenizer, character);
+            continue;
+        }
+
+        tokenizer->value[tokenizer->valueLength] = '\0';
+
+        character = nextChar(tokenizer);
+        if (character == '?' || character == '!')
+        {
+            if (skipMarkup(tokenizer) != CONFIGURATION_PARSER_NO_ERROR)
+            {
+                return XML_TOKEN_ERROR;
+            }
+            continue;
+        }
+
+        if (character == '/')
+        {
+            if (readTagName(tokenizer, nextChar(tokenizer), &selfClosing) != CONFIGURATION_PARSER_NO_ERROR)
+            {
+                return XML_TOKEN_ERROR;
+            }
+            tokenizer->valueLength = 0;
+            tokenizer->valuePending = 0;
+            return XML_TOKEN_CLOSE;
+        }
+
+        if (readTagName(tokenizer, character, &selfClosing) != CONFIGURATION_PARSER_NO_ERROR)
+        {
+            return XML_TOKEN_ERROR;
+        }
+        tokenizer->valueLength = 0;
+        tokenizer->valuePending = 0;
+        tokenizer->closePending = selfClosing;
+        return XML_TOKEN_OPEN;
+    }
+
+    return XML_TOKEN_END;
+}
+
+/*Function for getting next character of file, file is read in READ_BUFFER_SIZE blocks.*/
+static int32_t nextChar(xmlTokenizer *tokenizer)
+{
+    char character;
+
+    if (tokenizer->position == tokenizer->length)
+    {
+        tokenizer->length = fread(tokenizer->buffer, 1, READ_BUFFER_SIZE, tokenizer->file);
+        tokenizer->position = 0;
+        if (!tokenizer->length)
+        {
+            return EOF;
+        }
+    }
+
+    character = tokenizer->buffer[tokenizer->position++];
+    if (character == '\n')
+    {
+        tokenizer->line++;
+    }
+
+    return (unsigned char)character;
+}
+
+/*Function for adding text character to value, leading and trailing whitespace is left out.*/
+static void addValueChar(xmlTokenizer *tokenizer, int32_t character)
+{
+    if (character == ' ' || character == '\t' || character == '\n' || character == '\r')
+    {
+        tokenizer->valuePending = tokenizer->valueLength != 0;
+        return;
+    }
+
+    if (tokenizer->valuePending && tokenizer->valueLength < VALUE_BUFFER_MAX - 1)
+    {
+        tokenizer->value[tokenizer->valueLength++] = ' ';
+    }
+    tokenizer->valuePending = 0;
+
+    if (tokenizer->valueLength < VALUE_BUFFER_MAX - 1)
+    {
+        tokenizer->value[tokenizer->valueLength++] = character;
+    }
+}
+
+/*Function for reading tag name starting with given character, rest of tag up to '>' is skipped.*/
+static configurationParserStatus readTagName(xmlTokenizer *tokenizer, int32_t character, uint8_t *selfClosing)
+{
+    uint8_t length = 0;
+    int32_t quote = 0;
+    int32_t previous = 0;
+
+    while (character != EOF && character != '>' && character != '/' && character != ' ' && character != '\t' &&
+           character != '\n' && character != '\r')
+    {
+        if (length < KEY_BUFFER_MAX - 1)
+        {
+            tokenizer->name[length] = character;
+        }
+        length++;
+        character = nextChar(tokenizer);
+    }
+
+    /* too long name is left empty, so it matches no keyword */
+    tokenizer->name[length < KEY_BUFFER_MAX ? length : 0] = '\0';
+
+    /* attributes are skipped, '>' inside of quoted attribute value does not end tag */
+    while (character != EOF && (character != '>' || quote))
+    {
+        if (character == '"' || character == '\'')
+        {
+            quote = quote == character ? 0 : (quote ? quote : character);
+        }
+        if (character != ' ' && character != '\t' && character != '\n' && character != '\r')
+        {
+            previous = character;
+        }
+        character = nextChar(tokenizer);
+    }
+
+    *selfClosing = previous == '/';
+
+    return character == EOF ? CONFIGURATION_PARSER_ERROR : CONFIGURATION_PARSER_NO_ERROR;
+}
+
+/*Function for skipping declaration or comment whose "<?" or "<!" was read.*/
+static configurationParserStatus skipMarkup(xmlTokenizer *tokenizer)
+{
+    int32_t character;
+    uint8_t dashes = 0;
+    uint8_t comment;
+
+    character = nextChar(tokenizer);
+    comment = character == '-' && (character = nextChar(tokenizer)) == '-';
+    if (comment)
+    {
+        character = nextChar(tokenizer);
+    }
+
+    /* comment ends only at "-->", other markup at first '>' */
+    while (character != EOF && (character != '>' || (comment && dashes < 2)))
+    {
+        dashes = character == '-' ? dashes + 1 : 0;
+        character = nextChar(tokenizer);
+    }
+
+    return character == EOF ? CONFIGURATION_PARSER_ERROR : CONFIGURATION_PARSER_NO_ERROR;
+}
+
+/*Function for adding entry to end of list, list grows by doubling so adding stays linear in list size.*/
+static void *appendEntry(void **list, uint32_t *count, uint32_t *capacity, size_t entrySize)
+{
+    void *grown;
+
+    if (*count == *capacity)
+    {
+        grown = realloc(*list, (*capacity ? *capacity * 2 : LIST_INITIAL_SIZE) * entrySize);
+        if (grown == NULL)
+        {
+            return NULL;
+        }
+        *list = grown;
+        *capacity = *capacity ? *capacity * 2 : LIST_INITIAL_SIZE;
+    }
+
+    return (uint8_t *)*list + (*count)++ * entrySize;
+}
+
+static void setTransponderField(transponderInit *transponder, const char *key, const char *value)
+{
+    if (!strcmp(key, FREQUENCY))
+    {
+        transponder->frequency = atoi(value);
+    }
+    else if (!strcmp(key, BANDWIDTH) || !strcmp(key, BANDWIDTH_MISSPELLED))
+    {
+        transponder->bandwidth = atoi(value);
+    }
+    else if (!strcmp(key, MODULE))
+    {
+        if (!strcmp(value, MODULE_DVBT))
+        {
+            transponder->module = DVB_T;
+        }
+        if (!strcmp(value, MODULE_DVBT2))
+        {
+            transponder->module = DVB_T2;
+        }
+    }
+}
+
+static void setChannelField(startingChannelInit *channel, const char *key, const char *value)
+{
+    if (!strcmp(key, AUDIO_PID))
+    {
+        channel->audioPID = atoi(value);
+    }
+    else if (!strcmp(key, VIDEO_PID))
+    {
+        channel->videoPID = atoi(value);
+    }
+    else if (!strcmp(key, AUDIO_TYPE))
+    {
+        if (!strcmp(value, "ac3"))
+        {
+            channel->audioType = AUDIO_TYPE_DOLBY_AC3;
+        }
+        if (!strcmp(value, "mpeg"))
+        {
+            channel->audioType = AUDIO_TYPE_MPEG_AUDIO;
+        }
+    }
+    else if (!strcmp(key, VIDEO_TYPE))
+    {
+        if (!strcmp(value, "mpeg2"))
+        {
+            channel->videoType = VIDEO_TYPE_MPEG2;
+        }
+    }
+}
+
+static void setBlindScanField(blindScanInit *blindScan, const char *key, const char *value)
+{
+    if (!strcmp(key, START_FREQUENCY))
+    {
+        blindScan->startFrequency = atoi(value);
+    }
+    else if (!strcmp(key, END_FREQUENCY))
+    {
+        blindScan->endFrequency = atoi(value);
+    }
+    else if (!strcmp(key, STEP))
+    {
+        blindScan->step = atoi(value);
+    }
+    else if (!strcmp(key, BANDWIDTH) || !strcmp(key, BANDWIDTH_MISSPELLED))
+    {
+        if (blindScan->bandwidthCount < BLIND_SCAN_MAX_BANDWIDTHS)
+        {
+            blindScan->bandwidths[blindScan->bandwidthCount++] = atoi(value);
+        }
+    }
+    else if (!strcmp(key, MODULE))
+    {
+        if (!strcmp(value, MODULE_DVBT))
+        {
+            blindScan->module = DVB_T;
+        }
+        if (!strcmp(value, MODULE_DVBT2))
+        {
+            blindScan->module = DVB_T2;
+        }
+    }
+}
+
+static void initTransponder(transponderInit *transponder)
+{
+    transponder->frequency = CONFIGURATION_PARSER_NOT_SET;
+    transponder->bandwidth = CONFIGURATION_PARSER_NOT_SET;
+    transponder->module = CONFIGURATION_PARSER_NOT_SET;
+}
+
+static void initChannel(startingChannelInit *channel)
+{
+    channel->audioPID = CONFIGURATION_PARSER_NOT_SET;
+    channel->videoPID = CONFIGURATION_PARSER_NOT_SET;
+    channel->audioType = CONFIGURATION_PARSER_NOT_SET;
+    channel->videoType = CONFIGURATION_PARSER_NOT_SET;
+}
+
+static void initBlindScan(blindScanInit *blindScan)
+{
+    blindScan->startFrequency = CONFIGURATION_PARSER_NOT_SET;
+    blindScan->endFrequency = CONFIGURATION_PARSER_NOT_SET;
+    blindScan->step = CONFIGURATION_PARSER_NOT_SET;
+    blindScan->bandwidthCount = 0;
+    blindScan->module = DVB_T;
+}
+
 /****************************************************************************
  * @brief    Function for setting variables to initial value. Values are used for later validation.
  *
@@ -223,13 +579,61 @@ configurationParserStatus parseConfigurationFile(char *fileName, initialConfig *
 ****************************************************************************/
 static void initValues(initialConfig *config)
 {
-    config->transponder.frequency = CONFIGURATION_PARSER_NOT_SET;
-    config->transponder.bandwidth = CONFIGURATION_PARSER_NOT_SET;
-    config->transponder.module = CONFIGURATION_PARSER_NOT_SET;
-    config->startingChannel.audioPID = CONFIGURATION_PARSER_NOT_SET;
-    config->startingChannel.videoPID = CONFIGURATION_PARSER_NOT_SET;
-    config->startingChannel.audioType = CONFIGURATION_PARSER_NOT_SET;
-    config->startingChannel.videoType = CONFIGURATION_PARSER_NOT_SET;
+    initTransponder(&config->transponder);
+    initChannel(&config->startingChannel);
+    config->transponders = NULL;
+    config->transponderCount = 0;
+    config->presetChannels = NULL;
+    config->presetChannelCount = 0;
+    config->blindScanSet = 0;
+    initBlindScan(&config->blindScan);
+}
+
+static configurationParserStatus checkTransponder(transponderInit *transponder)
+{
+    ASSERT_PARSING_RESULT(transponder->frequency, "Frequency");
+
+    ASSERT_PARSING_RESULT(transponder->bandwidth, "Bandwidth");
+
+    ASSERT_PARSING_RESULT(transponder->module, "Module");
+
+    return CONFIGURATION_PARSER_NO_ERROR;
+}
+
+static configurationParserStatus checkChannel(startingChannelInit *channel)
+{
+    ASSERT_PARSING_RESULT(channel->audioPID, "Channel audio PID");
+
+    ASSERT_PARSING_RESULT(channel->videoPID, "Channel video PID");
+
+    ASSERT_PARSING_RESULT(channel->audioType, "Channel audio type");
+
+    ASSERT_PARSING_RESULT(channel->videoType, "Channel video type");
+
+    return CONFIGURATION_PARSER_NO_ERROR;
+}
+
+static configurationParserStatus checkBlindScan(blindScanInit *blindScan)
+{
+    ASSERT_PARSING_RESULT(blindScan->startFrequency, "Blind scan start frequency");
+
+    ASSERT_PARSING_RESULT(blindScan->endFrequency, "Blind scan end frequency");
+
+    ASSERT_PARSING_RESULT(blindScan->step, "Blind scan step");
+
+    if (!blindScan->bandwidthCount)
+    {
+        printf("Blind scan bandwidth not set.\n");
+        return CONFIGURATION_PARSER_ERROR;
+    }
+
+    if (!blindScan->step || blindScan->endFrequency < blindScan->startFrequency)
+    {
+        printf("Blind scan band is empty.\n");
+        return CONFIGURATION_PARSER_ERROR;
+    }
+
+    return CONFIGURATION_PARSER_NO_ERROR;
 }
 
 /****************************************************************************
@@ -242,19 +646,41 @@ static void initValues(initialConfig *config)
 ****************************************************************************/
 static configurationParserStatus checkValues(initialConfig *config)
 {
-    ASSERT_PARSING_RESULT(config->transponder.frequency, "Frequency");
+    uint32_t i;
 
-    ASSERT_PARSING_RESULT(config->transponder.bandwidth, "Bandwidth");
-
-    ASSERT_PARSING_RESULT(config->transponder.module, "Module");
+    if (checkTransponder(&config->transponder) != CONFIGURATION_PARSER_NO_ERROR)
+    {
+        return CONFIGURATION_PARSER_ERROR;
+    }
 
-    ASSERT_PARSING_RESULT(config->startingChannel.audioPID, "Initial channel audio PID");
+    if (checkChannel(&config->startingChannel) != CONFIGURATION_PARSER_NO_ERROR)
+    {
+        printf("Initial channel is not complete.\n");
+        return CONFIGURATION_PARSER_ERROR;
+    }
 
-    ASSERT_PARSING_RESULT(config->startingChannel.videoPID, "Initial channel video PID");
+    for (i = 1; i < config->transponderCount; i++)
+    {
+        if (checkTransponder(&config->transponders[i]) != CONFIGURATION_PARSER_NO_ERROR)
+        {
+            printf("Transponder %u is not complete.\n", i + 1);
+            return CONFIGURATION_PARSER_ERROR;
+        }
+    }
 
-    ASSERT_PARSING_RESULT(config->startingChannel.audioType, "Initial channel audio type");
+    for (i = 0; i < config->presetChannelCount; i++)
+    {
+        if (checkChannel(&config->presetChannels[i]) != CONFIGURATION_PARSER_NO_ERROR)
+        {
+            printf("Preset channel %u is not complete.\n", i + 1);
+            return CONFIGURATION_PARSER_ERROR;
+        }
+    }
 
-    ASSERT_PARSING_RESULT(config->startingChannel.videoType, "Initial channel video type");
+    if (config->blindScanSet && checkBlindScan(&config->blindScan) != CONFIGURATION_PARSER_NO_ERROR)
+    {
+        return CONFIGURATION_PARSER_ERROR;
+    }
 
     return CONFIGURATION_PARSER_NO_ERROR;
 }
@@ -274,5 +700,11 @@ static void printValues(initialConfig *config)
     printf("\tvideoPID: %d\n", config->startingChannel.videoPID);
     printf("\taudioType: %d\n", config->startingChannel.audioType);
     printf("\tvideoType: %d\n", config->startingChannel.videoType);
+    printf("\ttransponders: %u\n", config->transponderCount);
+    printf("\tpreset channels: %u\n", config->presetChannelCount);
+    if (config->blindScanSet)
+    {
+        printf("\tblind scan: %u-%u MHz, step %u MHz, %u bandwidths\n", config->blindScan.startFrequency,
+               config->blindScan.endFrequency, config->blindScan.step, config->blindScan.bandwidthCount);
+    }
 }
-
@@ -20,6 +20,8 @@ static inline void textColor(int32_t attr, int32_t fg, int32_t bg)
     printf("%s", command);
 }
 
+#define BLIND_SCAN_MAX_BANDWIDTHS 4
+
 // https://stackoverflow.com/questions/742699/returning-an-enum-from-a-function-in-c
 typedef enum _configurationParserStatus
 {
@@ -43,14 +45,43 @@ typedef struct _startingChannelInit
     tStreamType videoType;
 } startingChannelInit;
 
+/* band walked by blind scan, frequencies are in MHz */
+typedef struct _blindScanInit
+{
+    uint32_t startFrequency;
+    uint32_t endFrequency;
+    uint32_t step;
+    uint32_t bandwidths[BLIND_SCAN_MAX_BANDWIDTHS]; // tried in order on every frequency until one locks
+    uint32_t bandwidthCount;
+    t_Module module;
+} blindScanInit;
+
+/* configuration file layout, elements may come in any order and on any number of lines:
+   <initial_config>
+       <transponder> frequency, bandwidth, module </transponder>                    one or more, first is tuned
+       <starting_channel> audio_pid, video_pid, audio_type, video_type </starting_channel>
+       <channel> same as starting_channel </channel>                                any number of preset channels
+       <blind_scan> start_frequency, end_frequency, step, bandwidth, module </blind_scan>
+                    optional, bandwidth may repeat, module defaults to DVB-T; band replaces transponders in channel scan
+   </initial_config> */
 typedef struct _initialConfig
 {
-    transponderInit transponder;
+    transponderInit transponder; // first transponder of file
     startingChannelInit startingChannel;
+
+    transponderInit *transponders; // all transponders in file order
+    uint32_t transponderCount;
+    startingChannelInit *presetChannels;
+    uint32_t presetChannelCount;
+
+    uint8_t blindScanSet;
+    blindScanInit blindScan;
 } initialConfig;
 
 /****************************************************************************
  * @brief    Function for loading and parsing initial .xml configuration file.
+ *           File is read once from start to end, lists have to be freed with
+ *           freeConfiguration.
  *
  * @param    fileName - [in] Full path to configuration file.
  *           config - [in] Pointer to structure variable in which loaded parameters are stored.
@@ -60,4 +91,7 @@ typedef struct _initialConfig
 ****************************************************************************/
 configurationParserStatus parseConfigurationFile(char *fileName, initialConfig *config);
 
+/*Function for freeing transponder and preset channel lists of parsed configuration.*/
+void freeConfiguration(initialConfig *config);
+
 #endif // _CONFIGURATION_PARSER_H_
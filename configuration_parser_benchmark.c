@@ -0,0 +1,163 @@
+/**
+ * @file configuration_parser_benchmark.c
+ *
+ * @brief Benchmark of configuration file parsing on large generated configurations.
+ *
+ * Usage: configuration_parser_benchmark [directory]
+ * Configurations with growing number of transponders and preset channels are
+ * written to given directory (default /tmp), once with one element per line
+ * and once with whole document on a single line. Time per entry should stay
+ * the same as configuration grows.
+ */
+
+#include "configuration_parser.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/* helper keywords needed only for benchmark */
+#define BENCHMARK_ROUNDS 5
+#define BENCHMARK_FILE_NAME_SIZE 512
+
+/* helper functions needed only for benchmark */
+static long generateConfig(const char *fileName, uint32_t entryCount, uint8_t singleLine);
+static double runParser(char *fileName, uint32_t entryCount);
+static double elapsedSeconds(const struct timespec *start, const struct timespec *end);
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t entryCounts[] = {1000, 10000, 100000};
+    char fileName[BENCHMARK_FILE_NAME_SIZE];
+    const char *directory = argc > 1 ? argv[1] : "/tmp";
+    double seconds;
+    long fileSize;
+    uint32_t i;
+    uint8_t singleLine;
+
+    printf("best of %d rounds, entries are transponders plus preset channels\n", BENCHMARK_ROUNDS);
+
+    for (singleLine = 0; singleLine < 2; singleLine++)
+    {
+        for (i = 0; i < sizeof(entryCounts) / sizeof(entryCounts[0]); i++)
+        {
+            snprintf(fileName, BENCHMARK_FILE_NAME_SIZE, "%s/config_benchmark_%u%s.xml", directory, entryCounts[i],
+                     singleLine ? "_single_line" : "");
+
+            fileSize = generateConfig(fileName, entryCounts[i], singleLine);
+            if (fileSize < 0)
+            {
+                printf("Writing %s failed!\n", fileName);
+                return 1;
+            }
+
+            seconds = runParser(fileName, entryCounts[i]);
+            unlink(fileName);
+            if (seconds < 0)
+            {
+                printf("Parsing %s failed!\n", fileName);
+                return 1;
+            }
+
+            printf("%-12s %7u entries %9.1f KB %9.2f ms %7.1f ns/entry %8.1f MB/s\n", singleLine ? "single line" : "multi line",
+                   2 * entryCounts[i], fileSize / 1024.0, seconds * 1e3, seconds / (2 * entryCounts[i]) * 1e9,
+                   fileSize / seconds / 1e6);
+        }
+    }
+
+    return 0;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for writing configuration with entryCount transponders and preset channels, returns file size or -1.*/
+static long generateConfig(const char *fileName, uint32_t entryCount, uint8_t singleLine)
+{
+    FILE *file;
+    const char *newLine = singleLine ? "" : "\n\t\t";
+    const char *closeLine = singleLine ? "" : "\n\t";
+    long size;
+    uint32_t i;
+
+    if ((file = fopen(fileName, "w")) == NULL)
+    {
+        return -1;
+    }
+
+    fprintf(file, "<?xml version=\"1.0\"?>%s<initial_config>", singleLine ? "" : "\n");
+    fprintf(file, "%s<!-- generated by configuration_parser_benchmark -->", closeLine);
+    fprintf(file, "%s<starting_channel>%s<audio_pid>101</audio_pid>%s<video_pid>102</video_pid>", closeLine, newLine, newLine);
+    fprintf(file, "%s<audio_type>ac3</audio_type>%s<video_type>mpeg2</video_type>%s</starting_channel>", newLine, newLine, closeLine);
+
+    for (i = 0; i < entryCount; i++)
+    {
+        fprintf(file, "%s<transponder>%s<frequency>%u</frequency>%s<bandwidth>8</bandwidth>", closeLine, newLine,
+                474 + 8 * (i % 49), newLine);
+        fprintf(file, "%s<module>%s</module>%s</transponder>", newLine, i % 2 ? "DVB-T2" : "DVB-T", closeLine);
+    }
+
+    for (i = 0; i < entryCount; i++)
+    {
+        fprintf(file, "%s<channel>%s<audio_pid>%u</audio_pid>%s<video_pid>%u</video_pid>", closeLine, newLine,
+                101 + 2 * (i % 4000), newLine, 102 + 2 * (i % 4000));
+        fprintf(file, "%s<audio_type>%s</audio_type>%s<video_type>mpeg2</video_type>%s</channel>", newLine,
+                i % 3 ? "mpeg" : "ac3", newLine, closeLine);
+    }
+
+    fprintf(file, "%s</initial_config>\n", singleLine ? "" : "\n");
+
+    size = ftell(file);
+    fclose(file);
+
+    return size;
+}
+
+/*Function for parsing file BENCHMARK_ROUNDS times, returns seconds of fastest round or -1 on error.*/
+static double runParser(char *fileName, uint32_t entryCount)
+{
+    struct timespec start;
+    struct timespec end;
+    initialConfig config;
+    configurationParserStatus result;
+    double best = -1;
+    double seconds;
+    int32_t nullFd;
+    int32_t stdoutFd;
+    uint32_t round;
+
+    /* parser reports parsed values, only timing is of interest here */
+    fflush(stdout);
+    stdoutFd = dup(STDOUT_FILENO);
+    nullFd = open("/dev/null", O_WRONLY);
+    dup2(nullFd, STDOUT_FILENO);
+
+    for (round = 0; round < BENCHMARK_ROUNDS; round++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        result = parseConfigurationFile(fileName, &config);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        if (result != CONFIGURATION_PARSER_NO_ERROR || config.transponderCount != entryCount ||
+            config.presetChannelCount != entryCount)
+        {
+            best = -1;
+            break;
+        }
+        freeConfiguration(&config);
+
+        seconds = elapsedSeconds(&start, &end);
+        best = best < 0 || seconds < best ? seconds : best;
+    }
+
+    fflush(stdout);
+    dup2(stdoutFd, STDOUT_FILENO);
+    close(stdoutFd);
+    close(nullFd);
+
+    return best;
+}
+
+static double elapsedSeconds(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
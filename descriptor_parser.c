@@ -0,0 +1,183 @@
+#include "descriptor_parser.h"
+
+#include <stddef.h>
+
+/* helper keywords needed only for descriptor parser module */
+#define DESCRIPTOR_HEADER_SIZE 2
+#define ISO_639_LANGUAGE_ENTRY_SIZE 4
+#define SUBTITLING_ENTRY_SIZE 8
+#define LOGICAL_CHANNEL_ENTRY_SIZE 4
+
+/* helper functions needed only for descriptor parser module */
+static descriptorParserStatus decodeIso639Language(const uint8_t *data, uint8_t length, descriptorData *typed);
+static descriptorParserStatus decodeService(const uint8_t *data, uint8_t length, descriptorData *typed);
+static descriptorParserStatus decodeShortEvent(const uint8_t *data, uint8_t length, descriptorData *typed);
+static descriptorParserStatus decodeSubtitling(const uint8_t *data, uint8_t length, descriptorData *typed);
+static descriptorParserStatus decodeAc3(const uint8_t *data, uint8_t length, descriptorData *typed);
+static descriptorParserStatus decodeLogicalChannel(const uint8_t *data, uint8_t length, descriptorData *typed);
+
+/* helper variables needed only for descriptor parser module */
+static descriptorDecoder decoders[256] = {
+    [ISO_639_LANGUAGE_DESCRIPTOR_TAG] = decodeIso639Language,
+    [SERVICE_DESCRIPTOR_TAG] = decodeService,
+    [SHORT_EVENT_DESCRIPTOR_TAG] = decodeShortEvent,
+    [SUBTITLING_DESCRIPTOR_TAG] = decodeSubtitling,
+    [AC3_DESCRIPTOR_TAG] = decodeAc3,
+    [LOGICAL_CHANNEL_DESCRIPTOR_TAG] = decodeLogicalChannel,
+};
+
+void descriptorIteratorInit(descriptorIterator *iterator, const uint8_t *loop, uint16_t loopLength)
+{
+    iterator->position = loop;
+    iterator->end = loop + loopLength;
+}
+
+uint8_t descriptorNext(descriptorIterator *iterator, descriptor *result)
+{
+    const uint8_t *position = iterator->position;
+    descriptorDecoder decoder;
+
+    if (position + DESCRIPTOR_HEADER_SIZE > iterator->end || position + DESCRIPTOR_HEADER_SIZE + *(position + 1) > iterator->end)
+    {
+        iterator->position = iterator->end;
+        return 0;
+    }
+
+    result->tag = *position;
+    result->length = *(position + 1);
+    result->data = position + DESCRIPTOR_HEADER_SIZE;
+
+    decoder = decoders[result->tag];
+    result->decoded = decoder && decoder(result->data, result->length, &result->typed) == DESCRIPTOR_PARSER_NO_ERROR;
+
+    iterator->position = result->data + result->length;
+    return 1;
+}
+
+void descriptorRegisterDecoder(uint8_t tag, descriptorDecoder decoder)
+{
+    decoders[tag] = decoder;
+}
+
+void subtitlingDescriptorEntry(const subtitlingDescriptor *subtitling, uint8_t index, subtitlingEntry *entry)
+{
+    const uint8_t *data = subtitling->entries + index * SUBTITLING_ENTRY_SIZE;
+
+    entry->language = data;
+    entry->subtitlingType = *(data + 3);
+    entry->compositionPageId = (uint16_t)(*(data + 4) << 8) + *(data + 5);
+    entry->ancillaryPageId = (uint16_t)(*(data + 6) << 8) + *(data + 7);
+}
+
+void logicalChannelDescriptorEntry(const logicalChannelDescriptor *logicalChannel, uint8_t index, logicalChannelEntry *entry)
+{
+    const uint8_t *data = logicalChannel->entries + index * LOGICAL_CHANNEL_ENTRY_SIZE;
+
+    entry->serviceId = (uint16_t)(*data << 8) + *(data + 1);
+    entry->visible = (*(data + 2) >> 7) & 0x01;
+    entry->logicalChannelNumber = (uint16_t)((*(data + 2) << 8) + *(data + 3)) & 0x03FF;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for decoding ISO 639 language descriptor.*/
+static descriptorParserStatus decodeIso639Language(const uint8_t *data, uint8_t length, descriptorData *typed)
+{
+    typed->language.languageCount = length / ISO_639_LANGUAGE_ENTRY_SIZE;
+    typed->language.entries = data;
+
+    return DESCRIPTOR_PARSER_NO_ERROR;
+}
+
+/*Function for decoding service descriptor.*/
+static descriptorParserStatus decodeService(const uint8_t *data, uint8_t length, descriptorData *typed)
+{
+    const uint8_t *end = data + length;
+
+    if (length < 3)
+    {
+        return DESCRIPTOR_PARSER_ERROR;
+    }
+
+    typed->service.serviceType = *data;
+    typed->service.providerNameLength = *(data + 1);
+    typed->service.providerName = data + 2;
+
+    if (typed->service.providerName + typed->service.providerNameLength + 1 > end)
+    {
+        return DESCRIPTOR_PARSER_ERROR;
+    }
+
+    typed->service.serviceNameLength = *(typed->service.providerName + typed->service.providerNameLength);
+    typed->service.serviceName = typed->service.providerName + typed->service.providerNameLength + 1;
+
+    if (typed->service.serviceName + typed->service.serviceNameLength > end)
+    {
+        return DESCRIPTOR_PARSER_ERROR;
+    }
+
+    return DESCRIPTOR_PARSER_NO_ERROR;
+}
+
+/*Function for decoding short event descriptor.*/
+static descriptorParserStatus decodeShortEvent(const uint8_t *data, uint8_t length, descriptorData *typed)
+{
+    const uint8_t *end = data + length;
+
+    /* ISO 639 language code (3), event name length and name, text length and text */
+    if (length < ISO_639_CODE_SIZE + 2)
+    {
+        return DESCRIPTOR_PARSER_ERROR;
+    }
+
+    typed->shortEvent.language = data;
+    typed->shortEvent.eventNameLength = *(data + ISO_639_CODE_SIZE);
+    typed->shortEvent.eventName = data + ISO_639_CODE_SIZE + 1;
+
+    if (typed->shortEvent.eventName + typed->shortEvent.eventNameLength + 1 > end)
+    {
+        return DESCRIPTOR_PARSER_ERROR;
+    }
+
+    typed->shortEvent.textLength = *(typed->shortEvent.eventName + typed->shortEvent.eventNameLength);
+    typed->shortEvent.text = typed->shortEvent.eventName + typed->shortEvent.eventNameLength + 1;
+
+    if (typed->shortEvent.text + typed->shortEvent.textLength > end)
+    {
+        return DESCRIPTOR_PARSER_ERROR;
+    }
+
+    return DESCRIPTOR_PARSER_NO_ERROR;
+}
+
+/*Function for decoding subtitling descriptor.*/
+static descriptorParserStatus decodeSubtitling(const uint8_t *data, uint8_t length, descriptorData *typed)
+{
+    typed->subtitling.subtitleCount = length / SUBTITLING_ENTRY_SIZE;
+    typed->subtitling.entries = data;
+
+    return DESCRIPTOR_PARSER_NO_ERROR;
+}
+
+/*Function for decoding AC-3 descriptor.*/
+static descriptorParserStatus decodeAc3(const uint8_t *data, uint8_t length, descriptorData *typed)
+{
+    if (length < 1)
+    {
+        return DESCRIPTOR_PARSER_ERROR;
+    }
+
+    typed->ac3.flags = *data;
+    typed->ac3.componentType = (*data & 0x80) && length > 1 ? *(data + 1) : 0;
+
+    return DESCRIPTOR_PARSER_NO_ERROR;
+}
+
+/*Function for decoding logical channel descriptor.*/
+static descriptorParserStatus decodeLogicalChannel(const uint8_t *data, uint8_t length, descriptorData *typed)
+{
+    typed->logicalChannel.channelCount = length / LOGICAL_CHANNEL_ENTRY_SIZE;
+    typed->logicalChannel.entries = data;
+
+    return DESCRIPTOR_PARSER_NO_ERROR;
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
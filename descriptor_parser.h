@@ -0,0 +1,133 @@
+#ifndef _DESCRIPTOR_PARSER_H_
+#define _DESCRIPTOR_PARSER_H_
+
+#include <stdint.h>
+
+#define ISO_639_LANGUAGE_DESCRIPTOR_TAG 0x0A
+#define SERVICE_DESCRIPTOR_TAG 0x48
+#define SHORT_EVENT_DESCRIPTOR_TAG 0x4D
+#define SUBTITLING_DESCRIPTOR_TAG 0x59
+#define AC3_DESCRIPTOR_TAG 0x6A
+#define LOGICAL_CHANNEL_DESCRIPTOR_TAG 0x83 // private, EACEM/NorDig
+#define ISO_639_CODE_SIZE 3
+
+typedef enum _descriptorParserStatus
+{
+    DESCRIPTOR_PARSER_NO_ERROR = 0,
+    DESCRIPTOR_PARSER_ERROR
+} descriptorParserStatus;
+
+/* ---- Typed descriptor views, all pointers point into the section buffer ---- */
+typedef struct _iso639LanguageDescriptor
+{
+    uint8_t languageCount;
+    const uint8_t *entries; // 3 byte language code followed by audio type
+} iso639LanguageDescriptor;
+
+typedef struct _serviceDescriptor
+{
+    uint8_t serviceType;
+    uint8_t providerNameLength;
+    const uint8_t *providerName;
+    uint8_t serviceNameLength;
+    const uint8_t *serviceName;
+} serviceDescriptor;
+
+typedef struct _shortEventDescriptor
+{
+    const uint8_t *language;
+    uint8_t eventNameLength;
+    const uint8_t *eventName;
+    uint8_t textLength;
+    const uint8_t *text;
+} shortEventDescriptor;
+
+typedef struct _subtitlingDescriptor
+{
+    uint8_t subtitleCount;
+    const uint8_t *entries; // 3 byte language code, type, composition and ancillary page id
+} subtitlingDescriptor;
+
+typedef struct _subtitlingEntry
+{
+    const uint8_t *language;
+    uint8_t subtitlingType;
+    uint16_t compositionPageId;
+    uint16_t ancillaryPageId;
+} subtitlingEntry;
+
+typedef struct _ac3Descriptor
+{
+    uint8_t flags; // component_type, bsid, mainid and asvc presence flags
+    uint8_t componentType;
+} ac3Descriptor;
+
+typedef struct _logicalChannelDescriptor
+{
+    uint8_t channelCount;
+    const uint8_t *entries; // service id, visible service flag and 10 bit logical channel number
+} logicalChannelDescriptor;
+
+typedef struct _logicalChannelEntry
+{
+    uint16_t serviceId;
+    uint8_t visible;
+    uint16_t logicalChannelNumber;
+} logicalChannelEntry;
+
+typedef union _descriptorData
+{
+    iso639LanguageDescriptor language;
+    serviceDescriptor service;
+    shortEventDescriptor shortEvent;
+    subtitlingDescriptor subtitling;
+    ac3Descriptor ac3;
+    logicalChannelDescriptor logicalChannel;
+} descriptorData;
+/* ---- Typed descriptor views, all pointers point into the section buffer ---- */
+
+/* one descriptor of a loop, typed is filled only if decoded is set */
+typedef struct _descriptor
+{
+    uint8_t tag;
+    uint8_t length;
+    const uint8_t *data;
+    uint8_t decoded;
+    descriptorData typed;
+} descriptor;
+
+typedef struct _descriptorIterator
+{
+    const uint8_t *position;
+    const uint8_t *end;
+} descriptorIterator;
+
+/* decoder for descriptor payload (bytes after tag and length), returns error if payload is malformed */
+typedef descriptorParserStatus (*descriptorDecoder)(const uint8_t *data, uint8_t length, descriptorData *typed);
+
+/*Function for positioning iterator at first descriptor of descriptor loop.*/
+void descriptorIteratorInit(descriptorIterator *iterator, const uint8_t *loop, uint16_t loopLength);
+
+/****************************************************************************
+ * @brief    Function for reading next descriptor of loop and decoding it with
+ *           decoder registered for its tag. Nothing is allocated, typed view
+ *           points into the loop.
+ *
+ * @param    iterator - [in] Iterator set up with descriptorIteratorInit.
+ *           result - [out] Raw descriptor and, if a decoder accepted it, typed view.
+ *
+ * @return   1, if descriptor is read.
+ *           0, if loop is exhausted or next descriptor is truncated.
+****************************************************************************/
+uint8_t descriptorNext(descriptorIterator *iterator, descriptor *result);
+
+/*Function for registering decoder for tag, replacing built-in one. Decoders have to be registered before tables are parsed.*/
+void descriptorRegisterDecoder(uint8_t tag, descriptorDecoder decoder);
+
+/*Function for reading subtitling descriptor entry at index (0 <= index < subtitleCount).*/
+void subtitlingDescriptorEntry(const subtitlingDescriptor *subtitling, uint8_t index, subtitlingEntry *entry);
+
+/*Function for reading logical channel descriptor entry at index (0 <= index < channelCount).*/
+void logicalChannelDescriptorEntry(const logicalChannelDescriptor *logicalChannel, uint8_t index, logicalChannelEntry *entry);
+
+#endif // _DESCRIPTOR_PARSER_H_
@@ -0,0 +1,679 @@
+/**
+ * @file dfb_sim.c
+ *
+ * @brief Software framebuffer implementation of the DirectFB subset declared in dfb_sim.h.
+ *
+ * Surfaces are plain ARGB8888 arrays in memory, primary surface with
+ * DSCAPS_FLIPPING gets a front (displayed) and a back (work) buffer.
+ * Drawing follows DirectFB defaults without blending flags: rectangles
+ * write colour including alpha, strings write colour where glyph is set.
+ * Font files are not loaded, text is rendered with a built-in 8x8 bitmap
+ * font scaled to requested height, so string widths differ from real fonts
+ * but rendering cost grows with text size the same way. Behaviour is
+ * configured through environment variables:
+ *
+ *   DFB_SIM_SCREEN_SIZE - primary surface size as WIDTHxHEIGHT (default 1920x1080)
+ *   DFB_SIM_DUMP_DIR    - directory receiving frame_NNNNN.ppm after every flip (default none)
+ */
+
+#include "dfb_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* helper keywords needed only for DirectFB simulator module */
+#define SIM_DEFAULT_SCREEN_WIDTH 1920
+#define SIM_DEFAULT_SCREEN_HEIGHT 1080
+#define SIM_DEFAULT_FONT_HEIGHT 24
+#define SIM_FILE_NAME_SIZE 512
+
+#define GLYPH_SIZE 8 // rows and columns of built-in font
+#define GLYPH_FIRST 0x20
+#define GLYPH_LAST 0x7E
+#define GLYPH_COUNT (GLYPH_LAST - GLYPH_FIRST + 1)
+#define GLYPH_UNKNOWN '?'
+
+typedef struct _simFont
+{
+    IDirectFBFont iface; // has to be first, interface pointer is cast to simFont
+    uint32_t references;
+    int height;
+    int ascender;
+    int glyphWidth;
+    uint8_t *masks; // GLYPH_COUNT scaled glyphs of glyphWidth x height bytes, 1 where pixel is set
+} simFont;
+
+typedef struct _simSurface
+{
+    IDirectFBSurface iface; // has to be first, interface pointer is cast to simSurface
+    int width;
+    int height;
+    uint32_t *front; // displayed buffer
+    uint32_t *back;  // work buffer, same as front without DSCAPS_FLIPPING
+    uint32_t colour; // ARGB
+    simFont *font;
+} simSurface;
+
+typedef struct _simDirectFB
+{
+    IDirectFB iface; // has to be first, interface pointer is cast to simDirectFB
+} simDirectFB;
+
+/* helper variables needed only for DirectFB simulator module */
+static int screenWidth = SIM_DEFAULT_SCREEN_WIDTH;
+static int screenHeight = SIM_DEFAULT_SCREEN_HEIGHT;
+static const char *dumpDir;
+static uint32_t frameCount;
+static simSurface *primarySurface;
+
+/* public domain 8x8 font (IBM PC BIOS derived), one byte per row, bit 0 is leftmost pixel */
+static const uint8_t glyphs[GLYPH_COUNT][GLYPH_SIZE] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+    {0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00}, // '!'
+    {0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '"'
+    {0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00}, // '#'
+    {0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00}, // '$'
+    {0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00}, // '%'
+    {0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00}, // '&'
+    {0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00}, // '''
+    {0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00}, // '('
+    {0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00}, // ')'
+    {0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00}, // '*'
+    {0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00}, // '+'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06}, // ','
+    {0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00}, // '-'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00}, // '.'
+    {0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00}, // '/'
+    {0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00}, // '0'
+    {0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00}, // '1'
+    {0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00}, // '2'
+    {0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00}, // '3'
+    {0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00}, // '4'
+    {0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00}, // '5'
+    {0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00}, // '6'
+    {0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00}, // '7'
+    {0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00}, // '8'
+    {0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00}, // '9'
+    {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00}, // ':'
+    {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06}, // ';'
+    {0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00}, // '<'
+    {0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00}, // '='
+    {0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00}, // '>'
+    {0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00}, // '?'
+    {0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00}, // '@'
+    {0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00}, // 'A'
+    {0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00}, // 'B'
+    {0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00}, // 'C'
+    {0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00}, // 'D'
+    {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00}, // 'E'
+    {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00}, // 'F'
+    {0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00}, // 'G'
+    {0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00}, // 'H'
+    {0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // 'I'
+    {0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00}, // 'J'
+    {0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00}, // 'K'
+    {0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00}, // 'L'
+    {0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00}, // 'M'
+    {0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00}, // 'N'
+    {0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00}, // 'O'
+    {0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00}, // 'P'
+    {0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00}, // 'Q'
+    {0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00}, // 'R'
+    {0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00}, // 'S'
+    {0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // 'T'
+    {0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00}, // 'U'
+    {0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00}, // 'V'
+    {0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00}, // 'W'
+    {0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00}, // 'X'
+    {0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00}, // 'Y'
+    {0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00}, // 'Z'
+    {0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00}, // '['
+    {0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00}, // '\'
+    {0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00}, // ']'
+    {0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00}, // '^'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF}, // '_'
+    {0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00}, // '`'
+    {0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00}, // 'a'
+    {0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00}, // 'b'
+    {0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00}, // 'c'
+    {0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00}, // 'd'
+    {0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00}, // 'e'
+    {0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00}, // 'f'
+    {0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F}, // 'g'
+    {0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00}, // 'h'
+    {0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // 'i'
+    {0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E}, // 'j'
+    {0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00}, // 'k'
+    {0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // 'l'
+    {0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00}, // 'm'
+    {0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00}, // 'n'
+    {0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00}, // 'o'
+    {0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F}, // 'p'
+    {0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78}, // 'q'
+    {0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00}, // 'r'
+    {0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00}, // 's'
+    {0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00}, // 't'
+    {0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00}, // 'u'
+    {0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00}, // 'v'
+    {0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00}, // 'w'
+    {0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00}, // 'x'
+    {0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F}, // 'y'
+    {0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00}, // 'z'
+    {0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00}, // '{'
+    {0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00}, // '|'
+    {0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00}, // '}'
+    {0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '~'
+};
+
+/* helper functions needed only for DirectFB simulator module */
+static DFBResult directFBRelease(IDirectFB *thiz);
+static DFBResult directFBSetCooperativeLevel(IDirectFB *thiz, DFBCooperativeLevel level);
+static DFBResult directFBCreateSurface(IDirectFB *thiz, const DFBSurfaceDescription *desc, IDirectFBSurface **surface);
+static DFBResult directFBCreateFont(IDirectFB *thiz, const char *filename, const DFBFontDescription *desc, IDirectFBFont **font);
+static DFBResult surfaceRelease(IDirectFBSurface *thiz);
+static DFBResult surfaceGetSize(IDirectFBSurface *thiz, int *width, int *height);
+static DFBResult surfaceSetColor(IDirectFBSurface *thiz, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+static DFBResult surfaceFillRectangle(IDirectFBSurface *thiz, int x, int y, int w, int h);
+static DFBResult surfaceDrawRectangle(IDirectFBSurface *thiz, int x, int y, int w, int h);
+static DFBResult surfaceSetFont(IDirectFBSurface *thiz, IDirectFBFont *font);
+static DFBResult surfaceDrawString(IDirectFBSurface *thiz, const char *text, int bytes, int x, int y, DFBSurfaceTextFlags flags);
+static DFBResult surfaceFlip(IDirectFBSurface *thiz, const DFBRegion *region, DFBSurfaceFlipFlags flags);
+static DFBResult fontRelease(IDirectFBFont *thiz);
+static DFBResult fontGetAscender(IDirectFBFont *thiz, int *ascender);
+static DFBResult fontGetHeight(IDirectFBFont *thiz, int *height);
+static DFBResult fontGetStringWidth(IDirectFBFont *thiz, const char *text, int bytes, int *width);
+static void fillClipped(simSurface *surface, int x, int y, int w, int h);
+static void fontUnref(simFont *font);
+
+DFBResult DirectFBInit(int *argc, char *(*argv[]))
+{
+    const char *size = getenv(DFB_SIM_SCREEN_SIZE_ENV);
+    int width;
+    int height;
+
+    if (size && sscanf(size, "%dx%d", &width, &height) == 2 && width > 0 && height > 0)
+    {
+        screenWidth = width;
+        screenHeight = height;
+    }
+
+    dumpDir = getenv(DFB_SIM_DUMP_DIR_ENV);
+    if (dumpDir && !*dumpDir)
+    {
+        dumpDir = NULL;
+    }
+
+    return DFB_OK;
+}
+
+DFBResult DirectFBCreate(IDirectFB **interface)
+{
+    simDirectFB *directFB = (simDirectFB *)calloc(1, sizeof(simDirectFB));
+
+    if (!directFB)
+    {
+        return DFB_NOSYSTEMMEMORY;
+    }
+
+    directFB->iface.Release = directFBRelease;
+    directFB->iface.SetCooperativeLevel = directFBSetCooperativeLevel;
+    directFB->iface.CreateSurface = directFBCreateSurface;
+    directFB->iface.CreateFont = directFBCreateFont;
+
+    *interface = &directFB->iface;
+    return DFB_OK;
+}
+
+void DirectFBErrorFatal(const char *msg, DFBResult result)
+{
+    fprintf(stderr, "(!) DirectFBError [%s]: %d\n", msg, result);
+    exit(result);
+}
+
+DFBResult dfbSimDumpFrame(const char *fileName)
+{
+    FILE *file;
+    uint8_t *row;
+    uint32_t pixel;
+    uint32_t alpha;
+    int x;
+    int y;
+
+    if (!primarySurface)
+    {
+        return DFB_FAILURE;
+    }
+
+    row = (uint8_t *)malloc(primarySurface->width * 3);
+    file = fopen(fileName, "wb");
+    if (!row || !file)
+    {
+        free(row);
+        if (file)
+        {
+            fclose(file);
+        }
+        return DFB_IO;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", primarySurface->width, primarySurface->height);
+    for (y = 0; y < primarySurface->height; y++)
+    {
+        for (x = 0; x < primarySurface->width; x++)
+        {
+            pixel = primarySurface->front[y * primarySurface->width + x];
+            alpha = pixel >> 24;
+            row[x * 3] = ((pixel >> 16) & 0xFF) * alpha / 0xFF;
+            row[x * 3 + 1] = ((pixel >> 8) & 0xFF) * alpha / 0xFF;
+            row[x * 3 + 2] = (pixel & 0xFF) * alpha / 0xFF;
+        }
+        fwrite(row, 3, primarySurface->width, file);
+    }
+
+    free(row);
+    return fclose(file) ? DFB_IO : DFB_OK;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+static DFBResult directFBRelease(IDirectFB *thiz)
+{
+    free(thiz);
+    return DFB_OK;
+}
+
+static DFBResult directFBSetCooperativeLevel(IDirectFB *thiz, DFBCooperativeLevel level)
+{
+    return DFB_OK;
+}
+
+/*Function for creating surface, primary surface covers the screen, others need width and height.*/
+static DFBResult directFBCreateSurface(IDirectFB *thiz, const DFBSurfaceDescription *desc, IDirectFBSurface **surface)
+{
+    simSurface *created;
+    DFBSurfaceCapabilities caps = desc->flags & DSDESC_CAPS ? desc->caps : DSCAPS_NONE;
+    int width = desc->flags & DSDESC_WIDTH ? desc->width : 0;
+    int height = desc->flags & DSDESC_HEIGHT ? desc->height : 0;
+
+    if (caps & DSCAPS_PRIMARY)
+    {
+        if (primarySurface)
+        {
+            return DFB_UNSUPPORTED;
+        }
+        width = screenWidth;
+        height = screenHeight;
+    }
+
+    if (width <= 0 || height <= 0)
+    {
+        return DFB_INVARG;
+    }
+
+    created = (simSurface *)calloc(1, sizeof(simSurface));
+    if (!created)
+    {
+        return DFB_NOSYSTEMMEMORY;
+    }
+
+    created->width = width;
+    created->height = height;
+    created->front = (uint32_t *)calloc((size_t)width * height, sizeof(uint32_t));
+    created->back = caps & DSCAPS_FLIPPING ? (uint32_t *)calloc((size_t)width * height, sizeof(uint32_t)) : created->front;
+    if (!created->front || !created->back)
+    {
+        free(created->front);
+        if (created->back != created->front)
+        {
+            free(created->back);
+        }
+        free(created);
+        return DFB_NOSYSTEMMEMORY;
+    }
+
+    created->iface.Release = surfaceRelease;
+    created->iface.GetSize = surfaceGetSize;
+    created->iface.SetColor = surfaceSetColor;
+    created->iface.FillRectangle = surfaceFillRectangle;
+    created->iface.DrawRectangle = surfaceDrawRectangle;
+    created->iface.SetFont = surfaceSetFont;
+    created->iface.DrawString = surfaceDrawString;
+    created->iface.Flip = surfaceFlip;
+
+    if (caps & DSCAPS_PRIMARY)
+    {
+        primarySurface = created;
+    }
+
+    *surface = &created->iface;
+    return DFB_OK;
+}
+
+/*Function for creating font, file name is ignored and built-in font is scaled to requested height.*/
+static DFBResult directFBCreateFont(IDirectFB *thiz, const char *filename, const DFBFontDescription *desc, IDirectFBFont **font)
+{
+    simFont *created = (simFont *)calloc(1, sizeof(simFont));
+    const uint8_t *glyph;
+    uint8_t *mask;
+    int glyphIndex;
+    int row;
+    int column;
+
+    if (!created)
+    {
+        return DFB_NOSYSTEMMEMORY;
+    }
+
+    created->references = 1;
+    created->height = desc && (desc->flags & DFDESC_HEIGHT) && desc->height > 0 ? desc->height : SIM_DEFAULT_FONT_HEIGHT;
+    created->ascender = created->height * (GLYPH_SIZE - 1) / GLYPH_SIZE; // last glyph row is below baseline
+    created->glyphWidth = created->height * 5 / GLYPH_SIZE > 0 ? created->height * 5 / GLYPH_SIZE : 1;
+
+    /* glyphs are scaled once here, like DirectFB glyph cache, so drawing only copies masks */
+    created->masks = (uint8_t *)malloc((size_t)GLYPH_COUNT * created->glyphWidth * created->height);
+    if (!created->masks)
+    {
+        free(created);
+        return DFB_NOSYSTEMMEMORY;
+    }
+
+    for (glyphIndex = 0; glyphIndex < GLYPH_COUNT; glyphIndex++)
+    {
+        glyph = glyphs[glyphIndex];
+        mask = created->masks + (size_t)glyphIndex * created->glyphWidth * created->height;
+        for (row = 0; row < created->height; row++)
+        {
+            for (column = 0; column < created->glyphWidth; column++)
+            {
+                *mask++ = (glyph[row * GLYPH_SIZE / created->height] >> (column * GLYPH_SIZE / created->glyphWidth)) & 0x01;
+            }
+        }
+    }
+
+    created->iface.Release = fontRelease;
+    created->iface.GetAscender = fontGetAscender;
+    created->iface.GetHeight = fontGetHeight;
+    created->iface.GetStringWidth = fontGetStringWidth;
+
+    *font = &created->iface;
+    return DFB_OK;
+}
+
+static DFBResult surfaceRelease(IDirectFBSurface *thiz)
+{
+    simSurface *surface = (simSurface *)thiz;
+
+    if (surface == primarySurface)
+    {
+        primarySurface = NULL;
+    }
+    if (surface->font)
+    {
+        fontUnref(surface->font);
+    }
+    if (surface->back != surface->front)
+    {
+        free(surface->back);
+    }
+    free(surface->front);
+    free(surface);
+
+    return DFB_OK;
+}
+
+static DFBResult surfaceGetSize(IDirectFBSurface *thiz, int *width, int *height)
+{
+    simSurface *surface = (simSurface *)thiz;
+
+    *width = surface->width;
+    *height = surface->height;
+    return DFB_OK;
+}
+
+static DFBResult surfaceSetColor(IDirectFBSurface *thiz, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    simSurface *surface = (simSurface *)thiz;
+
+    surface->colour = ((uint32_t)a << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    return DFB_OK;
+}
+
+static DFBResult surfaceFillRectangle(IDirectFBSurface *thiz, int x, int y, int w, int h)
+{
+    fillClipped((simSurface *)thiz, x, y, w, h);
+    return DFB_OK;
+}
+
+static DFBResult surfaceDrawRectangle(IDirectFBSurface *thiz, int x, int y, int w, int h)
+{
+    simSurface *surface = (simSurface *)thiz;
+
+    if (w <= 0 || h <= 0)
+    {
+        return DFB_INVARG;
+    }
+
+    fillClipped(surface, x, y, w, 1);
+    fillClipped(surface, x, y + h - 1, w, 1);
+    fillClipped(surface, x, y + 1, 1, h - 2);
+    fillClipped(surface, x + w - 1, y + 1, 1, h - 2);
+    return DFB_OK;
+}
+
+/*Function for setting font, surface keeps a reference until another font is set or surface is released.*/
+static DFBResult surfaceSetFont(IDirectFBSurface *thiz, IDirectFBFont *font)
+{
+    simSurface *surface = (simSurface *)thiz;
+    simFont *newFont = (simFont *)font;
+
+    if (newFont == surface->font)
+    {
+        return DFB_OK;
+    }
+
+    if (newFont)
+    {
+        newFont->references++;
+    }
+    if (surface->font)
+    {
+        fontUnref(surface->font);
+    }
+    surface->font = newFont;
+
+    return DFB_OK;
+}
+
+/*Function for drawing string to work buffer, y is baseline unless DSTF_TOP or DSTF_BOTTOM is set.*/
+static DFBResult surfaceDrawString(IDirectFBSurface *thiz, const char *text, int bytes, int x, int y, DFBSurfaceTextFlags flags)
+{
+    simSurface *surface = (simSurface *)thiz;
+    simFont *font = surface->font;
+    const uint8_t *mask;
+    uint32_t *pixel;
+    int length;
+    int width;
+    int top;
+    int character;
+    int row;
+    int column;
+    int firstColumn;
+    int lastColumn;
+    int i;
+
+    if (!font)
+    {
+        return DFB_FAILURE;
+    }
+
+    length = bytes < 0 ? (int)strlen(text) : bytes;
+    width = length * font->glyphWidth;
+
+    if (flags & DSTF_RIGHT)
+    {
+        x -= width;
+    }
+    else if (flags & DSTF_CENTER)
+    {
+        x -= width / 2;
+    }
+
+    if (flags & DSTF_TOP)
+    {
+        top = y;
+    }
+    else if (flags & DSTF_BOTTOM)
+    {
+        top = y - font->height;
+    }
+    else
+    {
+        top = y - font->ascender;
+    }
+
+    for (i = 0; i < length; i++, x += font->glyphWidth)
+    {
+        character = (uint8_t)text[i];
+        if (character < GLYPH_FIRST || character > GLYPH_LAST)
+        {
+            character = GLYPH_UNKNOWN;
+        }
+
+        firstColumn = x < 0 ? -x : 0;
+        lastColumn = x + font->glyphWidth > surface->width ? surface->width - x : font->glyphWidth;
+        if (firstColumn >= lastColumn)
+        {
+            continue;
+        }
+
+        mask = font->masks + (size_t)(character - GLYPH_FIRST) * font->glyphWidth * font->height;
+        for (row = 0; row < font->height; row++)
+        {
+            if (top + row < 0 || top + row >= surface->height)
+            {
+                continue;
+            }
+
+            pixel = surface->back + (size_t)(top + row) * surface->width + x;
+            for (column = firstColumn; column < lastColumn; column++)
+            {
+                if (mask[row * font->glyphWidth + column])
+                {
+                    pixel[column] = surface->colour;
+                }
+            }
+        }
+    }
+
+    return DFB_OK;
+}
+
+/*Function for showing work buffer. Region or DSFLIP_BLIT copies the (region of) work buffer, otherwise buffers are swapped.*/
+static DFBResult surfaceFlip(IDirectFBSurface *thiz, const DFBRegion *region, DFBSurfaceFlipFlags flags)
+{
+    simSurface *surface = (simSurface *)thiz;
+    char fileName[SIM_FILE_NAME_SIZE];
+    uint32_t *swap;
+    int x1 = 0;
+    int y1 = 0;
+    int x2 = surface->width - 1;
+    int y2 = surface->height - 1;
+    int y;
+
+    if (surface->back != surface->front)
+    {
+        if (region || (flags & DSFLIP_BLIT))
+        {
+            if (region)
+            {
+                x1 = region->x1 > 0 ? region->x1 : 0;
+                y1 = region->y1 > 0 ? region->y1 : 0;
+                x2 = region->x2 < x2 ? region->x2 : x2;
+                y2 = region->y2 < y2 ? region->y2 : y2;
+            }
+
+            for (y = y1; y <= y2 && x1 <= x2; y++)
+            {
+                memcpy(surface->front + (size_t)y * surface->width + x1, surface->back + (size_t)y * surface->width + x1,
+                       (size_t)(x2 - x1 + 1) * sizeof(uint32_t));
+            }
+        }
+        else
+        {
+            swap = surface->front;
+            surface->front = surface->back;
+            surface->back = swap;
+        }
+    }
+
+    if (dumpDir && surface == primarySurface)
+    {
+        snprintf(fileName, SIM_FILE_NAME_SIZE, "%s/frame_%05u.ppm", dumpDir, frameCount);
+        if (dfbSimDumpFrame(fileName) != DFB_OK)
+        {
+            fprintf(stderr, "dfb_sim: can not write %s\n", fileName);
+        }
+    }
+    frameCount++;
+
+    return DFB_OK;
+}
+
+static DFBResult fontRelease(IDirectFBFont *thiz)
+{
+    fontUnref((simFont *)thiz);
+    return DFB_OK;
+}
+
+static DFBResult fontGetAscender(IDirectFBFont *thiz, int *ascender)
+{
+    *ascender = ((simFont *)thiz)->ascender;
+    return DFB_OK;
+}
+
+static DFBResult fontGetHeight(IDirectFBFont *thiz, int *height)
+{
+    *height = ((simFont *)thiz)->height;
+    return DFB_OK;
+}
+
+static DFBResult fontGetStringWidth(IDirectFBFont *thiz, const char *text, int bytes, int *width)
+{
+    *width = (bytes < 0 ? (int)strlen(text) : bytes) * ((simFont *)thiz)->glyphWidth;
+    return DFB_OK;
+}
+
+/*Function for filling rectangle of work buffer with current colour, rectangle is clipped to surface.*/
+static void fillClipped(simSurface *surface, int x, int y, int w, int h)
+{
+    uint32_t *pixel;
+    int x2 = x + w > surface->width ? surface->width : x + w;
+    int y2 = y + h > surface->height ? surface->height : y + h;
+    int row;
+    int column;
+
+    x = x < 0 ? 0 : x;
+    y = y < 0 ? 0 : y;
+
+    for (row = y; row < y2; row++)
+    {
+        pixel = surface->back + (size_t)row * surface->width;
+        for (column = x; column < x2; column++)
+        {
+            pixel[column] = surface->colour;
+        }
+    }
+}
+
+/*Function for dropping font reference, font is freed with its last reference.*/
+static void fontUnref(simFont *font)
+{
+    if (--font->references)
+    {
+        return;
+    }
+
+    free(font->masks);
+    free(font);
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
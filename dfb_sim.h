@@ -0,0 +1,157 @@
+/**
+ * @file dfb_sim.h
+ *
+ * @brief Subset of the DirectFB API used by graphics controller, implemented
+ *        by dfb_sim.c against an in-memory ARGB framebuffer.
+ *
+ * Included instead of <directfb.h> when graphics controller is built with
+ * GRAPHICS_SOFTWARE defined, so OSD can be rendered and benchmarked on a
+ * host without display or DirectFB installed. Declarations follow DirectFB
+ * 1.4 names and signatures, only members called by tv_app are provided.
+ */
+
+#ifndef _DFB_SIM_H_
+#define _DFB_SIM_H_
+
+#include <stdint.h>
+
+#define DFB_SIM_DUMP_DIR_ENV "DFB_SIM_DUMP_DIR"       // when set, every flip writes frame_NNNNN.ppm to this directory
+#define DFB_SIM_SCREEN_SIZE_ENV "DFB_SIM_SCREEN_SIZE" // WIDTHxHEIGHT, default 1920x1080
+
+typedef enum
+{
+    DFB_OK = 0,
+    DFB_FAILURE,
+    DFB_INVARG,
+    DFB_NOSYSTEMMEMORY,
+    DFB_UNSUPPORTED,
+    DFB_IO
+} DFBResult;
+
+typedef enum
+{
+    DFSCL_NORMAL = 0,
+    DFSCL_FULLSCREEN,
+    DFSCL_EXCLUSIVE
+} DFBCooperativeLevel;
+
+typedef enum
+{
+    DSDESC_NONE = 0x00,
+    DSDESC_CAPS = 0x01,
+    DSDESC_WIDTH = 0x02,
+    DSDESC_HEIGHT = 0x04
+} DFBSurfaceDescriptionFlags;
+
+typedef enum
+{
+    DSCAPS_NONE = 0x00,
+    DSCAPS_PRIMARY = 0x01,
+    DSCAPS_FLIPPING = 0x10
+} DFBSurfaceCapabilities;
+
+typedef enum
+{
+    DFDESC_HEIGHT = 0x02
+} DFBFontDescriptionFlags;
+
+typedef enum
+{
+    DSTF_LEFT = 0x00,
+    DSTF_CENTER = 0x01,
+    DSTF_RIGHT = 0x02,
+    DSTF_TOP = 0x04,
+    DSTF_BOTTOM = 0x08
+} DFBSurfaceTextFlags;
+
+typedef enum
+{
+    DSFLIP_NONE = 0x00,
+    DSFLIP_WAIT = 0x01,
+    DSFLIP_BLIT = 0x02,
+    DSFLIP_ONSYNC = 0x04,
+    DSFLIP_WAITFORSYNC = DSFLIP_WAIT | DSFLIP_ONSYNC
+} DFBSurfaceFlipFlags;
+
+typedef struct
+{
+    int x;
+    int y;
+    int w;
+    int h;
+} DFBRectangle;
+
+/* corners are inclusive */
+typedef struct
+{
+    int x1;
+    int y1;
+    int x2;
+    int y2;
+} DFBRegion;
+
+typedef struct
+{
+    DFBSurfaceDescriptionFlags flags;
+    DFBSurfaceCapabilities caps;
+    int width;
+    int height;
+} DFBSurfaceDescription;
+
+typedef struct
+{
+    DFBFontDescriptionFlags flags;
+    int height;
+} DFBFontDescription;
+
+typedef struct _IDirectFBFont IDirectFBFont;
+typedef struct _IDirectFBSurface IDirectFBSurface;
+typedef struct _IDirectFB IDirectFB;
+
+struct _IDirectFBFont
+{
+    DFBResult (*Release)(IDirectFBFont *thiz);
+    DFBResult (*GetAscender)(IDirectFBFont *thiz, int *ascender);
+    DFBResult (*GetHeight)(IDirectFBFont *thiz, int *height);
+    DFBResult (*GetStringWidth)(IDirectFBFont *thiz, const char *text, int bytes, int *width);
+};
+
+struct _IDirectFBSurface
+{
+    DFBResult (*Release)(IDirectFBSurface *thiz);
+    DFBResult (*GetSize)(IDirectFBSurface *thiz, int *width, int *height);
+    DFBResult (*SetColor)(IDirectFBSurface *thiz, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+    DFBResult (*FillRectangle)(IDirectFBSurface *thiz, int x, int y, int w, int h);
+    DFBResult (*DrawRectangle)(IDirectFBSurface *thiz, int x, int y, int w, int h);
+    DFBResult (*SetFont)(IDirectFBSurface *thiz, IDirectFBFont *font);
+    DFBResult (*DrawString)(IDirectFBSurface *thiz, const char *text, int bytes, int x, int y, DFBSurfaceTextFlags flags);
+    DFBResult (*Flip)(IDirectFBSurface *thiz, const DFBRegion *region, DFBSurfaceFlipFlags flags);
+};
+
+struct _IDirectFB
+{
+    DFBResult (*Release)(IDirectFB *thiz);
+    DFBResult (*SetCooperativeLevel)(IDirectFB *thiz, DFBCooperativeLevel level);
+    DFBResult (*CreateSurface)(IDirectFB *thiz, const DFBSurfaceDescription *desc, IDirectFBSurface **surface);
+    DFBResult (*CreateFont)(IDirectFB *thiz, const char *filename, const DFBFontDescription *desc, IDirectFBFont **font);
+};
+
+DFBResult DirectFBInit(int *argc, char *(*argv[]));
+
+DFBResult DirectFBCreate(IDirectFB **interface);
+
+void DirectFBErrorFatal(const char *msg, DFBResult result);
+
+/****************************************************************************
+ * @brief    Function for writing displayed buffer of primary surface as binary
+ *           PPM image. Alpha is applied against black, as over a blank video plane.
+ *
+ * @param    fileName - [in] Output file.
+ *
+ * @return   DFB_OK, if there are no errors.
+ *           DFB_FAILURE, if primary surface does not exist.
+ *           DFB_IO, if file can not be written.
+****************************************************************************/
+DFBResult dfbSimDumpFrame(const char *fileName);
+
+#endif // _DFB_SIM_H_
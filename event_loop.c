@@ -0,0 +1,298 @@
+#include "event_loop.h"
+#include "trace.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/* helper keywords needed only for event loop module */
+#define EPOLL_EVENTS_MAX 8
+
+/* descriptor watched by loop, epoll data points to it */
+typedef struct _eventSource
+{
+    int32_t fd;
+    eventLoopSourceHandler handler;
+} eventSource;
+
+/* posted event, data is copied into queue storage. Sequence equal to slot position means free slot,
+   position + 1 means event is written, position + EVENT_LOOP_QUEUE_SIZE frees slot for next round */
+typedef struct _postedEvent
+{
+    uint32_t sequence;
+    eventLoopPostHandler handler;
+    uint16_t size;
+    uint8_t data[EVENT_LOOP_DATA_MAX_SIZE];
+} postedEvent;
+
+/* helper variables needed only for event loop module */
+static int32_t epollFd = -1;
+static int32_t queueFd = -1;
+static eventSource sources[EVENT_LOOP_MAX_SOURCES];
+static eventSource queueSource;
+static volatile uint8_t stopRequested;
+
+/* queue is written by any thread without lock, read only by loop thread, slot of head is not reused until it is handled */
+static postedEvent queue[EVENT_LOOP_QUEUE_SIZE];
+static uint32_t queueHead __attribute__((aligned(64))); // written by loop thread
+static uint32_t queueTail __attribute__((aligned(64))); // claimed by posters
+static uint32_t droppedEvents;
+
+/* helper functions needed only for event loop module */
+static void queueReadable(int32_t fd, uint32_t events);
+static void wakeUp();
+
+eventLoopStatus eventLoopInit()
+{
+    struct epoll_event event;
+    uint32_t i;
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    queueFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || queueFd < 0)
+    {
+        printf("eventLoopInit: %s\n", strerror(errno));
+        eventLoopDeinit();
+        return EVENT_LOOP_ERROR;
+    }
+
+    queueSource.fd = queueFd;
+    queueSource.handler = queueReadable;
+    event.events = EPOLLIN;
+    event.data.ptr = &queueSource;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, queueFd, &event))
+    {
+        printf("eventLoopInit: %s\n", strerror(errno));
+        eventLoopDeinit();
+        return EVENT_LOOP_ERROR;
+    }
+
+    for (i = 0; i < EVENT_LOOP_QUEUE_SIZE; i++)
+    {
+        queue[i].sequence = i;
+    }
+    queueHead = queueTail = 0;
+    droppedEvents = 0;
+    stopRequested = 0;
+
+    return EVENT_LOOP_NO_ERROR;
+}
+
+eventLoopStatus eventLoopDeinit()
+{
+    int32_t fd = __atomic_exchange_n(&queueFd, -1, __ATOMIC_ACQ_REL);
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    if (epollFd >= 0)
+    {
+        close(epollFd);
+        epollFd = -1;
+    }
+
+    if (droppedEvents)
+    {
+        traceStatistics("Event loop: %u posted events dropped, queue was full\n", droppedEvents);
+    }
+
+    return EVENT_LOOP_NO_ERROR;
+}
+
+eventLoopStatus eventLoopAddSource(int32_t fd, eventLoopSourceHandler handler)
+{
+    struct epoll_event event;
+    int32_t i;
+
+    if (epollFd < 0)
+    {
+        return EVENT_LOOP_ERROR;
+    }
+
+    for (i = 0; i < EVENT_LOOP_MAX_SOURCES; i++)
+    {
+        if (!sources[i].handler)
+        {
+            break;
+        }
+    }
+    if (i == EVENT_LOOP_MAX_SOURCES)
+    {
+        printf("eventLoopAddSource: no free sources\n");
+        return EVENT_LOOP_ERROR;
+    }
+
+    event.events = EPOLLIN;
+    event.data.ptr = &sources[i];
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        printf("eventLoopAddSource: %s\n", strerror(errno));
+        return EVENT_LOOP_ERROR;
+    }
+
+    sources[i].fd = fd;
+    sources[i].handler = handler;
+
+    return EVENT_LOOP_NO_ERROR;
+}
+
+eventLoopStatus eventLoopRemoveSource(int32_t fd)
+{
+    int32_t i;
+
+    for (i = 0; i < EVENT_LOOP_MAX_SOURCES; i++)
+    {
+        if (sources[i].handler && sources[i].fd == fd)
+        {
+            sources[i].handler = NULL;
+            return epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL) ? EVENT_LOOP_ERROR : EVENT_LOOP_NO_ERROR;
+        }
+    }
+
+    return EVENT_LOOP_ERROR;
+}
+
+eventLoopStatus eventLoopPost(eventLoopPostHandler handler, const uint8_t *data, uint16_t size)
+{
+    postedEvent *event;
+    uint32_t position = __atomic_load_n(&queueTail, __ATOMIC_RELAXED);
+    int32_t difference;
+
+    if (size > EVENT_LOOP_DATA_MAX_SIZE || __atomic_load_n(&queueFd, __ATOMIC_RELAXED) < 0)
+    {
+        return EVENT_LOOP_ERROR;
+    }
+
+    /* slot is claimed by moving tail past it, poster which loses the race retries with the new tail */
+    while (1)
+    {
+        event = &queue[position % EVENT_LOOP_QUEUE_SIZE];
+        difference = (int32_t)(__atomic_load_n(&event->sequence, __ATOMIC_ACQUIRE) - position);
+        if (difference < 0)
+        {
+            /* slot of previous round is not handled yet, queue is full */
+            __atomic_fetch_add(&droppedEvents, 1, __ATOMIC_RELAXED);
+            return EVENT_LOOP_ERROR;
+        }
+        if (!difference &&
+            __atomic_compare_exchange_n(&queueTail, &position, position + 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+        if (difference)
+        {
+            position = __atomic_load_n(&queueTail, __ATOMIC_RELAXED);
+        }
+    }
+
+    event->handler = handler;
+    event->size = size;
+    if (size)
+    {
+        memcpy(event->data, data, size);
+    }
+
+    /* loop stops at first unwritten slot, so only poster of the slot it waits at has to wake it up. Either
+       this poster sees loop waiting at its slot or loop sees written slot, both accesses are sequentially consistent */
+    __atomic_store_n(&event->sequence, position + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&queueHead, __ATOMIC_SEQ_CST) == position)
+    {
+        wakeUp();
+    }
+
+    return EVENT_LOOP_NO_ERROR;
+}
+
+void eventLoopRun()
+{
+    struct epoll_event events[EPOLL_EVENTS_MAX];
+    eventSource *source;
+    int32_t count;
+    int32_t i;
+
+    while (!stopRequested)
+    {
+        count = epoll_wait(epollFd, events, EPOLL_EVENTS_MAX, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            printf("eventLoopRun: %s\n", strerror(errno));
+            break;
+        }
+
+        /* source removed by an earlier handler of this batch has NULL handler */
+        for (i = 0; i < count && !stopRequested; i++)
+        {
+            source = (eventSource *)events[i].data.ptr;
+            if (source->handler)
+            {
+                source->handler(source->fd, events[i].events);
+            }
+        }
+    }
+}
+
+void eventLoopStop()
+{
+    stopRequested = 1;
+    wakeUp();
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for handling written events, at most one queue length per wake up so sources are not starved.*/
+static void queueReadable(int32_t fd, uint32_t events)
+{
+    uint64_t counter;
+    uint32_t handled;
+    postedEvent *event;
+    uint64_t traceStart;
+
+    if (read(fd, &counter, sizeof(counter)) < 0 && errno != EAGAIN)
+    {
+        printf("Event loop queue read failed: %s\n", strerror(errno));
+    }
+
+    /* slot of head is not reused by posters until it is released, so handler runs on data in place */
+    for (handled = 0; !stopRequested; handled++)
+    {
+        event = &queue[queueHead % EVENT_LOOP_QUEUE_SIZE];
+        if (__atomic_load_n(&event->sequence, __ATOMIC_SEQ_CST) != queueHead + 1)
+        {
+            /* poster of this slot wakes loop up once event is written */
+            break;
+        }
+        if (handled == EVENT_LOOP_QUEUE_SIZE)
+        {
+            wakeUp();
+            break;
+        }
+
+        traceStart = traceBegin();
+        event->handler(event->data, event->size);
+        traceEnd("posted event", traceStart);
+
+        __atomic_store_n(&event->sequence, queueHead + EVENT_LOOP_QUEUE_SIZE, __ATOMIC_RELEASE);
+        __atomic_store_n(&queueHead, queueHead + 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+/*Function for making queue descriptor readable, late wake up after deinit is dropped.*/
+static void wakeUp()
+{
+    uint64_t one = 1;
+    int32_t fd = __atomic_load_n(&queueFd, __ATOMIC_ACQUIRE);
+
+    if (fd >= 0 && write(fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+    {
+        printf("Event loop wake up failed: %s\n", strerror(errno));
+    }
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
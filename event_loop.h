@@ -0,0 +1,69 @@
+#ifndef _EVENT_LOOP_H_
+#define _EVENT_LOOP_H_
+
+#include <stdint.h>
+
+#define EVENT_LOOP_MAX_SOURCES 8
+#define EVENT_LOOP_QUEUE_SIZE 64        // posted events waiting for loop, further posts are dropped
+#define EVENT_LOOP_DATA_MAX_SIZE 4096   // largest posted payload, one PSI section
+
+typedef enum _eventLoopStatus
+{
+    EVENT_LOOP_NO_ERROR = 0,
+    EVENT_LOOP_ERROR
+} eventLoopStatus;
+
+/* called on loop thread when descriptor is ready, events are EPOLL* flags */
+typedef void (*eventLoopSourceHandler)(int32_t fd, uint32_t events);
+
+/* called on loop thread with copy of posted data, data is valid only during the call */
+typedef void (*eventLoopPostHandler)(uint8_t *data, uint16_t size);
+
+/****************************************************************************
+ * @brief    Function for creating epoll instance and eventfd of post queue.
+ *
+ * @return   EVENT_LOOP_NO_ERROR, if there are no errors.
+ *           EVENT_LOOP_ERROR, in case of an error.
+****************************************************************************/
+eventLoopStatus eventLoopInit();
+
+/*Function for closing loop descriptors, sources have to be removed by their owners before.*/
+eventLoopStatus eventLoopDeinit();
+
+/****************************************************************************
+ * @brief    Function for adding readable descriptor to loop. Descriptor should
+ *           be non-blocking, handler is called while it stays readable.
+ *
+ * @param    fd - [in] Descriptor to watch.
+ *           handler - [in] Function called on loop thread when fd is readable.
+ *
+ * @return   EVENT_LOOP_NO_ERROR, if there are no errors.
+ *           EVENT_LOOP_ERROR, if loop is not initialized or all sources are in use.
+****************************************************************************/
+eventLoopStatus eventLoopAddSource(int32_t fd, eventLoopSourceHandler handler);
+
+/*Function for removing descriptor from loop, descriptor is not closed.*/
+eventLoopStatus eventLoopRemoveSource(int32_t fd);
+
+/****************************************************************************
+ * @brief    Function for handing data over to loop thread, can be called from
+ *           any thread (SDK callbacks) and never blocks: slot of preallocated
+ *           queue is claimed without lock. Data is copied, handlers of posted
+ *           events are called in posting order.
+ *
+ * @param    handler - [in] Function called on loop thread.
+ *           data - [in] Data copied for handler, can be NULL if size is 0.
+ *           size - [in] Size of data, at most EVENT_LOOP_DATA_MAX_SIZE.
+ *
+ * @return   EVENT_LOOP_NO_ERROR, if there are no errors.
+ *           EVENT_LOOP_ERROR, if data is too big or queue is full.
+****************************************************************************/
+eventLoopStatus eventLoopPost(eventLoopPostHandler handler, const uint8_t *data, uint16_t size);
+
+/*Function for dispatching events on calling thread until eventLoopStop is called.*/
+void eventLoopRun();
+
+/*Function for making eventLoopRun return, can be called from any thread.*/
+void eventLoopStop();
+
+#endif // _EVENT_LOOP_H_
@@ -0,0 +1,178 @@
+/**
+ * @file graphics_benchmark.c
+ *
+ * @brief OSD rendering benchmark against the software framebuffer backend (see dfb_sim.c).
+ *
+ * Usage: graphics_benchmark [dump directory]
+ * Measures frames per second of channel banner and volume bar (draw and flip)
+ * next to a full-screen clear and flip. Channel banner is measured once more
+ * with font cache emptied before every frame, as drawing was before fonts
+ * were cached. Simulated CreateFont only scales built-in glyphs, so the
+ * ratio understates the gain on DirectFB, where fonts are loaded from TTF. When a directory is given, last frame
+ * of every case is written there as PPM image for visual check.
+ * Screen size is taken from DFB_SIM_SCREEN_SIZE (default 1920x1080).
+ */
+
+#include "graphics_controller.h"
+#include "timer_controller.h"
+#include "event_loop.h"
+#include "dfb_sim.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/* helper keywords needed only for benchmark */
+#define BENCHMARK_FRAMES 500
+#define BENCHMARK_ROUNDS 3
+#define BENCHMARK_FILE_NAME_SIZE 512
+
+typedef graphicsControllerStatus (*drawFunction)(uint32_t frame);
+
+/* helper functions needed only for benchmark */
+static graphicsControllerStatus drawBanner(uint32_t frame);
+static graphicsControllerStatus drawBannerUncached(uint32_t frame);
+static graphicsControllerStatus drawVolume(uint32_t frame);
+static graphicsControllerStatus drawFullScreen(uint32_t frame);
+static double runCase(drawFunction draw);
+static double elapsedSeconds(const struct timespec *start, const struct timespec *end);
+
+int main(int argc, char *argv[])
+{
+    static const struct
+    {
+        const char *name;
+        const char *fileName;
+        drawFunction draw;
+    } cases[] = {
+        {"channel banner", "channel_info.ppm", drawBanner},
+        {"banner, no font cache", "channel_info_uncached.ppm", drawBannerUncached},
+        {"volume bar", "volume_info.ppm", drawVolume},
+        {"full-screen clear", "clear.ppm", drawFullScreen},
+    };
+    char fileName[BENCHMARK_FILE_NAME_SIZE];
+    const char *dumpDir = argc > 1 ? argv[1] : NULL;
+    double seconds;
+    double bannerSeconds = 0;
+    uint32_t i;
+
+    if (eventLoopInit() != EVENT_LOOP_NO_ERROR || timerControllerInit() != TIMER_CONTROLLER_NO_ERROR || graphicsControllerInit() != GRAPHICS_CONTROLLER_NO_ERROR)
+    {
+        printf("Graphics controller initialization failed!\n");
+        return 1;
+    }
+
+    printf("frames per round: %d, best of %d rounds\n", BENCHMARK_FRAMES, BENCHMARK_ROUNDS);
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        seconds = runCase(cases[i].draw);
+        if (seconds < 0)
+        {
+            printf("Drawing %s failed!\n", cases[i].name);
+            graphicsControllerDeinit();
+            timerControllerDeinit();
+            eventLoopDeinit();
+            return 1;
+        }
+
+        printf("%-22s %10.1f frames/s %10.1f us/frame\n", cases[i].name, BENCHMARK_FRAMES / seconds, seconds / BENCHMARK_FRAMES * 1e6);
+        if (cases[i].draw == drawBanner)
+        {
+            bannerSeconds = seconds;
+        }
+        else if (cases[i].draw == drawBannerUncached && bannerSeconds > 0)
+        {
+            printf("%-22s %10.2fx\n", "font cache speedup", seconds / bannerSeconds);
+        }
+
+        if (dumpDir)
+        {
+            snprintf(fileName, BENCHMARK_FILE_NAME_SIZE, "%s/%s", dumpDir, cases[i].fileName);
+            if (dfbSimDumpFrame(fileName) != DFB_OK)
+            {
+                printf("Writing %s failed!\n", fileName);
+            }
+        }
+    }
+
+    graphicsControllerDeinit();
+    timerControllerDeinit();
+    eventLoopDeinit();
+    return 0;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for drawing channel banner of changing channel, as on zapping.*/
+static graphicsControllerStatus drawBanner(uint32_t frame)
+{
+    char subtitles[] = "engsrpdeu";
+
+    if (drawChannelInfo(frame % 30 + 1, frame % 4, frame % 4 ? subtitles + 3 * (3 - frame % 4) : NULL, frame % 101))
+    {
+        return GRAPHICS_CONTROLLER_ERROR;
+    }
+    return drawOnScreen();
+}
+
+/*Function for drawing channel banner with every font created again, as before font cache.*/
+static graphicsControllerStatus drawBannerUncached(uint32_t frame)
+{
+    graphicsControllerReleaseFonts();
+    return drawBanner(frame);
+}
+
+/*Function for drawing volume bar moving up and down, as on holding volume key.*/
+static graphicsControllerStatus drawVolume(uint32_t frame)
+{
+    uint32_t step = frame % 40;
+
+    if (drawVolumeInfo((step < 20 ? step : 40 - step) * 0.05))
+    {
+        return GRAPHICS_CONTROLLER_ERROR;
+    }
+    return drawOnScreen();
+}
+
+/*Function for clearing and flipping whole screen, the way every OSD change used to be shown.*/
+static graphicsControllerStatus drawFullScreen(uint32_t frame)
+{
+    if (clearScreen(COLOUR_BLACK))
+    {
+        return GRAPHICS_CONTROLLER_ERROR;
+    }
+    return drawOnScreen();
+}
+
+/*Function for running BENCHMARK_ROUNDS rounds of draw, returns seconds of fastest round or -1 on error.*/
+static double runCase(drawFunction draw)
+{
+    struct timespec start;
+    struct timespec end;
+    double best = -1;
+    double seconds;
+    uint32_t round;
+    uint32_t frame;
+
+    for (round = 0; round < BENCHMARK_ROUNDS; round++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (frame = 0; frame < BENCHMARK_FRAMES; frame++)
+        {
+            if (draw(frame) != GRAPHICS_CONTROLLER_NO_ERROR)
+            {
+                return -1;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        seconds = elapsedSeconds(&start, &end);
+        best = best < 0 || seconds < best ? seconds : best;
+    }
+
+    return best;
+}
+
+static double elapsedSeconds(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
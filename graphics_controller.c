@@ -1,12 +1,23 @@
 #include "graphics_controller.h"
 
 #include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#ifdef GRAPHICS_SOFTWARE
+#include "dfb_sim.h" // in-memory ARGB framebuffer instead of DirectFB
+#else
 #include <directfb.h>
+#endif
 #include "math.h"
 
 #include "timer_controller.h"
+#include "trace.h"
 
 
+#define FONT_FACE "/home/galois/fonts/DejaVuSans.ttf"
+#define FONT_CACHE_SIZE 8 // OSD uses five heights of one face
+#define OSD_TEXT_MARGIN 4  // pixels added around text extents for antialiasing
+
 // https://stackoverflow.com/questions/2570934/how-to-round-floating-point-numbers-to-the-nearest-integer-in-c
 #define roundNumber(x) ((int)((x) < 0.0 ? (x)-0.5 : (x) + 0.5))
 
@@ -28,17 +39,51 @@ static int screenWidth = 0;
 static int screenHeight = 0;
 static DFBSurfaceDescription surfaceDesc;
 
-static IDirectFBFont *fontInterface = NULL;
-static DFBFontDescription fontDesc;
-
-static timer_t timerChannelInfo;
-static timer_t timerChannelNumberMessage;
-static timer_t timerVolumeInfo;
+/* fonts are created on first use and kept until deinit or graphicsControllerReleaseFonts */
+typedef struct _fontCacheEntry
+{
+    const char *face;
+    int32_t height;
+    IDirectFBFont *font;
+} fontCacheEntry;
+
+static fontCacheEntry fontCache[FONT_CACHE_SIZE];
+static uint8_t fontCacheCount;
+static uint32_t fontCacheCreated;
+static uint32_t fontCacheHits;
+static pthread_mutex_t fontCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* OSD widgets, only one of them is shown at a time */
+typedef enum _osdWidget
+{
+    OSD_CHANNEL_BANNER = 0,
+    OSD_VOLUME_BAR,
+    OSD_CHANNEL_NUMBER,
+    OSD_MESSAGE,
+    OSD_WIDGET_COUNT
+} osdWidget;
+
+/* back buffer is kept between flips (DSFLIP_BLIT), so only damaged area has to be redrawn and shown */
+static DFBRectangle widgetArea[OSD_WIDGET_COUNT]; // area covered by widget, empty when hidden
+static DFBRegion damage;                          // union of areas changed since last flip
+static uint8_t damaged;
+static uint32_t flipCount;
+static uint64_t flippedPixels;
+
+static timerHandle timerChannelInfo;
+static timerHandle timerChannelNumberMessage;
+static timerHandle timerVolumeInfo;
 
 static uint8_t showingChannelInfo;
 static uint8_t showingVolumeInfo;
 
 /* helper functions needed only for graphics controller module */
+static DFBResult setFont(const char *face, int32_t height, IDirectFBFont **usedFont);
+static DFBResult osdBegin();
+static DFBResult osdHide(osdWidget widget);
+static void osdAddArea(osdWidget widget, int32_t x, int32_t y, int32_t width, int32_t height);
+static DFBResult osdAddText(osdWidget widget, IDirectFBFont *font, const char *text, int32_t x, int32_t y, DFBSurfaceTextFlags flags);
+static void addDamage(int32_t x, int32_t y, int32_t width, int32_t height);
 static void removeChannelInfo();
 static void removeVolumeInfo();
 static void removeMenuInfo();
@@ -63,11 +108,24 @@ graphicsControllerStatus graphicsControllerInit()
     /* fetch the screen size */
     DFBCHECK(primary->GetSize(primary, &screenWidth, &screenHeight));
 
+    /* start from transparent front and back buffer, later flips only copy damaged area */
+    clearScreen(COLOUR_BLACK);
+    drawOnScreen();
+
     return GRAPHICS_CONTROLLER_NO_ERROR;
 }
 
 graphicsControllerStatus graphicsControllerDeinit()
 {
+    traceStatistics("Font cache: %u fonts created, %u hits\n", fontCacheCreated, fontCacheHits);
+    graphicsControllerReleaseFonts();
+
+    if (flipCount)
+    {
+        traceStatistics("OSD: %u flips, %llu pixels per flip on average, %d pixels per frame\n", flipCount,
+                        (unsigned long long)(flippedPixels / flipCount), screenWidth * screenHeight);
+    }
+
     DFBCHECK(primary->Release(primary));
     DFBCHECK(dfbInterface->Release(dfbInterface));
 
@@ -76,75 +134,70 @@ graphicsControllerStatus graphicsControllerDeinit()
 
 graphicsControllerStatus drawChannelNumber(uint16_t channelNumberValue)
 {
-    if (timerChannelInfo)
-        timerStopAndDelete(&timerChannelInfo);
-    if (timerVolumeInfo)
-        timerStopAndDelete(&timerVolumeInfo);
-    if (timerChannelNumberMessage)
-        timerStopAndDelete(&timerChannelNumberMessage);
+    uint64_t traceStart = traceBegin();
+
+    timerStopAndDelete(&timerChannelInfo);
+    timerStopAndDelete(&timerVolumeInfo);
+    timerStopAndDelete(&timerChannelNumberMessage);
 
     char channelNumberString[4];
+    IDirectFBFont *font;
     sprintf(channelNumberString, "%d", channelNumberValue);
 
-    clearScreen(COLOUR_BLACK);
-
-    /* specify the height of the font by raising the appropriate flag and setting the height value */
-    fontDesc.flags = DFDESC_HEIGHT;
-    fontDesc.height = 100;
+    DFBCHECK(osdBegin());
 
-    /* create the font and set the created font for primary surface text drawing */
-    DFBCHECK(dfbInterface->CreateFont(dfbInterface, "/home/galois/fonts/DejaVuSans.ttf", &fontDesc, &fontInterface));
-    DFBCHECK(primary->SetFont(primary, fontInterface));
+    /* set font of given height for primary surface text drawing, font is created only on first use */
+    DFBCHECK(setFont(FONT_FACE, 100, &font));
 
     /* draw  channel number */
     DFBCHECK(primary->SetColor(primary, 0xff, 0xff, 0xff, COLOUR_WHITE));
     DFBCHECK(primary->DrawString(primary, channelNumberString, -1, screenHeight / 7, screenHeight / 7, DSTF_LEFT));
+    DFBCHECK(osdAddText(OSD_CHANNEL_NUMBER, font, channelNumberString, screenHeight / 7, screenHeight / 7, DSTF_LEFT));
 
+    traceEnd("drawChannelNumber", traceStart);
     return GRAPHICS_CONTROLLER_NO_ERROR;
 }
 
 graphicsControllerStatus drawChannelNumberMessage(uint16_t channelNumberValue)
 {
-    if (timerChannelInfo)
-        timerStopAndDelete(&timerChannelInfo);
-    if (timerVolumeInfo)
-        timerStopAndDelete(&timerVolumeInfo);
-    if (timerChannelNumberMessage)
-        timerStopAndDelete(&timerChannelNumberMessage);
+    uint64_t traceStart = traceBegin();
+
+    timerStopAndDelete(&timerChannelInfo);
+    timerStopAndDelete(&timerVolumeInfo);
+    timerStopAndDelete(&timerChannelNumberMessage);
 
     char message[27];
+    IDirectFBFont *font;
     sprintf(message, "Channel %d doesn't exist ", channelNumberValue);
 
-    clearScreen(COLOUR_BLACK);
-
-    /* specify the height of the font by raising the appropriate flag and setting the height value */
-    fontDesc.flags = DFDESC_HEIGHT;
-    fontDesc.height = 70;
+    DFBCHECK(osdBegin());
 
-    /* create the font and set the created font for primary surface text drawing */
-    DFBCHECK(dfbInterface->CreateFont(dfbInterface, "/home/galois/fonts/DejaVuSans.ttf", &fontDesc, &fontInterface));
-    DFBCHECK(primary->SetFont(primary, fontInterface));
+    /* set font of given height for primary surface text drawing, font is created only on first use */
+    DFBCHECK(setFont(FONT_FACE, 70, &font));
 
     /* draw yellow #FFA500 channel number */ ///CHANGED TO WHITE
     DFBCHECK(primary->SetColor(primary, 0xff, 0xff, 0xff, COLOUR_WHITE));
     DFBCHECK(primary->DrawString(primary, message, -1, screenHeight / 7, screenHeight / 7, DSTF_LEFT));
+    DFBCHECK(osdAddText(OSD_MESSAGE, font, message, screenHeight / 7, screenHeight / 7, DSTF_LEFT));
 
     /* timer setup */ ///CHANGED from 2 to 4
     timerSetAndStart(&timerChannelNumberMessage, 4, removeChannelNumberMessage);
 
+    traceEnd("drawChannelNumberMessage", traceStart);
     return GRAPHICS_CONTROLLER_NO_ERROR;
 }
 
-graphicsControllerStatus drawChannelInfo(uint16_t channelNumberValue, uint8_t subtitleCount, char *subtitles)
+graphicsControllerStatus drawChannelInfo(uint16_t channelNumberValue, uint8_t subtitleCount, char *subtitles, uint8_t signalQuality)
 {
-    if (timerChannelInfo)
-        timerStopAndDelete(&timerChannelInfo);
-    if (timerVolumeInfo)
-        timerStopAndDelete(&timerVolumeInfo);
-    if (timerChannelNumberMessage)
-        timerStopAndDelete(&timerChannelNumberMessage);
+    uint64_t traceStart = traceBegin();
+
+    timerStopAndDelete(&timerChannelInfo);
+    timerStopAndDelete(&timerVolumeInfo);
+    timerStopAndDelete(&timerChannelNumberMessage);
 
     char channelNumber[12];
+    char signal[16];
+    IDirectFBFont *font;
 
     if (channelNumberValue)
     {
@@ -183,35 +236,27 @@ graphicsControllerStatus drawChannelInfo(uint16_t channelNumberValue, uint8_t su
         channelSubtitles[subtitlesArraySize] = '\0';
     }
 
-    clearScreen(COLOUR_BLACK);
+    DFBCHECK(osdBegin());
 
     /* draw purple info rectangle */ ///CHANGED INFO FRAME COLOR TO BLUE
     DFBCHECK(primary->SetColor(primary, 0x80, 0x00, 0xff, COLOUR_WHITE));
     DFBCHECK(primary->FillRectangle(primary, screenWidth / 4, (5.3 * screenHeight) / 6.5, screenWidth / 2, screenHeight / 6));
+    osdAddArea(OSD_CHANNEL_BANNER, screenWidth / 4, (5.3 * screenHeight) / 6.5, screenWidth / 2, screenHeight / 6);
 
     /* draw darkPurple info rectangle */ ///SECOND CHANGE TO PURPLE INFO FILL
     DFBCHECK(primary->SetColor(primary, 0x5a, 0x00, 0xff, COLOUR_WHITE));
     DFBCHECK(primary->FillRectangle(primary, screenWidth / 4 + 5, (5.3 * screenHeight) / 6.5 + 5, screenWidth / 2 - 10, screenHeight / 6 - 10));
 
-    /* specify the height of the font by raising the appropriate flag and setting the height value */
-    fontDesc.flags = DFDESC_HEIGHT;
-    fontDesc.height = 68;
-
-    /* create the font and set the created font for primary surface text drawing */
-    DFBCHECK(dfbInterface->CreateFont(dfbInterface, "/home/galois/fonts/DejaVuSans.ttf", &fontDesc, &fontInterface));
-    DFBCHECK(primary->SetFont(primary, fontInterface));
+    /* set font of given height for primary surface text drawing, font is created only on first use */
+    DFBCHECK(setFont(FONT_FACE, 68, &font));
 
     /* draw yellow #FFA500 channel string information */ ///CHANGED - LETTERS AND POSITION OF CHANNEL NUMBER
     DFBCHECK(primary->SetColor(primary, 0xff, 0xff, 0xff, COLOUR_WHITE));
     DFBCHECK(primary->DrawString(primary, channelNumber, -1, screenWidth / 10 * 4 , (5.3 * screenHeight) / 6.5 + 80, DSTF_LEFT));
+    DFBCHECK(osdAddText(OSD_CHANNEL_BANNER, font, channelNumber, screenWidth / 10 * 4, (5.3 * screenHeight) / 6.5 + 80, DSTF_LEFT));
 
-    /* specify the height of the font by raising the appropriate flag and setting the height value */
-    fontDesc.flags = DFDESC_HEIGHT;
-    fontDesc.height = 48;
-
-    /* create the font and set the created font for primary surface text drawing */
-    DFBCHECK(dfbInterface->CreateFont(dfbInterface, "/home/galois/fonts/DejaVuSans.ttf", &fontDesc, &fontInterface));
-    DFBCHECK(primary->SetFont(primary, fontInterface));
+    /* set font of given height for primary surface text drawing, font is created only on first use */
+    DFBCHECK(setFont(FONT_FACE, 48, &font));
 	char broj_subtitle_kanala[4];
     char subs[10]="Subs: ";
     int iterator = 0;
@@ -223,40 +268,49 @@ graphicsControllerStatus drawChannelInfo(uint16_t channelNumberValue, uint8_t su
         subs[6+iterator]=broj_subtitle_kanala[iterator];
         }
         DFBCHECK(primary->DrawString(primary, subs, -1, screenWidth / 20 * 9, (5.3 * screenHeight) / 6.5 + 140, DSTF_LEFT));
+        DFBCHECK(osdAddText(OSD_CHANNEL_BANNER, font, subs, screenWidth / 20 * 9, (5.3 * screenHeight) / 6.5 + 140, DSTF_LEFT));
        
     }
     else
     {
         DFBCHECK(primary->DrawString(primary, "No available subtitles", -1, screenWidth / 80 * 29, (5.3 * screenHeight) / 6.5 + 140, DSTF_LEFT));
+        DFBCHECK(osdAddText(OSD_CHANNEL_BANNER, font, "No available subtitles", screenWidth / 80 * 29, (5.3 * screenHeight) / 6.5 + 140, DSTF_LEFT));
     }
 
-    /* timer setup */
-    if (showingChannelInfo)
+    /* draw signal quality in top right corner of banner */
+    if (signalQuality != SIGNAL_QUALITY_UNKNOWN)
     {
-        timerStopAndDelete(&timerChannelInfo);
+        DFBCHECK(setFont(FONT_FACE, 38, &font));
+        sprintf(signal, "Signal %u%%", signalQuality);
+        DFBCHECK(primary->DrawString(primary, signal, -1, screenWidth / 4 * 3 - 20, (5.3 * screenHeight) / 6.5 + 45, DSTF_RIGHT));
+        DFBCHECK(osdAddText(OSD_CHANNEL_BANNER, font, signal, screenWidth / 4 * 3 - 20, (5.3 * screenHeight) / 6.5 + 45, DSTF_RIGHT));
     }
+
+    /* timer setup, timer of shown banner is re-armed */
     timerSetAndStart(&timerChannelInfo, 4, removeChannelInfo);
     showingChannelInfo = 1;
 
+    traceEnd("drawChannelInfo", traceStart);
     return GRAPHICS_CONTROLLER_NO_ERROR;
 }
 
 
 graphicsControllerStatus drawVolumeInfo(float volumePercent)
 {
-    if (timerChannelInfo)
-        timerStopAndDelete(&timerChannelInfo);
-    if (timerVolumeInfo)
-        timerStopAndDelete(&timerVolumeInfo);
-    if (timerChannelNumberMessage)
-        timerStopAndDelete(&timerChannelNumberMessage);
+    uint64_t traceStart = traceBegin();
+
+    timerStopAndDelete(&timerChannelInfo);
+    timerStopAndDelete(&timerVolumeInfo);
+    timerStopAndDelete(&timerChannelNumberMessage);
 
     float volumePercent_1 = volumePercent + 0.01;
     char volume[4]; // 2 digits +  % sign + '\0' 
     uint8_t volumePercentInt = roundNumber(volumePercent * 100);
     
 
-    clearScreen(COLOUR_BLACK);
+    IDirectFBFont *font;
+
+    DFBCHECK(osdBegin());
 
     sprintf(volume, "%d%%", volumePercentInt);
 ///ADDED
@@ -264,57 +318,156 @@ graphicsControllerStatus drawVolumeInfo(float volumePercent)
 
     DFBCHECK(primary->SetColor(primary, 0x5a, 0x00, 0xff, COLOUR_WHITE));
     DFBCHECK(primary->FillRectangle(primary, screenWidth * 0.9 , screenHeight * 0.08, screenWidth / 14, screenHeight * 0.62));
+    osdAddArea(OSD_VOLUME_BAR, screenWidth * 0.9, screenHeight * 0.08, screenWidth / 14, screenHeight * 0.62);
     DFBCHECK(primary->SetColor(primary, 0xff, 0xff, 0xff, COLOUR_WHITE));
     DFBCHECK(primary->FillRectangle(primary, screenWidth * 0.91 , (screenHeight * 0.10) + ((1-volumePercent_1) * screenHeight * 0.5 ), screenWidth / 19, volumePercent_1 * screenHeight * 0.5 ));
     DFBCHECK(primary->SetColor(primary, 0xff, 0xff, 0xff, COLOUR_WHITE));
     DFBCHECK(primary->DrawRectangle(primary, screenWidth * 0.91 , screenHeight * 0.095 , screenWidth / 19, screenHeight * 0.5));
 
-    fontDesc.flags = DFDESC_HEIGHT;
-    fontDesc.height = 38;
-
-    /* create the font and set the created font for primary surface text drawing */
-    DFBCHECK(dfbInterface->CreateFont(dfbInterface, "/home/galois/fonts/DejaVuSans.ttf", &fontDesc, &fontInterface));
-    DFBCHECK(primary->SetFont(primary, fontInterface));
+    /* set font of given height for primary surface text drawing, font is created only on first use */
+    DFBCHECK(setFont(FONT_FACE, 38, &font));
 
     DFBCHECK(primary->SetColor(primary, 0xff, 0xff, 0xff, COLOUR_WHITE));
     DFBCHECK(primary->DrawString(primary, volume, -1, screenWidth * 0.96, screenHeight * 0.68 , DSTF_RIGHT));
+    DFBCHECK(osdAddText(OSD_VOLUME_BAR, font, volume, screenWidth * 0.96, screenHeight * 0.68, DSTF_RIGHT));
 
-    /* timer setup */
-    if (showingVolumeInfo)
-    {
-        timerStopAndDelete(&timerVolumeInfo);
-    }
+    /* timer setup, timer of shown banner is re-armed */
     timerSetAndStart(&timerVolumeInfo, 2, removeVolumeInfo);
     showingVolumeInfo = 1;
 
+    traceEnd("drawVolumeInfo", traceStart);
     return GRAPHICS_CONTROLLER_NO_ERROR;
 }
 
 graphicsControllerStatus drawOnScreen()
 {
-    /* switch between the displayed and the work buffer (update the display) */
-    DFBCHECK(primary->Flip(primary, NULL, 0));
+    uint64_t traceStart = traceBegin();
+
+    if (!damaged)
+    {
+        return GRAPHICS_CONTROLLER_NO_ERROR;
+    }
+
+    /* copy only damaged region from work buffer to displayed buffer, work buffer keeps its content */
+    DFBCHECK(primary->Flip(primary, &damage, DSFLIP_BLIT));
+
+    flipCount++;
+    flippedPixels += (uint64_t)(damage.x2 - damage.x1 + 1) * (damage.y2 - damage.y1 + 1);
+    damaged = 0;
+
+    traceEnd("Flip", traceStart);
     return GRAPHICS_CONTROLLER_NO_ERROR;
 }
 
 graphicsControllerStatus clearScreen(uint8_t alpha)
 {
+    uint64_t traceStart = traceBegin();
+
+    int32_t i;
+
     DFBCHECK(primary->SetColor(primary, COLOUR_BLACK, COLOUR_BLACK, COLOUR_BLACK, alpha));
     DFBCHECK(primary->FillRectangle(primary, 0, 0, screenWidth, screenHeight));
 
+    addDamage(0, 0, screenWidth, screenHeight);
+    for (i = 0; i < OSD_WIDGET_COUNT; i++)
+    {
+        widgetArea[i].w = 0;
+    }
+
+    traceEnd("clearScreen", traceStart);
     return GRAPHICS_CONTROLLER_NO_ERROR;
 }
 
+void graphicsControllerReleaseFonts()
+{
+    int32_t i;
+
+    pthread_mutex_lock(&fontCacheMutex);
+    for (i = 0; i < fontCacheCount; i++)
+    {
+        fontCache[i].font->Release(fontCache[i].font);
+        fontCache[i].font = NULL;
+    }
+    fontCacheCount = 0;
+    pthread_mutex_unlock(&fontCacheMutex);
+}
+
 /* -------------------- HELPER FUNCTIONS -------------------- */
+/****************************************************************************
+ * @brief    Function for setting font of given face and height to primary surface.
+ *           Font is looked up in font cache and created only on cache miss.
+ *           Surface holds its own reference, so evicted font stays valid while set.
+ *
+ * @param    face - [in] Path to font file.
+ *           height - [in] Font height in pixels.
+ *           usedFont - [out] Font set to surface, used for measuring drawn text.
+ *
+ * @return   DFB_OK, if there are no errors.
+ *           DirectFB error code, in case of an error.
+****************************************************************************/
+static DFBResult setFont(const char *face, int32_t height, IDirectFBFont **usedFont)
+{
+    DFBFontDescription fontDesc;
+    IDirectFBFont *font = NULL;
+    DFBResult result = DFB_OK;
+    uint64_t traceStart;
+    uint8_t slot;
+    int32_t i;
+
+    pthread_mutex_lock(&fontCacheMutex);
+    for (i = 0; i < fontCacheCount; i++)
+    {
+        if (fontCache[i].height == height && !strcmp(fontCache[i].face, face))
+        {
+            font = fontCache[i].font;
+            fontCacheHits++;
+            break;
+        }
+    }
+
+    if (!font)
+    {
+        fontDesc.flags = DFDESC_HEIGHT;
+        fontDesc.height = height;
+
+        traceStart = traceBegin();
+        result = dfbInterface->CreateFont(dfbInterface, face, &fontDesc, &font);
+        traceEnd("CreateFont", traceStart);
+
+        if (result == DFB_OK)
+        {
+            fontCacheCreated++;
+
+            /* cache is sized for all OSD fonts, last slot is reused if it is ever full */
+            slot = fontCacheCount < FONT_CACHE_SIZE ? fontCacheCount++ : FONT_CACHE_SIZE - 1;
+            if (fontCache[slot].font)
+            {
+                fontCache[slot].font->Release(fontCache[slot].font);
+            }
+            fontCache[slot].face = face;
+            fontCache[slot].height = height;
+            fontCache[slot].font = font;
+        }
+    }
+
+    if (result == DFB_OK)
+    {
+        result = primary->SetFont(primary, font);
+        *usedFont = font;
+    }
+    pthread_mutex_unlock(&fontCacheMutex);
+
+    return result;
+}
+
 /****************************************************************************
  * @brief    Function for removing channel information banner from screen at timer trigger.
 ****************************************************************************/
 static void removeChannelInfo()
 {
     showingChannelInfo = 0;
-    clearScreen(COLOUR_BLACK);
+    osdHide(OSD_CHANNEL_BANNER);
     drawOnScreen();
-    clearScreen(COLOUR_BLACK);
 }
 
 /****************************************************************************
@@ -325,9 +478,8 @@ static void removeVolumeInfo()
     if (!showingChannelInfo)
     {
         showingVolumeInfo = 0;
-        clearScreen(COLOUR_BLACK);
+        osdHide(OSD_VOLUME_BAR);
         drawOnScreen();
-        clearScreen(COLOUR_BLACK);
     }
 }
 
@@ -337,8 +489,178 @@ static void removeVolumeInfo()
 ****************************************************************************/
 static void removeChannelNumberMessage()
 {
-    clearScreen(COLOUR_BLACK);
+    osdHide(OSD_MESSAGE);
     drawOnScreen();
-    clearScreen(COLOUR_BLACK);
+}
+
+/****************************************************************************
+ * @brief    Function for starting to draw a widget. Widgets replace each other,
+ *           so areas of all shown widgets are cleared and added to damage.
+ *
+ * @return   DFB_OK, if there are no errors.
+ *           DirectFB error code, in case of an error.
+****************************************************************************/
+static DFBResult osdBegin()
+{
+    DFBResult result = DFB_OK;
+    int32_t i;
+
+    for (i = 0; i < OSD_WIDGET_COUNT && result == DFB_OK; i++)
+    {
+        result = osdHide((osdWidget)i);
+    }
+
+    return result;
+}
+
+/****************************************************************************
+ * @brief    Function for clearing area of widget on work buffer.
+ *
+ * @param    widget - [in] Widget to hide.
+ *
+ * @return   DFB_OK, if there are no errors.
+ *           DirectFB error code, in case of an error.
+****************************************************************************/
+static DFBResult osdHide(osdWidget widget)
+{
+    DFBRectangle *area = &widgetArea[widget];
+    DFBResult result;
+
+    if (!area->w)
+    {
+        return DFB_OK;
+    }
+
+    result = primary->SetColor(primary, COLOUR_BLACK, COLOUR_BLACK, COLOUR_BLACK, COLOUR_BLACK);
+    if (result == DFB_OK)
+    {
+        result = primary->FillRectangle(primary, area->x, area->y, area->w, area->h);
+    }
+
+    addDamage(area->x, area->y, area->w, area->h);
+    area->w = 0;
+
+    return result;
+}
+
+/****************************************************************************
+ * @brief    Function for adding drawn rectangle to widget area and damage.
+ *
+ * @param    widget - [in] Widget rectangle belongs to.
+ *           x, y, width, height - [in] Drawn rectangle.
+****************************************************************************/
+static void osdAddArea(osdWidget widget, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    DFBRectangle *area = &widgetArea[widget];
+    int32_t x2;
+    int32_t y2;
+
+    if (x < 0)
+    {
+        width += x;
+        x = 0;
+    }
+    if (y < 0)
+    {
+        height += y;
+        y = 0;
+    }
+    if (x + width > screenWidth)
+    {
+        width = screenWidth - x;
+    }
+    if (y + height > screenHeight)
+    {
+        height = screenHeight - y;
+    }
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    if (area->w)
+    {
+        x2 = area->x + area->w > x + width ? area->x + area->w : x + width;
+        y2 = area->y + area->h > y + height ? area->y + area->h : y + height;
+        area->x = area->x < x ? area->x : x;
+        area->y = area->y < y ? area->y : y;
+        area->w = x2 - area->x;
+        area->h = y2 - area->y;
+    }
+    else
+    {
+        area->x = x;
+        area->y = y;
+        area->w = width;
+        area->h = height;
+    }
+
+    addDamage(x, y, width, height);
+}
+
+/****************************************************************************
+ * @brief    Function for adding extents of drawn string to widget area.
+ *
+ * @param    widget - [in] Widget string belongs to.
+ *           font - [in] Font string was drawn with.
+ *           text - [in] Drawn string.
+ *           x, y - [in] Position passed to DrawString (baseline).
+ *           flags - [in] Alignment passed to DrawString.
+ *
+ * @return   DFB_OK, if there are no errors.
+ *           DirectFB error code, in case of an error.
+****************************************************************************/
+static DFBResult osdAddText(osdWidget widget, IDirectFBFont *font, const char *text, int32_t x, int32_t y, DFBSurfaceTextFlags flags)
+{
+    int width;
+    int height;
+    int ascender;
+    DFBResult result;
+
+    result = font->GetStringWidth(font, text, -1, &width);
+    if (result == DFB_OK)
+    {
+        result = font->GetHeight(font, &height);
+    }
+    if (result == DFB_OK)
+    {
+        result = font->GetAscender(font, &ascender);
+    }
+    if (result != DFB_OK)
+    {
+        return result;
+    }
+
+    if (flags & DSTF_RIGHT)
+    {
+        x -= width;
+    }
+
+    osdAddArea(widget, x - OSD_TEXT_MARGIN, y - ascender - OSD_TEXT_MARGIN, width + 2 * OSD_TEXT_MARGIN, height + 2 * OSD_TEXT_MARGIN);
+
+    return DFB_OK;
+}
+
+/****************************************************************************
+ * @brief    Function for adding rectangle to region shown by next flip.
+ *
+ * @param    x, y, width, height - [in] Changed rectangle.
+****************************************************************************/
+static void addDamage(int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    if (!damaged)
+    {
+        damage.x1 = x;
+        damage.y1 = y;
+        damage.x2 = x + width - 1;
+        damage.y2 = y + height - 1;
+        damaged = 1;
+        return;
+    }
+
+    damage.x1 = x < damage.x1 ? x : damage.x1;
+    damage.y1 = y < damage.y1 ? y : damage.y1;
+    damage.x2 = x + width - 1 > damage.x2 ? x + width - 1 : damage.x2;
+    damage.y2 = y + height - 1 > damage.y2 ? y + height - 1 : damage.y2;
 }
 
@@ -10,6 +10,7 @@
 
 #define COLOUR_BLACK 0x00
 #define COLOUR_WHITE 0xff
+#define SIGNAL_QUALITY_UNKNOWN 0xff // channel banner does not show signal quality
 
 typedef enum _graphicsControllerStatus
 {
@@ -33,6 +34,9 @@ graphicsControllerStatus graphicsControllerInit();
 ****************************************************************************/
 graphicsControllerStatus graphicsControllerDeinit();
 
+/*Function for releasing cached fonts, they are created again on next draw (used to measure drawing without font cache).*/
+void graphicsControllerReleaseFonts();
+
 /****************************************************************************
  * @brief    Function for drawing input channel number value.
  *
@@ -59,11 +63,12 @@ graphicsControllerStatus drawChannelNumberMessage(uint16_t channelNumberValue);
  * @param    channelNumberValue - [in] Channel number to draw.
  *           subtitleCount - [in] Channel number of subtitles.
  *           subtitles - [in] String with characters representing subtitle languages.
+ *           signalQuality - [in] Tuner signal quality, SIGNAL_QUALITY_UNKNOWN if it is not shown.
  *
  * @return   GRAPHICS_CONTROLLER_NO_ERROR, if there are no errors.
  *           GRAPHICS_CONTROLLER_ERROR, in case of an error.
 ****************************************************************************/
-graphicsControllerStatus drawChannelInfo(uint16_t channelNumberValue, uint8_t subtitleCount, char *subtitles);
+graphicsControllerStatus drawChannelInfo(uint16_t channelNumberValue, uint8_t subtitleCount, char *subtitles, uint8_t signalQuality);
 
 /****************************************************************************
  * @brief    Function for drawing volume information banner.
@@ -1,4 +1,8 @@
 #include "remote_controller.h"
+#include "timer_controller.h"
+#include "event_loop.h"
+#include "volume_controller.h"
+#include "trace.h"
 
 #include <linux/input.h>
 #include <fcntl.h>
@@ -6,8 +10,12 @@
 #include <unistd.h>
 #include <stdint.h>
 #include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
 
-/* helper keywords needed only for graphics controller module */
+/* helper keywords needed only for remote controller module */
 #define DEV_PATH "/dev/input/event0"
 #define NUM_EVENTS 5
 
@@ -34,20 +42,34 @@ static int32_t inputFileDesc;
 static struct input_event *eventBuf;
 
 static uint16_t channelNumber;
-static timer_t timerChannelNumber;
+static timerHandle timerChannelNumber;
 static uint8_t channelKeysPressed;
 static uint8_t channelKeys[3];
 
 static uint8_t showingMenuInfo;
+static uint8_t monotonicEventTime;
+
+/* input thread produces commands, event loop thread consumes them */
+static commandQueue commands;
+static pthread_t inputThreadHandle;
+static int32_t commandFileDesc = -1; // eventfd signalled when commands are queued
+static int32_t stopFileDesc = -1;    // eventfd signalled to stop input thread
 
 /* helper functions needed only for remote controller module */
 remoteControllerStatus getKeys(int32_t count, uint8_t *buf, int32_t *eventRead);
 static void generateChannelNumber(uint8_t remoteKey);
 static void changeChannel();
+static void *inputThread();
+static uint8_t decodeKey(struct input_event *event);
+static uint8_t queueCommand(commandType type, uint8_t argument, struct input_event *event);
+static void wakeUpConsumer();
+static void commandsReadable(int32_t fd, uint32_t events);
+static void executeCommand(command *nextCommand);
 
 remoteControllerStatus remoteControllerInit()
 {
     char deviceName[20];
+    int32_t clockId;
 
     inputFileDesc = open(DEV_PATH, O_RDWR);
     if (inputFileDesc == -1)
@@ -59,6 +81,10 @@ remoteControllerStatus remoteControllerInit()
     ioctl(inputFileDesc, EVIOCGNAME(sizeof(deviceName)), deviceName);
     printf("RC device opened succesfully [%s]\n", deviceName);
 
+    /* event time stamps on monotonic clock are used for zap latency measurement */
+    clockId = CLOCK_MONOTONIC;
+    monotonicEventTime = !ioctl(inputFileDesc, EVIOCSCLOCKID, &clockId);
+
     eventBuf = malloc(NUM_EVENTS * sizeof(struct input_event));
     if (!eventBuf)
     {
@@ -66,96 +92,259 @@ remoteControllerStatus remoteControllerInit()
         return REMOTE_CONTROLLER_ERROR;
     }
 
+    /* commands are executed on event loop thread, woken up through eventfd */
+    commandQueueReset(&commands);
+    commandFileDesc = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    stopFileDesc = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (commandFileDesc < 0 || stopFileDesc < 0 || eventLoopAddSource(commandFileDesc, commandsReadable) != EVENT_LOOP_NO_ERROR)
+    {
+        printf("Error while creating command queue!\n");
+        return REMOTE_CONTROLLER_ERROR;
+    }
+
+    /* input thread only reads and decodes keys, so reading never waits for a zap or redraw */
+    if (pthread_create(&inputThreadHandle, NULL, inputThread, NULL))
+    {
+        printf("Error while creating input thread!\n");
+        return REMOTE_CONTROLLER_ERROR;
+    }
+
+    return REMOTE_CONTROLLER_NO_ERROR;
+}
+
+remoteControllerStatus remoteControllerDeinit()
+{
+    uint64_t stop = 1;
+    commandQueueStatistics statistics;
+
+    if (write(stopFileDesc, &stop, sizeof(stop)) < 0)
+    {
+        printf("Error while stopping input thread!\n");
+    }
+    pthread_join(inputThreadHandle, NULL);
+
+    eventLoopRemoveSource(commandFileDesc);
+    close(commandFileDesc);
+    close(stopFileDesc);
+    close(inputFileDesc);
+    free(eventBuf);
+    eventBuf = NULL;
+
+    statistics = commandQueueGetStatistics(&commands);
+    traceStatistics("Remote commands: %u queued, %u dropped, max queue depth %u\n", statistics.pushed, statistics.dropped,
+                    statistics.maxDepth);
+
     return REMOTE_CONTROLLER_NO_ERROR;
 }
 
-void *remoteControllerEvent()
+commandQueueStatistics remoteControllerGetQueueStatistics()
+{
+    return commandQueueGetStatistics(&commands);
+}
+
+/*Function run by input thread, reads input events and queues decoded commands until deinit.*/
+static void *inputThread()
 {
-    uint32_t eventCnt;
-    uint32_t i;
-    uint32_t exit = 0;
+    struct pollfd descriptors[2];
+    int32_t eventCnt;
+    int32_t i;
+    uint8_t queued;
+    uint8_t exit = 0;
+    uint64_t traceStart;
+
+    traceSetThreadName("input");
+
+    descriptors[0].fd = inputFileDesc;
+    descriptors[0].events = POLLIN;
+    descriptors[1].fd = stopFileDesc;
+    descriptors[1].events = POLLIN;
 
-    while (exit == 0)
+    while (!exit)
     {
-        /* read input events */
+        if (poll(descriptors, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            printf("Error while waiting for input events!");
+            break;
+        }
+
+        if (descriptors[1].revents)
+        {
+            break;
+        }
+
+        traceStart = traceBegin();
         if (getKeys(NUM_EVENTS, (uint8_t *)eventBuf, &eventCnt))
         {
             printf("Error while reading input events!");
+            eventCnt = 0;
             exit = 1;
+            queueCommand(COMMAND_EXIT, 0, NULL);
         }
+        traceEnd("input read", traceStart);
 
+        queued = exit;
         for (i = 0; i < eventCnt; i++)
         {
-            if (eventBuf[i].value == 1)
-            {
-                switch (eventBuf[i].code)
-                {
-                case REMOTE_KEY_PROGRAM_UP:
-                    playNextChannel();
-                    break;
-
-                case REMOTE_KEY_PROGRAM_DOWN:
-                    playPreviousChannel();
-                    break;
-
-                case REMOTE_KEY_VOLUME_UP:
-                    volumeUp();
-                    break;
-
-                case REMOTE_KEY_VOLUME_DOWN:
-                    volumeDown();
-                    break;
-
-                case REMOTE_KEY_MUTE:
-                    volumeMute();
-                    break;
-
-                case REMOTE_KEY_INFO:
-                    showChannelInfo();
-                    break;
-            
-                case REMOTE_KEY_EXIT:
-                    exit = 1;
-                    break;
-
-                default:
-                    if (eventBuf[i].code >= 2 && eventBuf[i].code <= 11)
-                    {
-                        /* remote number buttor pressed */
-                        if (timerChannelNumber)
-                            timerStopAndDelete(&timerChannelNumber);
-                        if (eventBuf[i].code != 11)
-                            generateChannelNumber(eventBuf[i].code - 1);
-                        else
-                            generateChannelNumber(0);
-                        showChannelNumber(channelNumber);
-                        timerSetAndStart(&timerChannelNumber, 3, changeChannel);
-                    }
-                    else
-                    {
-                        printf("%d key not assigned!\n", eventBuf[i].code);
-                    }
-                    break;
-                } // switch exit
-            }     // if exit
-            else if (eventBuf[i].value == 2)
+            queued |= decodeKey(&eventBuf[i]);
+            exit |= eventBuf[i].value == 1 && eventBuf[i].code == REMOTE_KEY_EXIT;
+        }
+
+        /* one wake up per read, consumer drains everything queued so far */
+        if (queued)
+        {
+            wakeUpConsumer();
+        }
+    }
+
+    return NULL;
+}
+
+/*Function for turning input event into command, returns 1 if command was queued.*/
+static uint8_t decodeKey(struct input_event *event)
+{
+    if (event->value == 1)
+    {
+        switch (event->code)
+        {
+        case REMOTE_KEY_PROGRAM_UP:
+            return queueCommand(COMMAND_CHANNEL_UP, 0, event);
+
+        case REMOTE_KEY_PROGRAM_DOWN:
+            return queueCommand(COMMAND_CHANNEL_DOWN, 0, event);
+
+        case REMOTE_KEY_VOLUME_UP:
+            return queueCommand(COMMAND_VOLUME_UP, 0, event);
+
+        case REMOTE_KEY_VOLUME_DOWN:
+            return queueCommand(COMMAND_VOLUME_DOWN, 0, event);
+
+        case REMOTE_KEY_MUTE:
+            return queueCommand(COMMAND_VOLUME_MUTE, 0, event);
+
+        case REMOTE_KEY_INFO:
+            return queueCommand(COMMAND_CHANNEL_INFO, 0, event);
+
+        case REMOTE_KEY_EXIT:
+            return queueCommand(COMMAND_EXIT, 0, event);
+
+        default:
+            if (event->code >= REMOTE_KEY_1 && event->code <= REMOTE_KEY_0)
             {
-                switch (eventBuf[i].code)
-                {
-                case REMOTE_KEY_VOLUME_UP:
-                    volumeUp();
-                    break;
-
-                case REMOTE_KEY_VOLUME_DOWN:
-                    volumeDown();
-                    break;
-                } 
-            }     
-        }         
-    }             
+                /* remote number buttor pressed */
+                return queueCommand(COMMAND_CHANNEL_DIGIT, event->code == REMOTE_KEY_0 ? 0 : event->code - 1, event);
+            }
 
-    free(eventBuf);
-    return (void *)REMOTE_CONTROLLER_NO_ERROR;
+            printf("%d key not assigned!\n", event->code);
+            return 0;
+        }
+    }
+    else if (event->value == 2)
+    {
+        switch (event->code)
+        {
+        case REMOTE_KEY_VOLUME_UP:
+            return queueCommand(COMMAND_VOLUME_UP, 0, event);
+
+        case REMOTE_KEY_VOLUME_DOWN:
+            return queueCommand(COMMAND_VOLUME_DOWN, 0, event);
+        }
+    }
+
+    return 0;
+}
+
+/*Function for pushing command to queue, command is dropped if consumer fell behind.*/
+static uint8_t queueCommand(commandType type, uint8_t argument, struct input_event *event)
+{
+    command newCommand;
+
+    newCommand.type = type;
+    newCommand.argument = argument;
+    newCommand.timeValid = event && monotonicEventTime;
+    if (event)
+    {
+        newCommand.time = event->time;
+    }
+
+    return commandQueuePush(&commands, &newCommand) == COMMAND_QUEUE_NO_ERROR;
+}
+
+static void wakeUpConsumer()
+{
+    uint64_t one = 1;
+
+    if (write(commandFileDesc, &one, sizeof(one)) < 0 && errno != EAGAIN)
+    {
+        printf("Error while waking up command consumer!\n");
+    }
+}
+
+/*Function for executing all queued commands when event loop is woken up by input thread.*/
+static void commandsReadable(int32_t fd, uint32_t events)
+{
+    uint64_t counter;
+    command nextCommand;
+    uint64_t traceStart;
+
+    if (read(fd, &counter, sizeof(counter)) < 0)
+    {
+        return;
+    }
+
+    while (commandQueuePop(&commands, &nextCommand) == COMMAND_QUEUE_NO_ERROR)
+    {
+        traceStart = traceBegin();
+        executeCommand(&nextCommand);
+        traceEnd("key dispatch", traceStart);
+    }
+}
+
+/*Function for executing functions on corresponding command.*/
+static void executeCommand(command *nextCommand)
+{
+    switch (nextCommand->type)
+    {
+    case COMMAND_CHANNEL_UP:
+        zapKeyPressed(nextCommand->timeValid ? &nextCommand->time : NULL);
+        playNextChannel();
+        break;
+
+    case COMMAND_CHANNEL_DOWN:
+        zapKeyPressed(nextCommand->timeValid ? &nextCommand->time : NULL);
+        playPreviousChannel();
+        break;
+
+    case COMMAND_CHANNEL_DIGIT:
+        /* channel change timer is re-armed on every digit */
+        generateChannelNumber(nextCommand->argument);
+        showChannelNumber(channelNumber);
+        timerSetAndStart(&timerChannelNumber, 3, changeChannel);
+        break;
+
+    case COMMAND_VOLUME_UP:
+        volumeUp();
+        break;
+
+    case COMMAND_VOLUME_DOWN:
+        volumeDown();
+        break;
+
+    case COMMAND_VOLUME_MUTE:
+        volumeMute();
+        break;
+
+    case COMMAND_CHANNEL_INFO:
+        showChannelInfo();
+        break;
+
+    case COMMAND_EXIT:
+        eventLoopStop();
+        break;
+    }
 }
 
 /*Function for getting values from remote key press.*/
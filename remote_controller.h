@@ -2,6 +2,7 @@
 #define _REMOTE_CONTROLLER_H_
 
 #include "stream_controller.h"
+#include "command_queue.h"
 
 typedef enum _remoteControllerStatus
 {
@@ -9,10 +10,14 @@ typedef enum _remoteControllerStatus
     REMOTE_CONTROLLER_ERROR
 } remoteControllerStatus;
 
-/*Function for remote controller initialization.*/
+/*Function for remote controller initialization. Input thread is started, key presses are queued as commands
+  and executed on event loop thread.*/
 remoteControllerStatus remoteControllerInit();
 
-/*Function for executing functions on corresponding key press event.*/
-void *remoteControllerEvent();
+/*Function for stopping input thread and remote controller deinitialization.*/
+remoteControllerStatus remoteControllerDeinit();
+
+/*Function for getting command queue depth and counters, can be called from any thread.*/
+commandQueueStatistics remoteControllerGetQueueStatistics();
 
 #endif
@@ -0,0 +1,56 @@
+#ifndef _SECTION_ASSEMBLER_H_
+#define _SECTION_ASSEMBLER_H_
+
+#include <stdint.h>
+
+#define TS_PACKET_SIZE 188
+#define TS_SYNC_BYTE 0x47
+#define TS_PID_COUNT 8192
+#define SECTION_MAX_SIZE 4096
+
+typedef enum _sectionAssemblerStatus
+{
+    SECTION_ASSEMBLER_NO_ERROR = 0,
+    SECTION_ASSEMBLER_ERROR
+} sectionAssemblerStatus;
+
+/* called for every complete section which passed CRC check, section buffer is reused after return */
+typedef void (*sectionAssemblerCallback)(uint8_t *section, uint16_t sectionLength, void *userData);
+
+typedef struct _sectionAssemblerStatistics
+{
+    uint32_t packets;
+    uint32_t sections;
+    uint32_t crcErrors;
+    uint32_t continuityErrors;
+    uint32_t lengthErrors;
+} sectionAssemblerStatistics;
+
+typedef struct _sectionAssembler
+{
+    uint16_t pid;
+    uint8_t continuityCounter;
+    uint8_t continuityValid;
+    uint8_t synced;
+    uint16_t sectionFill;
+    uint8_t section[SECTION_MAX_SIZE];
+
+    sectionAssemblerCallback callback;
+    void *userData;
+
+    sectionAssemblerStatistics statistics;
+} sectionAssembler;
+
+/*Function for initializing section assembler for one PID.*/
+void sectionAssemblerInit(sectionAssembler *assembler, uint16_t pid, sectionAssemblerCallback callback, void *userData);
+
+/*Function for dropping partially assembled section, e.g. after retune.*/
+void sectionAssemblerReset(sectionAssembler *assembler);
+
+/*Function for feeding one 188 byte transport stream packet to section assembler.*/
+sectionAssemblerStatus sectionAssemblerPushPacket(sectionAssembler *assembler, const uint8_t *packet);
+
+/*Function for calculating CRC-32/MPEG-2 of data. Result over whole section including CRC field is 0 for valid section.*/
+uint32_t sectionCrc32(const uint8_t *data, uint32_t length);
+
+#endif // _SECTION_ASSEMBLER_H_
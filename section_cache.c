@@ -0,0 +1,121 @@
+#include "section_cache.h"
+
+#include <string.h>
+
+/* helper keywords needed only for section cache module */
+#define SECTION_CACHE_MASK (SECTION_CACHE_SIZE - 1)
+#define SECTION_CACHE_MAX_PROBES 16
+#define CRC_SIZE 4
+
+/* helper functions needed only for section cache module */
+static uint64_t sectionKey(uint16_t pid, const uint8_t *section);
+static uint32_t keyHash(uint64_t key);
+static sectionCacheEntry *findEntry(sectionCache *cache, uint64_t key, uint8_t insert);
+
+void sectionCacheReset(sectionCache *cache)
+{
+    memset(cache, 0, sizeof(sectionCache));
+}
+
+sectionCacheStatus sectionCacheCheck(sectionCache *cache, uint16_t pid, const uint8_t *section)
+{
+    uint16_t sectionLength = ((section[1] & 0x0F) << 8) | section[2];
+    uint8_t versionNumber;
+    uint32_t crc;
+    sectionCacheEntry *entry;
+
+    /* short form sections have neither version nor CRC */
+    if (!(section[1] & 0x80) || sectionLength < 5 + CRC_SIZE)
+    {
+        cache->statistics.misses++;
+        return SECTION_CACHE_MISS;
+    }
+
+    versionNumber = (section[5] >> 1) & 0x1F;
+    crc = ((uint32_t)section[sectionLength - 1] << 24) | (section[sectionLength] << 16) |
+          (section[sectionLength + 1] << 8) | section[sectionLength + 2];
+
+    entry = findEntry(cache, sectionKey(pid, section), 1);
+    if (entry->used && entry->versionNumber == versionNumber && entry->crc == crc)
+    {
+        cache->statistics.hits++;
+        return SECTION_CACHE_HIT;
+    }
+
+    entry->versionNumber = versionNumber;
+    entry->crc = crc;
+    entry->used = 1;
+    cache->statistics.misses++;
+
+    return SECTION_CACHE_MISS;
+}
+
+void sectionCacheInvalidate(sectionCache *cache, uint16_t pid, const uint8_t *section)
+{
+    sectionCacheEntry *entry = findEntry(cache, sectionKey(pid, section), 0);
+
+    if (entry)
+    {
+        /* entry keeps its key so probe chains stay intact, only comparison fails */
+        entry->crc = ~entry->crc;
+    }
+}
+
+sectionCacheStatistics sectionCacheGetStatistics(sectionCache *cache)
+{
+    return cache->statistics;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for packing PID, table_id, table_id_extension and section_number to one key.*/
+static uint64_t sectionKey(uint16_t pid, const uint8_t *section)
+{
+    return ((uint64_t)(pid & 0x1FFF) << 32) | ((uint64_t)section[0] << 24) | (section[3] << 16) | (section[4] << 8) | section[6];
+}
+
+/*Function for spreading key bits over table index (Fibonacci hashing).*/
+static uint32_t keyHash(uint64_t key)
+{
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 40);
+}
+
+/*Function for finding entry with linear probing; with insert set a free or evicted entry is returned for unknown key.*/
+static sectionCacheEntry *findEntry(sectionCache *cache, uint64_t key, uint8_t insert)
+{
+    uint32_t index = keyHash(key) & SECTION_CACHE_MASK;
+    sectionCacheEntry *entry;
+    int32_t probe;
+
+    for (probe = 0; probe < SECTION_CACHE_MAX_PROBES; probe++)
+    {
+        entry = &cache->entries[(index + probe) & SECTION_CACHE_MASK];
+
+        if (!entry->used)
+        {
+            if (insert)
+            {
+                entry->key = key;
+            }
+            return insert ? entry : NULL;
+        }
+
+        if (entry->key == key)
+        {
+            return entry;
+        }
+    }
+
+    if (!insert)
+    {
+        return NULL;
+    }
+
+    /* probe chain full, home slot is reused */
+    cache->statistics.evictions++;
+    entry = &cache->entries[index];
+    entry->key = key;
+    entry->used = 0;
+
+    return entry;
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
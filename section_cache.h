@@ -0,0 +1,59 @@
+#ifndef _SECTION_CACHE_H_
+#define _SECTION_CACHE_H_
+
+#include <stdint.h>
+
+#define SECTION_CACHE_SIZE 2048 // entries, power of two
+
+typedef enum _sectionCacheStatus
+{
+    SECTION_CACHE_MISS = 0, // new or changed section, has to be parsed
+    SECTION_CACHE_HIT       // unchanged repetition, can be dropped
+} sectionCacheStatus;
+
+typedef struct _sectionCacheStatistics
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+} sectionCacheStatistics;
+
+typedef struct _sectionCacheEntry
+{
+    uint64_t key;
+    uint32_t crc;
+    uint8_t versionNumber;
+    uint8_t used;
+} sectionCacheEntry;
+
+typedef struct _sectionCache
+{
+    sectionCacheEntry entries[SECTION_CACHE_SIZE];
+    sectionCacheStatistics statistics;
+} sectionCache;
+
+/*Function for emptying cache and resetting counters, e.g. on retune.*/
+void sectionCacheReset(sectionCache *cache);
+
+/****************************************************************************
+ * @brief    Function for checking whether section is an unchanged repetition.
+ *           Sections are keyed by (PID, table_id, table_id_extension, section_number)
+ *           and compared by version_number and CRC_32 read from the section itself,
+ *           so a hit costs a header read and one hash probe. On miss the entry is updated.
+ *
+ * @param    cache - [in] Section cache.
+ *           pid - [in] PID section was received on.
+ *           section - [in] Complete section starting with table_id.
+ *
+ * @return   SECTION_CACHE_HIT, if the same section was already seen.
+ *           SECTION_CACHE_MISS, if section is new or changed.
+****************************************************************************/
+sectionCacheStatus sectionCacheCheck(sectionCache *cache, uint16_t pid, const uint8_t *section);
+
+/*Function for invalidating cached entry, so next repetition of section is parsed again.*/
+void sectionCacheInvalidate(sectionCache *cache, uint16_t pid, const uint8_t *section);
+
+/*Function for getting hit and miss counters.*/
+sectionCacheStatistics sectionCacheGetStatistics(sectionCache *cache);
+
+#endif // _SECTION_CACHE_H_
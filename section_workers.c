@@ -0,0 +1,237 @@
+#include "section_workers.h"
+#include "trace.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+/* section copied into worker queue */
+typedef struct _queuedSection
+{
+    uint16_t size;
+    uint8_t data[SECTION_WORKER_SECTION_MAX_SIZE];
+} queuedSection;
+
+/* single producer, single consumer ring of one worker, indexes are on own cache lines */
+typedef struct _sectionWorker
+{
+    uint32_t tail __attribute__((aligned(SECTION_WORKER_CACHE_LINE))); // written by poster
+    uint32_t posted;
+    uint32_t dropped;
+    uint32_t head __attribute__((aligned(SECTION_WORKER_CACHE_LINE))); // written by worker
+    uint32_t cacheGeneration;
+    int32_t wakeFileDesc; // eventfd signalled when section is posted into empty queue
+    pthread_t threadHandle;
+    sectionCache cache;
+    queuedSection sections[SECTION_WORKER_QUEUE_SIZE];
+} sectionWorker;
+
+/* helper variables needed only for section workers module */
+static sectionWorker workers[SECTION_WORKERS_MAX];
+static uint32_t workerCount;
+static uint32_t cacheGeneration; // incremented to make workers reset their caches
+static sectionWorkerHandler workerHandler;
+static int32_t stopFileDesc = -1; // eventfd signalled to stop all workers
+
+/* helper functions needed only for section workers module */
+static void *workerThread(void *argument);
+static void wakeWorker(int32_t fileDesc);
+
+sectionWorkersStatus sectionWorkersInit(sectionWorkerHandler handler)
+{
+    long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t count = cpuCount < 1 ? 1 : cpuCount > SECTION_WORKERS_MAX ? SECTION_WORKERS_MAX : cpuCount;
+    uint32_t i;
+
+    workerHandler = handler;
+    workerCount = 0;
+    stopFileDesc = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stopFileDesc < 0)
+    {
+        printf("sectionWorkersInit: eventfd fail\n");
+        return SECTION_WORKERS_ERROR;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        memset(&workers[i], 0, sizeof(sectionWorker));
+        workers[i].cacheGeneration = __atomic_load_n(&cacheGeneration, __ATOMIC_RELAXED);
+        workers[i].wakeFileDesc = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (workers[i].wakeFileDesc < 0 || pthread_create(&workers[i].threadHandle, NULL, workerThread, &workers[i]))
+        {
+            printf("sectionWorkersInit: worker %u fail\n", i);
+            if (workers[i].wakeFileDesc >= 0)
+            {
+                close(workers[i].wakeFileDesc);
+            }
+            sectionWorkersDeinit();
+            return SECTION_WORKERS_ERROR;
+        }
+
+        /* poster sees worker only once it runs */
+        __atomic_store_n(&workerCount, i + 1, __ATOMIC_RELEASE);
+    }
+
+    return SECTION_WORKERS_NO_ERROR;
+}
+
+sectionWorkersStatus sectionWorkersDeinit()
+{
+    uint32_t count = __atomic_exchange_n(&workerCount, 0, __ATOMIC_ACQ_REL);
+    uint64_t stop = 1;
+    uint32_t i;
+
+    if (stopFileDesc < 0)
+    {
+        return SECTION_WORKERS_ERROR;
+    }
+
+    if (write(stopFileDesc, &stop, sizeof(stop)) < 0)
+    {
+        printf("sectionWorkersDeinit: stopping workers fail\n");
+    }
+
+    /* counters stay readable after workers are joined */
+    for (i = 0; i < count; i++)
+    {
+        pthread_join(workers[i].threadHandle, NULL);
+        close(workers[i].wakeFileDesc);
+        workers[i].wakeFileDesc = -1;
+    }
+    close(stopFileDesc);
+    stopFileDesc = -1;
+    workerCount = count;
+
+    return SECTION_WORKERS_NO_ERROR;
+}
+
+sectionWorkersStatus sectionWorkersPost(uint16_t key, const uint8_t *section, uint16_t size)
+{
+    uint32_t count = __atomic_load_n(&workerCount, __ATOMIC_ACQUIRE);
+    sectionWorker *worker;
+    uint32_t tail;
+
+    if (!count || size > SECTION_WORKER_SECTION_MAX_SIZE || stopFileDesc < 0)
+    {
+        return SECTION_WORKERS_ERROR;
+    }
+
+    worker = &workers[key % count];
+    tail = worker->tail;
+    if (tail - __atomic_load_n(&worker->head, __ATOMIC_ACQUIRE) == SECTION_WORKER_QUEUE_SIZE)
+    {
+        __atomic_store_n(&worker->dropped, worker->dropped + 1, __ATOMIC_RELAXED);
+        return SECTION_WORKERS_ERROR;
+    }
+
+    worker->sections[tail & (SECTION_WORKER_QUEUE_SIZE - 1)].size = size;
+    memcpy(worker->sections[tail & (SECTION_WORKER_QUEUE_SIZE - 1)].data, section, size);
+    __atomic_store_n(&worker->posted, worker->posted + 1, __ATOMIC_RELAXED);
+
+    /* worker sleeps only after it has seen empty queue, either it sees new tail or poster sees head
+       it stopped at, both accesses are sequentially consistent */
+    __atomic_store_n(&worker->tail, tail + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&worker->head, __ATOMIC_SEQ_CST) == tail)
+    {
+        wakeWorker(worker->wakeFileDesc);
+    }
+
+    return SECTION_WORKERS_NO_ERROR;
+}
+
+void sectionWorkersResetCaches()
+{
+    __atomic_fetch_add(&cacheGeneration, 1, __ATOMIC_RELEASE);
+}
+
+sectionWorkersStatistics sectionWorkersGetStatistics()
+{
+    sectionWorkersStatistics statistics;
+    uint32_t i;
+
+    memset(&statistics, 0, sizeof(sectionWorkersStatistics));
+    statistics.workerCount = workerCount;
+    for (i = 0; i < workerCount; i++)
+    {
+        statistics.posted += __atomic_load_n(&workers[i].posted, __ATOMIC_RELAXED);
+        statistics.dropped += __atomic_load_n(&workers[i].dropped, __ATOMIC_RELAXED);
+        statistics.cache.hits += workers[i].cache.statistics.hits;
+        statistics.cache.misses += workers[i].cache.statistics.misses;
+        statistics.cache.evictions += workers[i].cache.statistics.evictions;
+    }
+
+    return statistics;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function run by worker thread, queued sections are handled in order until deinit.*/
+static void *workerThread(void *argument)
+{
+    sectionWorker *worker = (sectionWorker *)argument;
+    struct pollfd descriptors[2];
+    uint32_t head = worker->head;
+    uint32_t generation;
+    uint64_t counter;
+    uint64_t traceStart;
+    queuedSection *section;
+
+    traceSetThreadName("section worker");
+
+    descriptors[0].fd = worker->wakeFileDesc;
+    descriptors[0].events = POLLIN;
+    descriptors[1].fd = stopFileDesc;
+    descriptors[1].events = POLLIN;
+
+    while (1)
+    {
+        while (head != __atomic_load_n(&worker->tail, __ATOMIC_SEQ_CST))
+        {
+            generation = __atomic_load_n(&cacheGeneration, __ATOMIC_ACQUIRE);
+            if (generation != worker->cacheGeneration)
+            {
+                sectionCacheReset(&worker->cache);
+                worker->cacheGeneration = generation;
+            }
+
+            section = &worker->sections[head & (SECTION_WORKER_QUEUE_SIZE - 1)];
+            traceStart = traceBegin();
+            workerHandler(section->data, section->size, &worker->cache);
+            traceEnd("section worker", traceStart);
+
+            /* slot may be reused by poster only after section is handled */
+            __atomic_store_n(&worker->head, ++head, __ATOMIC_SEQ_CST);
+        }
+
+        if (poll(descriptors, 2, -1) < 0 && errno != EINTR)
+        {
+            printf("Section worker poll failed: %s\n", strerror(errno));
+            break;
+        }
+        if (descriptors[1].revents & POLLIN)
+        {
+            break;
+        }
+        if ((descriptors[0].revents & POLLIN) && read(worker->wakeFileDesc, &counter, sizeof(counter)) < 0 && errno != EAGAIN)
+        {
+            printf("Section worker wake up read failed: %s\n", strerror(errno));
+        }
+    }
+
+    return NULL;
+}
+
+/*Function for making worker wake up descriptor readable.*/
+static void wakeWorker(int32_t fileDesc)
+{
+    uint64_t one = 1;
+
+    if (write(fileDesc, &one, sizeof(one)) < 0 && errno != EAGAIN)
+    {
+        printf("Section worker wake up failed: %s\n", strerror(errno));
+    }
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
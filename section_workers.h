@@ -0,0 +1,66 @@
+#ifndef _SECTION_WORKERS_H_
+#define _SECTION_WORKERS_H_
+
+#include "section_cache.h"
+
+#include <stdint.h>
+
+#define SECTION_WORKERS_MAX 4
+#define SECTION_WORKER_QUEUE_SIZE 64          // sections waiting per worker, power of two, further ones are dropped
+#define SECTION_WORKER_SECTION_MAX_SIZE 4096  // largest private section
+#define SECTION_WORKER_CACHE_LINE 64
+
+typedef enum _sectionWorkersStatus
+{
+    SECTION_WORKERS_NO_ERROR = 0,
+    SECTION_WORKERS_ERROR
+} sectionWorkersStatus;
+
+/* called on worker thread with copy of section and cache owned by that worker, section is valid only during the call */
+typedef void (*sectionWorkerHandler)(uint8_t *section, uint16_t size, sectionCache *cache);
+
+typedef struct _sectionWorkersStatistics
+{
+    uint32_t workerCount;
+    uint32_t posted;
+    uint32_t dropped; // queue of worker was full
+    sectionCacheStatistics cache; // sum over worker caches
+} sectionWorkersStatistics;
+
+/****************************************************************************
+ * @brief    Function for starting one worker thread per CPU, at most
+ *           SECTION_WORKERS_MAX. Each worker has preallocated queue of
+ *           sections and its own section cache.
+ *
+ * @param    handler - [in] Function parsing section on worker thread.
+ *
+ * @return   SECTION_WORKERS_NO_ERROR, if there are no errors.
+ *           SECTION_WORKERS_ERROR, in case of an error.
+****************************************************************************/
+sectionWorkersStatus sectionWorkersInit(sectionWorkerHandler handler);
+
+/*Function for stopping and joining workers, sections still queued are dropped.*/
+sectionWorkersStatus sectionWorkersDeinit();
+
+/****************************************************************************
+ * @brief    Function for handing section over to worker. Must be called from
+ *           one thread only (SDK demux callback), never blocks: section is
+ *           copied into free slot of worker queue without lock. Sections of
+ *           the same key go to the same worker and are handled in order.
+ *
+ * @param    key - [in] Key selecting worker, e.g. service id.
+ *           section - [in] Complete section starting with table_id.
+ *           size - [in] Size of section, at most SECTION_WORKER_SECTION_MAX_SIZE.
+ *
+ * @return   SECTION_WORKERS_NO_ERROR, if section is queued.
+ *           SECTION_WORKERS_ERROR, if workers are not running, section is too big or queue is full.
+****************************************************************************/
+sectionWorkersStatus sectionWorkersPost(uint16_t key, const uint8_t *section, uint16_t size);
+
+/*Function for making every worker empty its cache before next section, e.g. on retune. Can be called from any thread.*/
+void sectionWorkersResetCaches();
+
+/*Function for getting counters, cache counters are exact only once workers are stopped.*/
+sectionWorkersStatistics sectionWorkersGetStatistics();
+
+#endif // _SECTION_WORKERS_H_
@@ -0,0 +1,254 @@
+/**
+ * @file section_workers_benchmark.c
+ *
+ * @brief Benchmark of EIT flood handed over to event loop directly and through section workers.
+ *
+ * Usage: section_workers_benchmark
+ * Producer thread stands in for SDK demux callback and posts EIT present/following
+ * sections of 32 services in bursts of all 64 sections every millisecond, about four
+ * times as many sections as DVB-T multiplex full of EIT carries. Version of every
+ * section changes once per BENCHMARK_VERSION_ROUNDS bursts. Sections are either
+ * posted to event loop, which checks section cache and parses them there (handling
+ * before section workers), or to section workers, which post only tables of changed
+ * sections. Events lost to full event loop queue and tables which reached the loop
+ * are counted for both.
+ */
+
+#include "section_workers.h"
+#include "section_assembler.h"
+#include "tables_parser.h"
+#include "descriptor_parser.h"
+#include "event_loop.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/* helper keywords needed only for benchmark */
+#define BENCHMARK_SERVICES 32
+#define BENCHMARK_SECTIONS (BENCHMARK_SERVICES * 2) // present and following section per service
+#define BENCHMARK_ROUNDS 2000                       // bursts of all sections
+#define BENCHMARK_VERSION_ROUNDS 100                // bursts of one section version
+#define BENCHMARK_BURST_GAP_NS 1000000
+#define BENCHMARK_DRAIN_NS 100000000 // queued sections are handled before loop is stopped
+#define BENCHMARK_EIT_TABLE_ID 0x4E
+#define BENCHMARK_EIT_PID 0x0012
+#define SECTION_BUFFER_SIZE 1024
+
+/* helper variables needed only for benchmark */
+static uint8_t sections[BENCHMARK_SECTIONS][SECTION_BUFFER_SIZE];
+static uint16_t sectionSizes[BENCHMARK_SECTIONS];
+static sectionCache loopCache;
+static uint32_t loopDropped;  // posts to full event loop queue, written by producer or workers
+static uint32_t loopEvents;   // posted events handled, written by event loop thread only
+static uint32_t tablesParsed; // written by event loop thread only
+
+/* helper functions needed only for benchmark */
+static uint16_t generateEIT(uint8_t *section, uint16_t serviceId, uint8_t sectionNumber, uint8_t version);
+static void *producerThread(void *argument);
+static void sectionReceived(uint8_t *section, uint16_t size);
+static void workerParse(uint8_t *section, uint16_t size, sectionCache *cache);
+static void tableReceived(uint8_t *data, uint16_t size);
+static uint8_t runCase(uint8_t useWorkers);
+
+int main()
+{
+    printf("%d services, %d sections posted, %d tables changed\n", BENCHMARK_SERVICES, BENCHMARK_SECTIONS * BENCHMARK_ROUNDS,
+           BENCHMARK_SECTIONS * BENCHMARK_ROUNDS / BENCHMARK_VERSION_ROUNDS);
+
+    if (!runCase(0) || !runCase(1))
+    {
+        printf("Benchmark setup failed!\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for generating EIT present/following section with one event and its short event descriptor.*/
+static uint16_t generateEIT(uint8_t *section, uint16_t serviceId, uint8_t sectionNumber, uint8_t version)
+{
+    static const char name[] = "Benchmark show";
+    static const char text[] = "Description of present or following show of typical length";
+    uint8_t *event = section + 14;
+    uint8_t *descriptor = event + 12;
+    uint16_t descriptorsLength = 2 + 3 + 1 + (sizeof(name) - 1) + 1 + (sizeof(text) - 1);
+    uint16_t size = 14 + 12 + descriptorsLength;
+    uint16_t sectionLength = size + 4 - 3;
+    uint32_t crc;
+
+    memset(section, 0, SECTION_BUFFER_SIZE);
+    section[0] = BENCHMARK_EIT_TABLE_ID;
+    section[1] = 0xF0 | (sectionLength >> 8);
+    section[2] = sectionLength & 0xFF;
+    section[3] = serviceId >> 8;
+    section[4] = serviceId & 0xFF;
+    section[5] = 0xC1 | ((version & 0x1F) << 1);
+    section[6] = sectionNumber;
+    section[7] = 1;
+    section[9] = 1;  // transport stream id
+    section[11] = 1; // original network id
+    section[12] = 1;
+    section[13] = BENCHMARK_EIT_TABLE_ID;
+
+    /* event of 1 h at 20:00 UTC, running status in upper bits of descriptors loop length */
+    event[0] = serviceId >> 7;
+    event[1] = ((serviceId << 1) | sectionNumber) & 0xFF;
+    event[2] = 0xEA;
+    event[3] = 0x00;
+    event[4] = 0x20;
+    event[7] = 0x01;
+    event[10] = (sectionNumber ? 0x20 : 0x80) | (descriptorsLength >> 8);
+    event[11] = descriptorsLength & 0xFF;
+
+    descriptor[0] = SHORT_EVENT_DESCRIPTOR_TAG;
+    descriptor[1] = descriptorsLength - 2;
+    memcpy(descriptor + 2, "eng", 3);
+    descriptor[5] = sizeof(name) - 1;
+    memcpy(descriptor + 6, name, sizeof(name) - 1);
+    descriptor[6 + sizeof(name) - 1] = sizeof(text) - 1;
+    memcpy(descriptor + 7 + sizeof(name) - 1, text, sizeof(text) - 1);
+
+    crc = sectionCrc32(section, size);
+    section[size] = crc >> 24;
+    section[size + 1] = (crc >> 16) & 0xFF;
+    section[size + 2] = (crc >> 8) & 0xFF;
+    section[size + 3] = crc & 0xFF;
+
+    return size + 4;
+}
+
+/*Function run by producer thread, posts every section BENCHMARK_ROUNDS times and stops event loop.*/
+static void *producerThread(void *argument)
+{
+    struct timespec gap = {0, BENCHMARK_BURST_GAP_NS};
+    struct timespec drain = {0, BENCHMARK_DRAIN_NS};
+    uint8_t useWorkers = *(uint8_t *)argument;
+    uint32_t round;
+    uint32_t i;
+
+    for (round = 0; round < BENCHMARK_ROUNDS; round++)
+    {
+        for (i = 0; i < BENCHMARK_SECTIONS; i++)
+        {
+            if (round % BENCHMARK_VERSION_ROUNDS == 0)
+            {
+                sectionSizes[i] = generateEIT(sections[i], i / 2 + 1, i % 2, round / BENCHMARK_VERSION_ROUNDS);
+            }
+
+            if (useWorkers)
+            {
+                sectionWorkersPost((uint16_t)(sections[i][3] << 8) + sections[i][4], sections[i], sectionSizes[i]);
+            }
+            else if (eventLoopPost(sectionReceived, sections[i], sectionSizes[i]) != EVENT_LOOP_NO_ERROR)
+            {
+                __atomic_fetch_add(&loopDropped, 1, __ATOMIC_RELAXED);
+            }
+        }
+        nanosleep(&gap, NULL);
+    }
+
+    nanosleep(&drain, NULL);
+    eventLoopStop();
+
+    return NULL;
+}
+
+/*Function for parsing section on event loop, as sections were handled before section workers.*/
+static void sectionReceived(uint8_t *section, uint16_t size)
+{
+    eitTable eit;
+
+    loopEvents++;
+    if (sectionCacheCheck(&loopCache, BENCHMARK_EIT_PID, section) == SECTION_CACHE_HIT)
+    {
+        return;
+    }
+
+    if (parseEIT(section, &eit) == TABLES_PARSER_NO_ERROR)
+    {
+        tablesParsed++;
+    }
+}
+
+/*Function for parsing section on worker thread, only tables of changed sections are posted to event loop.*/
+static void workerParse(uint8_t *section, uint16_t size, sectionCache *cache)
+{
+    eitTable eit;
+
+    if (sectionCacheCheck(cache, BENCHMARK_EIT_PID, section) == SECTION_CACHE_HIT)
+    {
+        return;
+    }
+
+    if (parseEIT(section, &eit) != TABLES_PARSER_NO_ERROR)
+    {
+        return;
+    }
+
+    if (eventLoopPost(tableReceived, (uint8_t *)&eit, sizeof(eitTable)) != EVENT_LOOP_NO_ERROR)
+    {
+        sectionCacheInvalidate(cache, BENCHMARK_EIT_PID, section);
+        __atomic_fetch_add(&loopDropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/*Function for receiving table parsed by worker on event loop.*/
+static void tableReceived(uint8_t *data, uint16_t size)
+{
+    loopEvents++;
+    tablesParsed++;
+}
+
+/*Function for running flood through event loop only or through section workers, returns 0 on error.*/
+static uint8_t runCase(uint8_t useWorkers)
+{
+    sectionWorkersStatistics statistics;
+    pthread_t producer;
+
+    sectionCacheReset(&loopCache);
+    loopEvents = 0;
+    loopDropped = 0;
+    tablesParsed = 0;
+
+    if (eventLoopInit() != EVENT_LOOP_NO_ERROR)
+    {
+        return 0;
+    }
+    if (useWorkers && sectionWorkersInit(workerParse) != SECTION_WORKERS_NO_ERROR)
+    {
+        eventLoopDeinit();
+        return 0;
+    }
+
+    if (pthread_create(&producer, NULL, producerThread, &useWorkers))
+    {
+        if (useWorkers)
+        {
+            sectionWorkersDeinit();
+        }
+        eventLoopDeinit();
+        return 0;
+    }
+    eventLoopRun();
+    pthread_join(producer, NULL);
+
+    if (useWorkers)
+    {
+        sectionWorkersDeinit();
+        statistics = sectionWorkersGetStatistics();
+        printf("section workers: %6u loop events handled, %4u dropped, %4u tables reached loop, %u workers dropped %u sections\n",
+               loopEvents, loopDropped, tablesParsed, statistics.workerCount, statistics.dropped);
+    }
+    else
+    {
+        printf("event loop:      %6u loop events handled, %4u dropped, %4u tables reached loop\n", loopEvents, loopDropped,
+               tablesParsed);
+    }
+    eventLoopDeinit();
+
+    return 1;
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
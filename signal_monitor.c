@@ -0,0 +1,232 @@
+#include "signal_monitor.h"
+#include "tdp_api.h"
+#include "trace.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+/* helper keywords needed only for signal monitor module */
+#define SAMPLE_LOCKED 0x100   // sample is quality in low byte and lock state
+#define SAMPLE_RETUNING 0x200 // sample taken while tuner was being retuned on purpose
+#define SAMPLE_QUALITY_LEVELS 256
+
+/* helper variables needed only for signal monitor module */
+static uint16_t samples[SIGNAL_MONITOR_SAMPLES]; // written only by sampler thread
+static uint32_t sampleCount;                     // samples ever written, index of next one
+static uint8_t tunerLocked;
+static uint8_t tunerRetuning;
+static pthread_t samplerThreadHandle;
+static int32_t stopFileDesc = -1; // eventfd signalled to stop sampler thread
+
+/* helper functions needed only for signal monitor module */
+static void *samplerThread();
+static void takeSample();
+static uint8_t percentile(const uint32_t *histogram, uint32_t count, uint32_t percent);
+
+signalMonitorStatus signalMonitorInit()
+{
+    __atomic_store_n(&sampleCount, 0, __ATOMIC_RELEASE);
+
+    stopFileDesc = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stopFileDesc < 0)
+    {
+        printf("signalMonitorInit: eventfd fail\n");
+        return SIGNAL_MONITOR_ERROR;
+    }
+
+    /* SDK call may take a while on real tuner, it is made off event loop */
+    if (pthread_create(&samplerThreadHandle, NULL, samplerThread, NULL))
+    {
+        printf("signalMonitorInit: sampler thread fail\n");
+        close(stopFileDesc);
+        stopFileDesc = -1;
+        return SIGNAL_MONITOR_ERROR;
+    }
+
+    return SIGNAL_MONITOR_NO_ERROR;
+}
+
+signalMonitorStatus signalMonitorDeinit()
+{
+    uint64_t stop = 1;
+    signalStatistics statistics;
+
+    if (stopFileDesc < 0)
+    {
+        return SIGNAL_MONITOR_ERROR;
+    }
+
+    if (write(stopFileDesc, &stop, sizeof(stop)) < 0)
+    {
+        printf("signalMonitorDeinit: stopping sampler thread fail\n");
+    }
+    pthread_join(samplerThreadHandle, NULL);
+    close(stopFileDesc);
+    stopFileDesc = -1;
+
+    if (signalMonitorGetStatistics(SIGNAL_MONITOR_LONG_WINDOW_MS, &statistics) == SIGNAL_MONITOR_NO_ERROR)
+    {
+        traceStatistics("Signal quality: last %u samples, min %u, 5%% %u, median %u, mean %.1f, 95%% %u, max %u, "
+               "%u unlocked, %u lock losses\n",
+               statistics.sampleCount, statistics.minimum, statistics.percentile5, statistics.median, statistics.mean,
+               statistics.percentile95, statistics.maximum, statistics.unlockedCount, statistics.lockLossCount);
+    }
+
+    return SIGNAL_MONITOR_NO_ERROR;
+}
+
+void signalMonitorSetLocked(uint8_t locked)
+{
+    __atomic_store_n(&tunerLocked, locked, __ATOMIC_RELAXED);
+}
+
+void signalMonitorSetRetuning(uint8_t retuning)
+{
+    __atomic_store_n(&tunerRetuning, retuning, __ATOMIC_RELAXED);
+}
+
+signalMonitorStatus signalMonitorGetStatistics(uint32_t windowMs, signalStatistics *statistics)
+{
+    uint16_t window[SIGNAL_MONITOR_SAMPLES];
+    uint32_t histogram[SAMPLE_QUALITY_LEVELS];
+    uint32_t windowSamples = windowMs / SIGNAL_MONITOR_PERIOD_MS;
+    uint32_t head;
+    uint32_t newHead;
+    uint32_t first;
+    uint32_t count;
+    uint32_t total = 0;
+    uint32_t valid = 0; // index of oldest sample which was not overwritten
+    uint32_t i;
+    uint8_t quality;
+
+    /* writer may be storing sample at head, so one slot less than ring size can be read safely */
+    if (windowSamples >= SIGNAL_MONITOR_SAMPLES)
+    {
+        windowSamples = SIGNAL_MONITOR_SAMPLES - 1;
+    }
+
+    head = __atomic_load_n(&sampleCount, __ATOMIC_ACQUIRE);
+    count = head < windowSamples ? head : windowSamples;
+    first = head - count;
+    for (i = 0; i < count; i++)
+    {
+        window[i] = __atomic_load_n(&samples[(first + i) & (SIGNAL_MONITOR_SAMPLES - 1)], __ATOMIC_RELAXED);
+    }
+
+    /* samples overwritten while they were copied are dropped */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    newHead = __atomic_load_n(&sampleCount, __ATOMIC_RELAXED);
+    if (newHead - first >= SIGNAL_MONITOR_SAMPLES)
+    {
+        valid = newHead - first - SIGNAL_MONITOR_SAMPLES + 1;
+    }
+    if (valid >= count)
+    {
+        return SIGNAL_MONITOR_ERROR;
+    }
+
+    memset(statistics, 0, sizeof(signalStatistics));
+    memset(histogram, 0, sizeof(histogram));
+    statistics->minimum = 0xFF;
+    statistics->sampleCount = count - valid;
+    for (i = valid; i < count; i++)
+    {
+        quality = window[i] & 0xFF;
+        histogram[quality]++;
+        total += quality;
+        statistics->minimum = quality < statistics->minimum ? quality : statistics->minimum;
+        statistics->maximum = quality > statistics->maximum ? quality : statistics->maximum;
+
+        /* lock dropped by retune is not lost */
+        if (!(window[i] & (SAMPLE_LOCKED | SAMPLE_RETUNING)))
+        {
+            statistics->unlockedCount++;
+            statistics->lockLossCount += i > valid && (window[i - 1] & SAMPLE_LOCKED);
+        }
+    }
+
+    statistics->current = window[count - 1] & 0xFF;
+    statistics->locked = (window[count - 1] & SAMPLE_LOCKED) != 0;
+    statistics->mean = (float)total / statistics->sampleCount;
+    statistics->percentile5 = percentile(histogram, statistics->sampleCount, 5);
+    statistics->median = percentile(histogram, statistics->sampleCount, 50);
+    statistics->percentile95 = percentile(histogram, statistics->sampleCount, 95);
+
+    return SIGNAL_MONITOR_NO_ERROR;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function run by sampler thread, takes one sample per period until deinit.*/
+static void *samplerThread()
+{
+    struct pollfd descriptor;
+    int32_t result;
+
+    traceSetThreadName("signal monitor");
+
+    descriptor.fd = stopFileDesc;
+    descriptor.events = POLLIN;
+
+    while (1)
+    {
+        result = poll(&descriptor, 1, SIGNAL_MONITOR_PERIOD_MS);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result)
+        {
+            break;
+        }
+
+        takeSample();
+    }
+
+    return NULL;
+}
+
+/*Function for reading quality and storing it with lock state, sample is published after it is written.*/
+static void takeSample()
+{
+    t_Error result;
+    uint8_t quality = 0;
+    uint32_t index = sampleCount;
+
+    TRACE_CALL(result, "Tuner_Get_Signal_Quality", Tuner_Get_Signal_Quality(&quality));
+    if (result != NO_ERROR)
+    {
+        quality = 0;
+    }
+
+    __atomic_store_n(&samples[index & (SIGNAL_MONITOR_SAMPLES - 1)],
+                     quality | (__atomic_load_n(&tunerLocked, __ATOMIC_RELAXED) ? SAMPLE_LOCKED : 0) |
+                         (__atomic_load_n(&tunerRetuning, __ATOMIC_RELAXED) ? SAMPLE_RETUNING : 0),
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&sampleCount, index + 1, __ATOMIC_RELEASE);
+}
+
+/*Function for finding smallest quality which at least given percent of samples do not exceed (nearest rank).*/
+static uint8_t percentile(const uint32_t *histogram, uint32_t count, uint32_t percent)
+{
+    uint32_t rank = (count * percent + 99) / 100;
+    uint32_t seen = 0;
+    uint32_t quality;
+
+    rank = rank ? rank : 1;
+    for (quality = 0; quality < SAMPLE_QUALITY_LEVELS - 1; quality++)
+    {
+        seen += histogram[quality];
+        if (seen >= rank)
+        {
+            break;
+        }
+    }
+
+    return quality;
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
@@ -0,0 +1,65 @@
+#ifndef _SIGNAL_MONITOR_H_
+#define _SIGNAL_MONITOR_H_
+
+#include <stdint.h>
+
+#define SIGNAL_MONITOR_PERIOD_MS 100     // one sample of quality and lock state per period
+#define SIGNAL_MONITOR_SAMPLES 1024      // ring size, power of two, about 100 s of history
+#define SIGNAL_MONITOR_SHORT_WINDOW_MS 1000
+#define SIGNAL_MONITOR_LONG_WINDOW_MS 60000
+
+typedef enum _signalMonitorStatus
+{
+    SIGNAL_MONITOR_NO_ERROR = 0,
+    SIGNAL_MONITOR_ERROR
+} signalMonitorStatus;
+
+/* statistics of samples in window, quality is as reported by Tuner_Get_Signal_Quality */
+typedef struct _signalStatistics
+{
+    uint32_t sampleCount;   // less than window holds until enough time passed since init
+    uint32_t unlockedCount; // samples taken while tuner was not locked, retune excluded
+    uint32_t lockLossCount; // locked sample followed by unlocked one, retune excluded
+    uint8_t current;        // newest sample
+    uint8_t locked;         // lock state of newest sample
+    uint8_t minimum;
+    uint8_t percentile5;
+    uint8_t median;
+    uint8_t percentile95;
+    uint8_t maximum;
+    float mean;
+} signalStatistics;
+
+/****************************************************************************
+ * @brief    Function for starting background sampler thread. Tuner has to be
+ *           initialized. Samples are written into fixed size ring, old ones
+ *           are overwritten.
+ *
+ * @return   SIGNAL_MONITOR_NO_ERROR, if there are no errors.
+ *           SIGNAL_MONITOR_ERROR, in case of an error.
+****************************************************************************/
+signalMonitorStatus signalMonitorInit();
+
+/*Function for stopping sampler thread and printing statistics of long window.*/
+signalMonitorStatus signalMonitorDeinit();
+
+/*Function for reporting tuner lock state, can be called from any thread.*/
+void signalMonitorSetLocked(uint8_t locked);
+
+/*Function for marking samples taken while tuner is retuned on purpose, they do not count as unlocked. Can be called from any thread.*/
+void signalMonitorSetRetuning(uint8_t retuning);
+
+/****************************************************************************
+ * @brief    Function for computing statistics of newest samples. Can be
+ *           called from any thread, sampler is never blocked: samples are
+ *           copied without lock and those overwritten meanwhile are dropped.
+ *
+ * @param    windowMs - [in] Window length, at most SIGNAL_MONITOR_SAMPLES periods.
+ *           statistics - [out] Statistics of samples in window.
+ *
+ * @return   SIGNAL_MONITOR_NO_ERROR, if window holds at least one sample.
+ *           SIGNAL_MONITOR_ERROR, if there are no samples yet.
+****************************************************************************/
+signalMonitorStatus signalMonitorGetStatistics(uint32_t windowMs, signalStatistics *statistics);
+
+#endif // _SIGNAL_MONITOR_H_
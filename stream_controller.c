@@ -1,88 +1,278 @@
 #include "stream_controller.h"
 
 #include "tables_parser.h"
+#include "section_cache.h"
+#include "section_assembler.h"
+#include "channel_database.h"
+#include "trace.h"
 #include "graphics_controller.h"
+#include "timer_controller.h"
+#include "event_loop.h"
+#include "volume_controller.h"
+#include "signal_monitor.h"
+#include "section_workers.h"
 
 #include <stdlib.h>
 #include <limits.h>
 #include <pthread.h>
+#include <time.h>
 #include <sys/time.h>
 #include "errno.h"
 
 /* helper keywords needed only for stream controller module */
 #define PAT_ID 0x00
 #define PAT_PID 0x00
+#define PAT_SECTION_MAX_SIZE 1024
+#define PSI_SECTION_HEADER_SIZE 3 // table id and section length, not counted in section length
 
 #define PMT_ID 0x02
 
 #define EIT_ID 0x4E
 #define EIT_PID 0x0012
-
-#define VOLUME_MAX INT_MAX
-#define VOLUME_MIN 0
-#define VOLUME_STEP 0.05 // increase volume by 5%
+#define EIT_PRESENT_SECTION 0
+#define EIT_FOLLOWING_SECTION 1
 
 #define CHANNEL_RUNNING_STATUS 4
 
+#define TUNER_LOCK_TIMEOUT 10 // seconds
+#define PAT_TIMEOUT 3         // seconds
+#define PMT_TIMEOUT 3         // seconds, all PMT filters are armed at once and share this deadline
+#define ZAP_SETTLE_MS 150         // channel keys closer than this are merged into one zap
+#define BLIND_SCAN_POLL_MS 10     // signal quality poll period while blind scan waits for lock
+#define BLIND_SCAN_SIGNAL_MS 30   // frequency without signal after this time is empty
+#define BLIND_SCAN_LOCK_MS 1000   // frequency with signal which did not lock in this time is skipped
+#define BLIND_SCAN_MIN_QUALITY 10 // signal quality below this counts as no signal
+#define CHANNEL_DATABASE_MAX_AGE_S (7 * 24 * 3600) // older database is rescanned on all transponders
+
+/* one-shot event signalled from SDK callback thread and waited on during init, before event loop runs */
+typedef struct _completion
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    uint8_t done;
+} completion;
+
+/* player stream currently decoded, kept across zaps while PID and type stay the same */
+typedef struct _playerStream
+{
+    uint32_t handle;
+    uint32_t pid;
+    tStreamType type;
+} playerStream;
+
+/* zap latency measured from key press to new streams created */
+typedef struct _zapStatistics
+{
+    uint32_t count;
+    uint64_t totalUs;
+    uint64_t minUs;
+    uint64_t maxUs;
+} zapStatistics;
+
+/* channel scan runs on event loop, it is advanced by tuner lock, received sections and scan timer */
+typedef enum _scanState
+{
+    SCAN_IDLE = 0,
+    SCAN_LOCK,   // waiting for lock to next transponder
+    SCAN_PAT,
+    SCAN_PMT,
+    SCAN_RETURN, // all transponders scanned, tuner goes back to transponder of scan start
+    SCAN_DONE
+} scanState;
+
+/* one tuner lock request at a time, lock is waited for on event loop */
+typedef enum _lockReason
+{
+    LOCK_NONE = 0,
+    LOCK_RETUNE,
+    LOCK_SCAN,
+    LOCK_ZAP
+} lockReason;
+
+/* zap runs on event loop in steps, so channel keys pressed meanwhile can cancel it */
+typedef enum _zapState
+{
+    ZAP_IDLE = 0,
+    ZAP_SETTLING, // waiting for user to stop pressing channel keys
+    ZAP_LOCK,     // target is on another transponder, waiting for lock
+    ZAP_SCAN,     // target is on another transponder, waiting for scan to release tuner
+    ZAP_AUDIO     // video stream of target is switched, audio is next
+} zapState;
+
+/* state of one PMT acquisition */
+typedef struct _pmtRequest
+{
+    uint16_t programNumber;
+    uint16_t programMapPid;
+    uint32_t filterHandle;
+    uint8_t *section; // copy of received PMT, parsed once tuner moved on to next transponder
+} pmtRequest;
+
 /* helper variables needed only for stream controller module */
 static uint32_t playerHandle;
 static uint32_t sourceHandle;
-static uint32_t filterHandle;
-static uint32_t videoHandle;
-static uint32_t audioHandle;
-
-static pthread_cond_t statusCondition = PTHREAD_COND_INITIALIZER;
-static pthread_mutex_t statusMutex = PTHREAD_MUTEX_INITIALIZER;
-
-static patTable *pat;
+static uint32_t patFilterHandle;
+static uint32_t eitFilterHandle;
+static playerStream videoStream;
+static playerStream audioStream;
+
+static completion tunerLocked;
+static sectionCache siCache;
+
+static uint8_t patSection[PAT_SECTION_MAX_SIZE]; // PAT is kept as received, pat view points into it
+static patView pat;
+static pmtRequest *pmtRequests;
+static uint16_t pmtRequestCount;
+static uint16_t pmtReceivedCount;
+static uint16_t pmtFailedCount; // PMT requests whose filter could not be set, they are not waited for
+static scanState scanPhase;
+static timerHandle scanTimer;
+static struct timespec scanStart;
+static uint16_t scanTransportStreamId; // of PAT of transponder being scanned
+static uint8_t scanPatVersion;
+static Channels scannedChannels;      // merged list of transponders scanned so far
+static uint32_t scannedCapacity;
+static transponderInit *scanList;     // transponders of configuration, first one is home transponder
+static uint32_t scanListCount;
+static uint32_t scanListCrc;          // identifies scan list in channel database
+static uint8_t scanHomeOnly;          // only home transponder is scanned to check stored channel list
+static uint32_t scanIndex;
+static uint32_t scanLockedCount;
+static uint8_t scanBlind;             // scan list is blind scan band, frequencies without signal are skipped
+static timerHandle probeTimer;
+static transponderInit scanHome;      // tuner returns here when scan is done
+static struct timespec muxLockStart;
+static struct timespec muxPsiStart;
+static uint8_t loopDropReported; // section lost to full event loop queue was printed since scan start
 static Channels channels;
-static uint16_t channelCounter;
+static transponderInit tunedTransponder; // transponder tuner is locked or locking to
+static lockReason lockPending;
+static uint32_t lockSequence; // lock request number, lock status is posted with number it arrived for
+static timerHandle lockTimer;
 static uint16_t currentChannel;
-static uint32_t currentVolume;
-static uint8_t volumeMuted;
+static uint8_t zapPending; // channel key was pressed, latency is counted once its zap reaches decoders
+static struct timespec zapStart;
+static zapStatistics zapLatency;
+static zapState zapPhase;
+static timerHandle zapTimer;
+static uint32_t zapRequests;  // channel changes requested by user
+static uint32_t zapsStarted;  // channel changes which left settling, for lock, scan or decoders
+static uint32_t zapsCancelled; // started zaps abandoned because target changed
+static startingChannelInit retuneChannel;
 
 /* helper functions needed only for stream controller module */
-static streamControllerStatus setFilterAndRegister(uint32_t tableId, uint32_t tablePid);
-static streamControllerStatus freeFilter(int32_t (*callback)(uint8_t *buffer));
-static void pmtSaveChannel(pmtTable *pmt);
-static streamControllerStatus streamTypeDVBtoTDP(uint32_t dvbStreamType);
-static streamControllerStatus timedWaitForCondition(uint8_t seconds);
-static streamControllerStatus threadMutexUnlock();
+static streamControllerStatus setFilter(uint32_t tableId, uint32_t tablePid, uint32_t *filterHandle);
+static streamControllerStatus freeFilter(uint32_t *filterHandle);
+static void pmtSaveChannel(channelData *channel, pmtView *pmt);
+static void eitSaveShow(channelData *channel, eitTable *eit);
+static void replaceString(char **destination, const char *source);
+static void freeChannels(Channels *list);
+static uint8_t homeChannelsChanged(Channels *stored, Channels *scanned);
+static uint8_t channelsStale(Channels *stored);
+static streamControllerStatus streamTypeDVBtoTDP(uint8_t streamType, uint8_t ac3Descriptor);
+static streamControllerStatus updateStream(playerStream *stream, uint32_t pid, tStreamType type);
+static streamControllerStatus removeStream(playerStream *stream);
+static void zapFinished();
+static void zapCancel();
+static streamControllerStatus zapSchedule(uint16_t channelIndex, uint32_t settleMs);
+static void zapSettled();
+static void zapAudio(uint8_t *data, uint16_t size);
+static streamControllerStatus lockTransponder(transponderInit *transponder, lockReason reason);
+static void lockFinished(uint8_t locked);
+static void lockTimeout();
+static void signalProbe();
+static uint8_t sameTransponder(transponderInit *first, transponderInit *second);
+static streamControllerStatus setScanList(initialConfig *config);
+static void scanMuxStart();
+static uint32_t scanNextIndex(uint32_t index, uint8_t locked);
+static void scanLocked();
+static void scanPmtStart();
+static void scanMuxCaptured();
+static void scanMuxStore(pmtRequest *requests, uint16_t requestCount, uint16_t transportStreamId, transponderInit *transponder);
+static channelData *scanAppendChannel();
+static void scanHomeChecked(uint32_t next);
+static void scanFinish();
+static void scanDone();
+static void scanTimeout();
+static streamControllerStatus scanStop();
+static void freePmtRequests(pmtRequest *requests, uint16_t requestCount);
+static void tuneFinished();
+static long elapsedMs(struct timespec *start);
+static void completionInit(completion *event);
+static void completionDeinit(completion *event);
+static void completionSignal(completion *event);
+static streamControllerStatus completionWait(completion *event, struct timespec *deadline);
+static void deadlineAfter(struct timespec *deadline, uint8_t seconds);
+static void loopDropReport(const char *function, uint8_t tableId);
 
 /* callback functions needed only for stream controller module */
 static int32_t tunerStatusCallback(t_LockStatus status);
-static int32_t patCallback(uint8_t *buffer);
-static int32_t pmtCallback(uint8_t *buffer);
+static int32_t sectionCallback(uint8_t *buffer);
+
+/* section parsers needed only for stream controller module, called on section worker threads */
+static void eitParse(uint8_t *section, uint16_t size, sectionCache *cache);
+
+/* section handlers needed only for stream controller module, called on event loop thread */
+static void tunerLockReceived(uint8_t *data, uint16_t size);
+static void tunerLockFailed(uint8_t *data, uint16_t size);
+static void sectionReceived(uint8_t *section, uint16_t size);
+static streamControllerStatus patReceived(uint8_t *buffer, uint16_t sectionSize);
+static streamControllerStatus pmtReceived(uint8_t *buffer);
+static void eitReceived(uint8_t *data, uint16_t size);
 streamControllerStatus streamControllerInit(initialConfig *config)
 {
     uint8_t result;
+    struct timespec deadline;
+
+    completionInit(&tunerLocked);
+    tunedTransponder = config->transponder;
+
+    /* scan goes through all transponders of configuration */
+    result = setScanList(config);
+    ASSERT_TDP_RESULT(result, "streamControllerInit: setScanList");
+
+    /* channel list of previous run is loaded before tuner lock is waited for, so it is available right away */
+    if (channelDatabaseLoad(CHANNEL_DATABASE_FILE, scanList[0].frequency, &channels) == CHANNEL_DATABASE_NO_ERROR)
+    {
+        printf("streamControllerInit: %u channels loaded from %s\n", channels.channelCount, CHANNEL_DATABASE_FILE);
+    }
 
     /* Initialize tuner */
-    result = Tuner_Init();
+    TRACE_CALL(result, "Tuner_Init", Tuner_Init());
     ASSERT_TDP_RESULT(result, "streamControllerInit: Tuner_Init");
 
     /* Register tuner status callback */
-    result = Tuner_Register_Status_Callback(tunerStatusCallback);
+    TRACE_CALL(result, "Tuner_Register_Status_Callback", Tuner_Register_Status_Callback(tunerStatusCallback));
     ASSERT_TDP_RESULT(result, "streamControllerInit: Tuner_Register_Status_Callback");
 
-    /* Lock to frequency */
-    result = Tuner_Lock_To_Frequency(config->transponder.frequency * 1000000, config->transponder.bandwidth, config->transponder.module);
+    /* Lock to frequency, monitor counts samples until lock state is known as retune */
+    signalMonitorSetRetuning(1);
+    TRACE_CALL(result, "Tuner_Lock_To_Frequency", Tuner_Lock_To_Frequency(config->transponder.frequency * 1000000, config->transponder.bandwidth, config->transponder.module));
     ASSERT_TDP_RESULT(result, "streamControllerInit: Tuner_Lock_To_Frequency");
 
-    /* set 10 second mutex lock until tunex is locked to frequency */
-    timedWaitForCondition(10);
+    /* wait until tuner is locked to frequency */
+    deadlineAfter(&deadline, TUNER_LOCK_TIMEOUT);
+    completionWait(&tunerLocked, &deadline);
+
+    /* quality and lock state are sampled in background from now on */
+    result = signalMonitorInit();
+    ASSERT_TDP_RESULT(result, "streamControllerInit: signalMonitorInit");
+
+    /* EIT sections are parsed on worker threads, neither SDK thread nor event loop waits for parsing */
+    result = sectionWorkersInit(eitParse);
+    ASSERT_TDP_RESULT(result, "streamControllerInit: sectionWorkersInit");
 
     /* Initialize player (demux is a part of player) */
-    result = Player_Init(&playerHandle);
+    TRACE_CALL(result, "Player_Init", Player_Init(&playerHandle));
     ASSERT_TDP_RESULT(result, "streamControllerInit: Player_Init");
 
     /* Open source (open data flow between tuner and demux) */
-    result = Player_Source_Open(playerHandle, &sourceHandle);
+    TRACE_CALL(result, "Player_Source_Open", Player_Source_Open(playerHandle, &sourceHandle));
     ASSERT_TDP_RESULT(result, "streamControllerInit: Player_Source_Open");
 
-    /* Get initial volume */
-    result = Player_Volume_Get(playerHandle, &currentVolume);
-    ASSERT_TDP_RESULT(result, "streamControllerInit: Player_Volume_Get");
+    /* Get initial volume, later it is only written */
+    result = volumeControllerInit(playerHandle);
+    ASSERT_TDP_RESULT(result, "streamControllerInit: volumeControllerInit");
 
     return STREAM_CONTROLLER_NO_ERROR;
 }
@@ -91,26 +281,61 @@ streamControllerStatus streamControllerDeinit()
 {
     uint8_t result;
 
+    /* zap still settling or running and work waiting for tuner lock are dropped */
+    zapCancel();
+    timerStopAndDelete(&lockTimer);
+    timerStopAndDelete(&probeTimer);
+    lockPending = LOCK_NONE;
+
     stopPlayerStream();
 
+    /* Stop scan if still running (partial channel list is dropped) and EIT acquisition */
+    scanStop();
+
+    /* section callback is unregistered by now, nothing is posted to workers any more */
+    sectionWorkersDeinit();
+
+    /* volume change still waiting for its frame is written while player exists */
+    volumeControllerDeinit();
+
     /* Close previously opened source */
-    result = Player_Source_Close(playerHandle, sourceHandle);
+    TRACE_CALL(result, "Player_Source_Close", Player_Source_Close(playerHandle, sourceHandle));
     ASSERT_TDP_RESULT(result, "streamControllerDeinit: Player_Source_Close");
 
     /* Deinit player */
-    result = Player_Deinit(playerHandle);
+    TRACE_CALL(result, "Player_Deinit", Player_Deinit(playerHandle));
     ASSERT_TDP_RESULT(result, "streamControllerDeinit: Player_Deinit");
 
+    /* sampler reads tuner, it is stopped first */
+    signalMonitorDeinit();
+
     /* Deinit tuner */
-    result = Tuner_Deinit();
+    TRACE_CALL(result, "Tuner_Deinit", Tuner_Deinit());
     ASSERT_TDP_RESULT(result, "streamControllerDeinit: Tuner_Deinit");
 
+    /* tuner status callback signals it until tuner is deinitialized */
+    completionDeinit(&tunerLocked);
+
     /* Free channels memory */
-    free((channels.channel)->subtitles);
-    free(channels.channel);
+    freeChannels(&channels);
+    free(scanList);
+    scanList = NULL;
+    scanListCount = 0;
+
+    traceStatistics("Zaps: %u requested, %u started, %u cancelled\n", zapRequests, zapsStarted, zapsCancelled);
+    if (zapLatency.count)
+    {
+        traceStatistics("Zap latency: %u zaps, min %.1f ms, avg %.1f ms, max %.1f ms\n", zapLatency.count, zapLatency.minUs / 1000.0,
+                        zapLatency.totalUs / 1000.0 / zapLatency.count, zapLatency.maxUs / 1000.0);
+    }
+
+    sectionCacheStatistics statistics = sectionCacheGetStatistics(&siCache);
+    traceStatistics("SI section cache: %u hits, %u misses, %u evictions\n", statistics.hits, statistics.misses, statistics.evictions);
 
-    (channels.channel)->subtitles = NULL;
-    channels.channel = NULL;
+    sectionWorkersStatistics workerStatistics = sectionWorkersGetStatistics();
+    traceStatistics("Section workers: %u workers, %u sections posted, %u dropped, cache %u hits, %u misses, %u evictions\n",
+                    workerStatistics.workerCount, workerStatistics.posted, workerStatistics.dropped, workerStatistics.cache.hits,
+                    workerStatistics.cache.misses, workerStatistics.cache.evictions);
 
     return STREAM_CONTROLLER_NO_ERROR;
 }
@@ -118,26 +343,16 @@ streamControllerStatus streamControllerDeinit()
 streamControllerStatus startPlayerStream(startingChannelInit *channel)
 {
     uint8_t result;
+    uint64_t traceStart = traceBegin();
 
-    stopPlayerStream();
-
-    if (channel->videoPID != CONFIGURATION_PARSER_NOT_SET && channel->videoType != CONFIGURATION_PARSER_NOT_SET)
-    {
-        result = Player_Stream_Create(playerHandle, sourceHandle, channel->videoPID, channel->videoType, &videoHandle);
-        ASSERT_TDP_RESULT(result, "startPlayerStream: Video Player_Stream_Create");
-    }
+    /* volume is a player setting and survives stream recreation, so it is not set again on zap */
+    result = updateStream(&videoStream, channel->videoPID, channel->videoType);
+    ASSERT_TDP_RESULT(result, "startPlayerStream: video stream");
 
-    if (channel->audioPID != CONFIGURATION_PARSER_NOT_SET && channel->audioType != CONFIGURATION_PARSER_NOT_SET)
-    {
-        result = Player_Stream_Create(playerHandle, sourceHandle, channel->audioPID, channel->audioType, &audioHandle);
-        ASSERT_TDP_RESULT(result, "startPlayerStream: Audio Player_Stream_Create");
-    }
+    result = updateStream(&audioStream, channel->audioPID, channel->audioType);
+    ASSERT_TDP_RESULT(result, "startPlayerStream: audio stream");
 
-    if (!volumeMuted)
-    {
-        result = Player_Volume_Set(playerHandle, currentVolume);
-        ASSERT_TDP_RESULT(result, "startPlayerStream: Player_Volume_Set");
-    }
+    traceEnd("startPlayerStream", traceStart);
 
     return STREAM_CONTROLLER_NO_ERROR;
 }
@@ -146,218 +361,150 @@ streamControllerStatus stopPlayerStream()
 {
     uint8_t result;
 
-    if (videoHandle)
-    {
-        result = Player_Stream_Remove(playerHandle, sourceHandle, videoHandle);
-        ASSERT_TDP_RESULT(result, "stopPlayerStream: Video Player_Stream_Remove");
-        videoHandle = 0;
-    }
+    result = removeStream(&videoStream);
+    ASSERT_TDP_RESULT(result, "stopPlayerStream: Video Player_Stream_Remove");
 
-    if (audioHandle)
-    {
-        result = Player_Stream_Remove(playerHandle, sourceHandle, audioHandle);
-        ASSERT_TDP_RESULT(result, "stopPlayerStream: Audio Player_Stream_Remove");
-        audioHandle = 0;
-    }
+    result = removeStream(&audioStream);
+    ASSERT_TDP_RESULT(result, "stopPlayerStream: Audio Player_Stream_Remove");
 
     return STREAM_CONTROLLER_NO_ERROR;
 }
 
-void *channelsSetup()
+void zapKeyPressed(const struct timeval *keyPressTime)
 {
-    uint8_t result;
-
-    /* PMT table parsing setup */
-    result = setFilterAndRegister(PAT_ID, PAT_PID);
-    /* Wait for PAT table */
-    timedWaitForCondition(3);
-
-    channels.channelCount = pat->programCount;
-    channels.channel = (channelData *)malloc(channels.channelCount * sizeof(channelData));
-
-    int32_t i;
-    /* PMT table parsing setup */
-    for (i = 0; i < pat->sectionCount; i++)
+    if (keyPressTime)
     {
-        if (pat->programInformation[i].programNumber)
-        {
-            result = setFilterAndRegister(PMT_ID, pat->programInformation[i].programMapPid);
-            /* Wait for PMT table */
-            timedWaitForCondition(3);
-        }
+        zapStart.tv_sec = keyPressTime->tv_sec;
+        zapStart.tv_nsec = keyPressTime->tv_usec * 1000;
+    }
+    else
+    {
+        clock_gettime(CLOCK_MONOTONIC, &zapStart);
     }
 
-    free(pat->programInformation);
-    free(pat);
-
-    pat->programInformation = NULL;
-    pat = NULL;
-    return (void *)STREAM_CONTROLLER_NO_ERROR;
+    zapPending = 1;
 }
 
-streamControllerStatus playChannel(uint16_t channelNumber)
+streamControllerStatus channelsSetup()
 {
-    int8_t result;
+    uint8_t result;
 
-    if (channelNumber > channels.channelCount || channelNumber < 1)
+    clock_gettime(CLOCK_MONOTONIC, &scanStart);
+    __atomic_store_n(&loopDropReported, 0, __ATOMIC_RELAXED);
+
+    /* one callback serves PAT, PMT and EIT filters, sections are handed over to event loop */
+    TRACE_CALL(result, "Demux_Register_Section_Filter_Callback", Demux_Register_Section_Filter_Callback(sectionCallback));
+    if (result)
     {
-        showChannelNumberMessage(channelNumber);
+        printf("channelsSetup: Demux_Register_Section_Filter_Callback fail\n");
         return STREAM_CONTROLLER_ERROR;
     }
 
-    currentChannel = channelNumber - 1;
-    result = startPlayerStream(&channels.channel[currentChannel].channelInit);
-    ASSERT_TDP_RESULT(result, "playChannel: startPlayerStream");
+    /* transponders are scanned one after another, scan continues in scanLocked, patReceived or scanTimeout */
+    memset(&scannedChannels, 0, sizeof(Channels));
+    scannedCapacity = 0;
+    scanIndex = 0;
+    scanLockedCount = 0;
+    scanHome = tunedTransponder;
 
-    showChannelInfo();
+    /* fresh stored list is checked on home transponder without retune, live service is not interrupted */
+    scanHomeOnly = !channelsStale(&channels) && sameTransponder(&scanList[0], &tunedTransponder);
+    if (scanHomeOnly)
+    {
+        printf("channelsSetup: checking %u stored channels on home transponder\n", channels.channelCount);
+    }
+    scanMuxStart();
 
     return STREAM_CONTROLLER_NO_ERROR;
 }
 
-streamControllerStatus playNextChannel()
+uint8_t channelsSetupRunning()
 {
-    uint8_t result;
-
-    if (currentChannel == channels.channelCount - 1)
-    {
-        currentChannel = 0;
-    }
-    else
-    {
-        currentChannel++;
-    }
-
-    result = startPlayerStream(&channels.channel[currentChannel].channelInit);
-    ASSERT_TDP_RESULT(result, "playNextChannel: startPlayerStream");
-
-    showChannelInfo();
-
-    return STREAM_CONTROLLER_NO_ERROR;
+    return scanPhase != SCAN_IDLE && scanPhase != SCAN_DONE;
 }
 
-streamControllerStatus playPreviousChannel()
+streamControllerStatus tuneTransponder(initialConfig *config)
 {
-    uint8_t result;
+    /* zap, scan and EIT acquisition of old transponder are dropped, its streams cannot be decoded any more */
+    zapCancel();
+    scanStop();
+    stopPlayerStream();
 
-    if (currentChannel == 0)
+    if (setScanList(config) != STREAM_CONTROLLER_NO_ERROR)
     {
-        currentChannel = channels.channelCount - 1;
+        return STREAM_CONTROLLER_ERROR;
     }
-    else
+
+    freeChannels(&channels);
+    currentChannel = 0;
+    if (channelDatabaseLoad(CHANNEL_DATABASE_FILE, scanList[0].frequency, &channels) == CHANNEL_DATABASE_NO_ERROR)
     {
-        currentChannel--;
+        printf("tuneTransponder: %u channels loaded from %s\n", channels.channelCount, CHANNEL_DATABASE_FILE);
     }
 
-    result = startPlayerStream(&channels.channel[currentChannel].channelInit);
-    ASSERT_TDP_RESULT(result, "playPreviousChannel: startPlayerStream");
-
-    showChannelInfo();
-
-    return STREAM_CONTROLLER_NO_ERROR;
+    /* tuneFinished starts streams and scan once tuner is locked */
+    retuneChannel = config->startingChannel;
+    return lockTransponder(&config->transponder, LOCK_RETUNE);
 }
 
-streamControllerStatus volumeMute()
+streamControllerStatus playChannel(uint16_t channelNumber)
 {
-    uint8_t result;
-
-    if (volumeMuted)
-    {
-        result = Player_Volume_Set(playerHandle, currentVolume);
-        ASSERT_TDP_RESULT(result, "volumeMute: Player_Volume_Set");
-    }
-    else
+    if (channelNumber > channels.channelCount || channelNumber < 1)
     {
-        result = Player_Volume_Set(playerHandle, VOLUME_MIN);
-        ASSERT_TDP_RESULT(result, "volumeMute: Player_Volume_Set");
+        showChannelNumberMessage(channelNumber);
+        return STREAM_CONTROLLER_ERROR;
     }
 
-    volumeMuted = !volumeMuted;
-
-    showVolumeInfo();
-    return STREAM_CONTROLLER_NO_ERROR;
+    /* number was already typed and waited for, so zap is not delayed */
+    return zapSchedule(channelNumber - 1, 0);
 }
 
-streamControllerStatus volumeUp()
+streamControllerStatus playNextChannel()
 {
-    uint8_t result;
-
-    if (!volumeMuted)
+    if (!channels.channelCount)
     {
-        result = Player_Volume_Get(playerHandle, &currentVolume);
-        ASSERT_TDP_RESULT(result, "volumeUp: Player_Volume_Get");
-
-        currentVolume += VOLUME_MAX * VOLUME_STEP;
-        if (currentVolume >= VOLUME_MAX)
-        {
-            currentVolume = VOLUME_MAX;
-        }
+        zapCancel();
+        return STREAM_CONTROLLER_ERROR;
     }
 
-    volumeMuted = 0;
-    result = Player_Volume_Set(playerHandle, currentVolume);
-    ASSERT_TDP_RESULT(result, "volumeUp: Player_Volume_Set");
-
-    showVolumeInfo();
-    return STREAM_CONTROLLER_NO_ERROR;
+    return zapSchedule(currentChannel == channels.channelCount - 1 ? 0 : currentChannel + 1, ZAP_SETTLE_MS);
 }
 
-streamControllerStatus volumeDown()
+streamControllerStatus playPreviousChannel()
 {
-    uint8_t result;
-
-    if (!volumeMuted)
+    if (!channels.channelCount)
     {
-        result = Player_Volume_Get(playerHandle, &currentVolume);
-        ASSERT_TDP_RESULT(result, "volumeDown: Player_Volume_Get");
-
-        currentVolume -= VOLUME_MAX * VOLUME_STEP;
-
-        if (currentVolume <= VOLUME_MIN)
-        {
-            currentVolume = VOLUME_MIN;
-        }
+        zapCancel();
+        return STREAM_CONTROLLER_ERROR;
     }
 
-    volumeMuted = 0;
-    result = Player_Volume_Set(playerHandle, currentVolume);
-    ASSERT_TDP_RESULT(result, "volumeDown: Player_Volume_Set");
-
-    showVolumeInfo();
-    return STREAM_CONTROLLER_NO_ERROR;
+    return zapSchedule(currentChannel == 0 ? channels.channelCount - 1 : currentChannel - 1, ZAP_SETTLE_MS);
 }
 
 streamControllerStatus showChannelInfo()
 {
-    uint8_t result;
-
-    result = drawChannelInfo(currentChannel + 1, channels.channel[currentChannel].subtitleCount, channels.channel[currentChannel].subtitles);
-    ASSERT_TDP_RESULT(result, "showChannelInfo: drawChannelInfo");
-
-    drawOnScreen();
-
-    return STREAM_CONTROLLER_NO_ERROR;
-}
-
-streamControllerStatus showVolumeInfo()
-{
-    uint8_t result;
-
-    float volumePercent;
+    uint8_t result = GRAPHICS_CONTROLLER_ERROR;
+    uint8_t signalQuality = SIGNAL_QUALITY_UNKNOWN;
+    signalStatistics signal;
 
-    if (volumeMuted)
-        volumePercent = 0.0;
-    else
-        volumePercent = (float)currentVolume / VOLUME_MAX;
+    /* banner shows newest sample, it is not worth blocking on tuner call */
+    if (signalMonitorGetStatistics(SIGNAL_MONITOR_PERIOD_MS, &signal) == SIGNAL_MONITOR_NO_ERROR)
+    {
+        signalQuality = signal.current;
+    }
 
-    result = drawVolumeInfo(volumePercent);
-    ASSERT_TDP_RESULT(result, "showVolumeInfo: drawVolumeInfo");
+    if (currentChannel < channels.channelCount)
+    {
+        result = drawChannelInfo(currentChannel + 1, channels.channel[currentChannel].subtitleCount, channels.channel[currentChannel].subtitles,
+                                 signalQuality);
+    }
+    ASSERT_TDP_RESULT(result, "showChannelInfo: drawChannelInfo");
 
     drawOnScreen();
 
     return STREAM_CONTROLLER_NO_ERROR;
 }
 
-
 streamControllerStatus showChannelNumber(uint16_t channelNumberValue)
 {
     uint8_t result;
@@ -372,10 +519,6 @@ streamControllerStatus showChannelNumber(uint16_t channelNumberValue)
 
 streamControllerStatus showChannelNumberMessage(uint16_t channelNumberValue)
 {
-    clearScreen(COLOUR_BLACK);
-    drawOnScreen();
-    clearScreen(COLOUR_BLACK);
-
     uint8_t result;
 
     result = drawChannelNumberMessage(channelNumberValue);
@@ -387,208 +530,1400 @@ streamControllerStatus showChannelNumberMessage(uint16_t channelNumberValue)
 }
 
 /* -------------------- HELPER FUNCTIONS -------------------- */
-/*Function for setting demux filter and registering corresponding callback.*/
-static streamControllerStatus setFilterAndRegister(uint32_t tableId, uint32_t tablePid)
+/*Function for setting demux filter.*/
+static streamControllerStatus setFilter(uint32_t tableId, uint32_t tablePid, uint32_t *filterHandle)
 {
     uint8_t result;
-    if (filterHandle)
-    {
-        ASSERT_TDP_RESULT(STREAM_CONTROLLER_ERROR, "setFilterAndRegister: Filter already set.");
-    }
 
     /* Set filter to demux */
-    result = Demux_Set_Filter(playerHandle, tablePid, tableId, &filterHandle);
-    ASSERT_TDP_RESULT(result, "setFilterAndRegister: Demux_Set_Filter");
-
-    /* Register section filter callback */
-    switch (tableId)
-    {
-    case PAT_ID:
-        result = Demux_Register_Section_Filter_Callback(patCallback);
-        break;
-
-    case PMT_ID:
-        result = Demux_Register_Section_Filter_Callback(pmtCallback);
-        break;
-    }
-    ASSERT_TDP_RESULT(result, "setFilterAndRegister: Demux_Register_Section_Filter_Callback");
+    TRACE_CALL(result, "Demux_Set_Filter", Demux_Set_Filter(playerHandle, tablePid, tableId, filterHandle));
+    ASSERT_TDP_RESULT(result, "setFilter: Demux_Set_Filter");
 
     return STREAM_CONTROLLER_NO_ERROR;
 }
 
-/*Function for freeing demux filter and unregistering corresponding callback.*/
-static streamControllerStatus freeFilter(int32_t (*callback)(uint8_t *buffer))
+/*Function for freeing demux filter.*/
+static streamControllerStatus freeFilter(uint32_t *filterHandle)
 {
     uint8_t result;
 
+    if (!*filterHandle)
+    {
+        return STREAM_CONTROLLER_NO_ERROR;
+    }
+
     /* Free demux filter */
-    result = Demux_Free_Filter(playerHandle, filterHandle);
+    TRACE_CALL(result, "Demux_Free_Filter", Demux_Free_Filter(playerHandle, *filterHandle));
     ASSERT_TDP_RESULT(result, "freeFilter: Demux_Free_Filter");
-    filterHandle = 0;
-
-    /* Unregister callback */
-    result = Demux_Unregister_Section_Filter_Callback(callback);
-    ASSERT_TDP_RESULT(result, "freeFilter: Demux_Unregister_Section_Filter_Callback");
+    *filterHandle = 0;
 
     return STREAM_CONTROLLER_NO_ERROR;
 }
 
-/*Function for saving channel read from PMT table.*/
-static void pmtSaveChannel(pmtTable *pmt)
+/*Function for saving channel read from PMT table, streams and their descriptors are walked once directly in section buffer.*/
+static void pmtSaveChannel(channelData *channel, pmtView *pmt)
 {
     int32_t streamType;
-
-    channels.channel[channelCounter].pmtProgramNumber = pmt->pmtHeader.programNumber;
-
-    channels.channel[channelCounter].channelInit.audioType = CONFIGURATION_PARSER_NOT_SET;
-    channels.channel[channelCounter].channelInit.videoType = CONFIGURATION_PARSER_NOT_SET;
-    channels.channel[channelCounter].channelInit.audioPID = CONFIGURATION_PARSER_NOT_SET;
-    channels.channel[channelCounter].channelInit.videoPID = CONFIGURATION_PARSER_NOT_SET;
-
-    channels.channel[channelCounter].presentShowStartTime = CONFIGURATION_PARSER_NOT_SET;
-    channels.channel[channelCounter].presentShowDuration = CONFIGURATION_PARSER_NOT_SET;
-    channels.channel[channelCounter].presentShowName = NULL;
-    channels.channel[channelCounter].presentShowDescription = NULL;
-
-    channels.channel[channelCounter].followingShowStartTime = CONFIGURATION_PARSER_NOT_SET;
-    channels.channel[channelCounter].followingShowDuration = CONFIGURATION_PARSER_NOT_SET;
-    channels.channel[channelCounter].followingShowName = NULL;
-    channels.channel[channelCounter].followingShowDescription = NULL;
-
-    channels.channel[channelCounter].subtitleCount = 0;
-    channels.channel[channelCounter].subtitles = NULL;
-
-    int32_t i;
-    for (i = 0; i < pmt->elementaryInformationCount; i++)
+    pmtStreamIterator iterator;
+    pmtStreamView stream;
+    descriptorIterator descriptors;
+    descriptor esDescriptor;
+    uint8_t ac3Descriptor;
+    char subtitles[PMT_SUBTITLES_MAX * SUBTITLE_CHARACTERS_COUNT + 1] = "";
+
+    channel->pmtProgramNumber = pmt->header.programNumber;
+    channel->pmtVersion = pmt->header.versionNumber;
+
+    channel->channelInit.audioType = CONFIGURATION_PARSER_NOT_SET;
+    channel->channelInit.videoType = CONFIGURATION_PARSER_NOT_SET;
+    channel->channelInit.audioPID = CONFIGURATION_PARSER_NOT_SET;
+    channel->channelInit.videoPID = CONFIGURATION_PARSER_NOT_SET;
+
+    channel->presentShowStartTime = CONFIGURATION_PARSER_NOT_SET;
+    channel->presentShowDuration = CONFIGURATION_PARSER_NOT_SET;
+    channel->presentShowName = NULL;
+    channel->presentShowDescription = NULL;
+
+    channel->followingShowStartTime = CONFIGURATION_PARSER_NOT_SET;
+    channel->followingShowDuration = CONFIGURATION_PARSER_NOT_SET;
+    channel->followingShowName = NULL;
+    channel->followingShowDescription = NULL;
+
+    channel->subtitleCount = 0;
+    channel->subtitles = NULL;
+
+    pmtViewStreams(pmt, &iterator);
+    while (pmtStreamNext(&iterator, &stream))
     {
-        streamType = streamTypeDVBtoTDP(pmt->elementaryInformation[i].streamType);
+        ac3Descriptor = 0;
+        descriptorIteratorInit(&descriptors, stream.esInfo, stream.esInfoLength);
+        while (descriptorNext(&descriptors, &esDescriptor))
+        {
+            ac3Descriptor |= esDescriptor.tag == AC3_DESCRIPTOR_TAG;
+            channel->subtitleCount += descriptorSubtitles(&esDescriptor, subtitles, channel->subtitleCount, PMT_SUBTITLES_MAX);
+        }
+
+        streamType = streamTypeDVBtoTDP(stream.streamType, ac3Descriptor);
         if (streamType >= AUDIO_TYPE_DOLBY_AC3 && streamType <= AUDIO_TYPE_UNSUPPORTED)
         {
             /* Audio stream type */
-            if (channels.channel[channelCounter].channelInit.audioType == CONFIGURATION_PARSER_NOT_SET)
+            if (channel->channelInit.audioType == CONFIGURATION_PARSER_NOT_SET)
             {
-                channels.channel[channelCounter].channelInit.audioType = streamType;
-                channels.channel[channelCounter].channelInit.audioPID = pmt->elementaryInformation[i].elementaryPid;
+                channel->channelInit.audioType = streamType;
+                channel->channelInit.audioPID = stream.elementaryPid;
             }
         }
         else if (streamType >= VIDEO_TYPE_H264 && streamType <= VIDEO_TYPE_VP6F)
         {
             /* Video stream type */
-            channels.channel[channelCounter].channelInit.videoType = streamType;
-            channels.channel[channelCounter].channelInit.videoPID = pmt->elementaryInformation[i].elementaryPid;
+            channel->channelInit.videoType = streamType;
+            channel->channelInit.videoPID = stream.elementaryPid;
         }
+    }
+
+    if (channel->subtitleCount)
+    {
+        channel->subtitles = strdup(subtitles);
+    }
+}
+
+/*Function for saving present or following show read from EIT table.*/
+static void eitSaveShow(channelData *channel, eitTable *eit)
+{
+    if (eit->eitHeader.sectionNumber == EIT_PRESENT_SECTION)
+    {
+        channel->presentShowStartTime = eit->eventCount ? eit->event.startTime : CONFIGURATION_PARSER_NOT_SET;
+        channel->presentShowDuration = eit->eventCount ? eit->event.duration : CONFIGURATION_PARSER_NOT_SET;
+        replaceString(&channel->presentShowName, eit->eventCount ? eit->event.eventName : NULL);
+        replaceString(&channel->presentShowDescription, eit->eventCount ? eit->event.eventDescription : NULL);
+    }
+    else
+    {
+        channel->followingShowStartTime = eit->eventCount ? eit->event.startTime : CONFIGURATION_PARSER_NOT_SET;
+        channel->followingShowDuration = eit->eventCount ? eit->event.duration : CONFIGURATION_PARSER_NOT_SET;
+        replaceString(&channel->followingShowName, eit->eventCount ? eit->event.eventName : NULL);
+        replaceString(&channel->followingShowDescription, eit->eventCount ? eit->event.eventDescription : NULL);
+    }
+}
+
+/*Function for replacing heap string, memory is only touched when content changes.*/
+static void replaceString(char **destination, const char *source)
+{
+    if (*destination && source && !strcmp(*destination, source))
+    {
+        return;
+    }
+
+    free(*destination);
+    *destination = source ? strdup(source) : NULL;
+}
+
+/*Function for freeing channel list and strings owned by channels.*/
+static void freeChannels(Channels *list)
+{
+    uint32_t i;
+
+    if (!list->channel)
+    {
+        return;
+    }
+
+    for (i = 0; i < list->channelCount; i++)
+    {
+        free(list->channel[i].subtitles);
+        free(list->channel[i].presentShowName);
+        free(list->channel[i].presentShowDescription);
+        free(list->channel[i].followingShowName);
+        free(list->channel[i].followingShowDescription);
+    }
+
+    free(list->channel);
+    list->channel = NULL;
+    list->channelCount = 0;
+}
+
+/*Function for checking whether channels scanned on home transponder differ from stored ones by PAT or any PMT version.*/
+static uint8_t homeChannelsChanged(Channels *stored, Channels *scanned)
+{
+    uint32_t i;
+
+    if (stored->transportStreamId != scanned->transportStreamId || stored->patVersion != scanned->patVersion ||
+        stored->channelCount < scanned->channelCount)
+    {
+        return 1;
+    }
 
-        if (pmt->subtitleCount)
+    /* home transponder is scanned first, so its channels lead stored list */
+    for (i = 0; i < scanned->channelCount; i++)
+    {
+        if (stored->channel[i].transportStreamId != scanned->channel[i].transportStreamId ||
+            !sameTransponder(&stored->channel[i].transponder, &scanned->channel[i].transponder) ||
+            stored->channel[i].pmtProgramNumber != scanned->channel[i].pmtProgramNumber ||
+            stored->channel[i].pmtPid != scanned->channel[i].pmtPid ||
+            stored->channel[i].pmtVersion != scanned->channel[i].pmtVersion)
         {
-            channels.channel[channelCounter].subtitleCount = pmt->subtitleCount;
-            channels.channel[channelCounter].subtitles = pmt->subtitles;
+            return 1;
         }
     }
-    channelCounter++;
+
+    return i < stored->channelCount && sameTransponder(&stored->channel[i].transponder, &scanList[0]);
+}
+
+/*Function for checking whether stored channel list has to be replaced by scan of all transponders.*/
+static uint8_t channelsStale(Channels *stored)
+{
+    int64_t now = time(NULL);
+
+    /* clock behind scan time (not yet set from broadcast) does not make list stale */
+    return !stored->channelCount || stored->scanListCrc != scanListCrc || now - stored->scanTime > CHANNEL_DATABASE_MAX_AGE_S;
 }
 
-/*Function for converting DVB stream type to TDP stream type.*/
-static streamControllerStatus streamTypeDVBtoTDP(uint32_t dvbStreamType)
+/*Function for converting DVB stream type to TDP stream type, ac3Descriptor tells whether stream carries AC-3 descriptor.*/
+static streamControllerStatus streamTypeDVBtoTDP(uint8_t streamType, uint8_t ac3Descriptor)
 {
-    switch (dvbStreamType)
+    switch (streamType)
     {
     case dvbVideoMPEG2:
         return VIDEO_TYPE_MPEG2;
 
     case dvbAudioMPEG:
         return AUDIO_TYPE_MPEG_AUDIO;
+
+    case dvbPrivateData:
+        /* AC-3 audio is carried as private data and marked by AC-3 descriptor */
+        if (ac3Descriptor)
+        {
+            return AUDIO_TYPE_DOLBY_AC3;
+        }
+        break;
     }
 
     return CONFIGURATION_PARSER_NOT_SET;
 }
 
-/*Function for locking mutex and waiting for condition.*/
-static streamControllerStatus timedWaitForCondition(uint8_t seconds)
+/*Function for switching player stream to PID and type, stream is kept if both are unchanged.*/
+static streamControllerStatus updateStream(playerStream *stream, uint32_t pid, tStreamType type)
 {
-    struct timespec lockStatusWaitTime;
-    struct timeval now;
+    uint8_t result;
 
-    gettimeofday(&now, NULL);
-    lockStatusWaitTime.tv_sec = now.tv_sec + seconds;
+    if (stream->handle && stream->pid == pid && stream->type == type)
+    {
+        return STREAM_CONTROLLER_NO_ERROR;
+    }
 
-    ASSERT_TDP_RESULT(pthread_mutex_lock(&statusMutex), "threadMutexUnlock: pthread_mutex_lock");
-    if (ETIMEDOUT == pthread_cond_timedwait(&statusCondition, &statusMutex, &lockStatusWaitTime))
+    result = removeStream(stream);
+    if (result != STREAM_CONTROLLER_NO_ERROR)
     {
-        printf("\n\nLock timeout exceeded!\n\n");
         return STREAM_CONTROLLER_ERROR;
     }
-    ASSERT_TDP_RESULT(pthread_mutex_unlock(&statusMutex), "timedWaitForCondition: pthread_mutex_unlock");
+
+    if (pid == CONFIGURATION_PARSER_NOT_SET || type == (tStreamType)CONFIGURATION_PARSER_NOT_SET)
+    {
+        return STREAM_CONTROLLER_NO_ERROR;
+    }
+
+    TRACE_CALL(result, "Player_Stream_Create", Player_Stream_Create(playerHandle, sourceHandle, pid, type, &stream->handle));
+    if (result != NO_ERROR)
+    {
+        stream->handle = 0;
+        return STREAM_CONTROLLER_ERROR;
+    }
+
+    stream->pid = pid;
+    stream->type = type;
 
     return STREAM_CONTROLLER_NO_ERROR;
 }
 
-/*Function for signaling condition.*/
-static streamControllerStatus threadMutexUnlock()
+/*Function for removing player stream if it exists.*/
+static streamControllerStatus removeStream(playerStream *stream)
 {
-    ASSERT_TDP_RESULT(pthread_mutex_lock(&statusMutex), "threadMutexUnlock: pthread_mutex_lock");
-    ASSERT_TDP_RESULT(pthread_cond_signal(&statusCondition), "threadMutexUnlock: pthread_cond_signal");
-    ASSERT_TDP_RESULT(pthread_mutex_unlock(&statusMutex), "threadMutexUnlock: pthread_mutex_unlock");
+    uint8_t result;
 
-    return STREAM_CONTROLLER_NO_ERROR;
+    if (!stream->handle)
+    {
+        return STREAM_CONTROLLER_NO_ERROR;
+    }
+
+    TRACE_CALL(result, "Player_Stream_Remove", Player_Stream_Remove(playerHandle, sourceHandle, stream->handle));
+    stream->handle = 0;
+
+    return result == NO_ERROR ? STREAM_CONTROLLER_NO_ERROR : STREAM_CONTROLLER_ERROR;
 }
-/* -------------------- HELPER FUNCTIONS -------------------- */
 
-/* -------------------- CALLBACK FUNCTIONS -------------------- */
-/*Callback function for setting and calling corresponding functions for PAT table parsing.*/
-static int32_t tunerStatusCallback(t_LockStatus status)
+/*Function for updating zap latency figures once streams of marked zap are created.*/
+static void zapFinished()
 {
-    if (status == STATUS_LOCKED)
+    struct timespec now;
+    uint64_t latencyUs;
+    signalStatistics signal;
+
+    if (!zapPending)
     {
-        threadMutexUnlock();
+        return;
     }
-    else
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    latencyUs = (now.tv_sec - zapStart.tv_sec) * 1000000LL + (now.tv_nsec - zapStart.tv_nsec) / 1000;
+    zapPending = 0;
+
+    if (!zapLatency.count || latencyUs < zapLatency.minUs)
     {
-        printf("\n\n\tCALLBACK NOT LOCKED\n\n");
+        zapLatency.minUs = latencyUs;
     }
-    return STREAM_CONTROLLER_NO_ERROR;
+    if (latencyUs > zapLatency.maxUs)
+    {
+        zapLatency.maxUs = latencyUs;
+    }
+    zapLatency.totalUs += latencyUs;
+    zapLatency.count++;
+
+    /* slow zap is reported next to RF conditions it was made in */
+    if (signalMonitorGetStatistics(SIGNAL_MONITOR_SHORT_WINDOW_MS, &signal) == SIGNAL_MONITOR_NO_ERROR)
+    {
+        printf("Zap latency: %.1f ms, signal quality min %u median %u, %u of %u samples unlocked\n", latencyUs / 1000.0,
+               signal.minimum, signal.median, signal.unlockedCount, signal.sampleCount);
+        return;
+    }
+
+    printf("Zap latency: %.1f ms\n", latencyUs / 1000.0);
+}
+
+/*Function for dropping zap which is settling or running, its latency is not counted.*/
+static void zapCancel()
+{
+    timerStopAndDelete(&zapTimer);
+    zapPhase = ZAP_IDLE;
+    zapPending = 0;
 }
 
-/*Callback function for setting and calling corresponding functions for PAT table parsing.*/
-static int32_t patCallback(uint8_t *buffer)
+/****************************************************************************
+ * @brief    Function for requesting zap to channel. Only channel where user
+ *           stops is zapped to: each request replaces target and restarts
+ *           settle timer, and zap already running for an older target is
+ *           abandoned. Meanwhile only channel number is drawn, decoders are
+ *           not touched.
+ *
+ * @param    channelIndex - [in] Index of target channel in channel list.
+ *           settleMs - [in] Time to wait for next channel key, 0 zaps at once.
+****************************************************************************/
+static streamControllerStatus zapSchedule(uint16_t channelIndex, uint32_t settleMs)
 {
     uint8_t result;
 
-    pat = (patTable *)malloc(sizeof(patTable));
+    currentChannel = channelIndex;
+    zapRequests++;
+
+    /* started zap is abandoned whether it still waits for tuner or only audio is left */
+    if (zapPhase == ZAP_LOCK || zapPhase == ZAP_SCAN || zapPhase == ZAP_AUDIO)
+    {
+        zapsCancelled++;
+    }
+    zapPhase = ZAP_SETTLING;
+
+    if (!settleMs)
+    {
+        timerStopAndDelete(&zapTimer);
+        zapSettled();
+        return STREAM_CONTROLLER_NO_ERROR;
+    }
 
-    result = parsePAT(buffer, pat);
-    ASSERT_TDP_RESULT(result, "patCallback: parsePAT");
+    timerSetAndStartMs(&zapTimer, settleMs, zapSettled);
 
-    result = freeFilter(patCallback);
-    ASSERT_TDP_RESULT(result, "patCallback: freeFilter");
+    result = drawChannelNumber(currentChannel + 1);
+    ASSERT_TDP_RESULT(result, "zapSchedule: drawChannelNumber");
 
-    threadMutexUnlock();
+    drawOnScreen();
 
     return STREAM_CONTROLLER_NO_ERROR;
 }
 
-/*Callback function for setting and calling corresponding functions for PMT table parsing.*/
-static int32_t pmtCallback(uint8_t *buffer)
+/*Function for switching video stream once user stopped pressing channel keys, audio is switched on next loop
+  iteration so keys read meanwhile are handled first.*/
+static void zapSettled()
 {
     uint8_t result;
-    pmtTable pmt;
+    uint64_t traceStart = traceBegin();
 
-    result = parsePMT(buffer, &pmt);
-    ASSERT_TDP_RESULT(result, "pmtCallback: parsePMT");
+    zapTimer = 0;
 
-    pmtSaveChannel(&pmt);
-    free(pmt.elementaryInformation);
+    /* channel list may have been replaced by scan while zap was settling */
+    if (currentChannel >= channels.channelCount)
+    {
+        zapCancel();
+        return;
+    }
 
-    pmt.elementaryInformation = NULL;
-    pmt.subtitles = NULL;
+    /* zap continued after lock or scan was counted when it left settling */
+    if (zapPhase == ZAP_SETTLING)
+    {
+        zapsStarted++;
+    }
 
-    result = freeFilter(pmtCallback);
-    ASSERT_TDP_RESULT(result, "pmtCallback: freeFilter");
+    /* channel of another transponder while scan holds tuner, scan returns to it when done (scanDone continues zap) */
+    if (scanPhase != SCAN_IDLE && scanPhase != SCAN_DONE &&
+        !sameTransponder(&channels.channel[currentChannel].transponder, scanPhase == SCAN_RETURN ? &tunedTransponder : &scanHome))
+    {
+        if (scanPhase != SCAN_RETURN)
+        {
+            scanHome = channels.channel[currentChannel].transponder;
+        }
+        zapPhase = ZAP_SCAN;
+        traceEnd("zap video", traceStart);
+        return;
+    }
 
-    threadMutexUnlock();
+    /* channel of another transponder, streams are switched once tuner is locked */
+    if ((scanPhase == SCAN_IDLE || scanPhase == SCAN_DONE) &&
+        !sameTransponder(&channels.channel[currentChannel].transponder, &tunedTransponder))
+    {
+        if (lockTransponder(&channels.channel[currentChannel].transponder, LOCK_ZAP) == STREAM_CONTROLLER_NO_ERROR)
+        {
+            zapPhase = ZAP_LOCK;
+        }
+        else
+        {
+            zapCancel();
+        }
+        traceEnd("zap video", traceStart);
+        return;
+    }
+
+    zapPhase = ZAP_AUDIO;
+
+    result = updateStream(&videoStream, channels.channel[currentChannel].channelInit.videoPID,
+                          channels.channel[currentChannel].channelInit.videoType);
+    if (result != STREAM_CONTROLLER_NO_ERROR)
+    {
+        printf("zapSettled: video stream fail\n");
+    }
+    traceEnd("zap video", traceStart);
+
+    if (eventLoopPost(zapAudio, NULL, 0) != EVENT_LOOP_NO_ERROR)
+    {
+        zapAudio(NULL, 0);
+    }
+}
+
+/*Function for finishing zap on event loop, zap is dropped if newer channel key was pressed after video switch.*/
+static void zapAudio(uint8_t *data, uint16_t size)
+{
+    uint8_t result;
+    uint64_t traceStart;
+
+    if (zapPhase != ZAP_AUDIO)
+    {
+        return;
+    }
+
+    traceStart = traceBegin();
+    zapPhase = ZAP_IDLE;
+
+    result = updateStream(&audioStream, channels.channel[currentChannel].channelInit.audioPID,
+                          channels.channel[currentChannel].channelInit.audioType);
+    if (result != STREAM_CONTROLLER_NO_ERROR)
+    {
+        printf("zapAudio: audio stream fail\n");
+    }
+
+    zapFinished();
+    traceEnd("zap audio", traceStart);
+
+    showChannelInfo();
+}
+
+/****************************************************************************
+ * @brief    Function for requesting lock to transponder. Lock is waited for
+ *           on event loop, lockFinished continues work of given reason once
+ *           tuner reports lock or lock timeout expires. Newer request replaces
+ *           pending one.
+ *
+ * @param    transponder - [in] Transponder to lock to.
+ *           reason - [in] Work continued after lock.
+ *
+ * @return   STREAM_CONTROLLER_NO_ERROR, if lock is requested.
+ *           STREAM_CONTROLLER_ERROR, in case of an error.
+****************************************************************************/
+static streamControllerStatus lockTransponder(transponderInit *transponder, lockReason reason)
+{
+    uint8_t result;
+
+    tunedTransponder = *transponder;
+    lockPending = reason;
+    __atomic_store_n(&lockSequence, lockSequence + 1, __ATOMIC_RELEASE);
+    signalMonitorSetLocked(0);
+    signalMonitorSetRetuning(1);
+
+    TRACE_CALL(result, "Tuner_Lock_To_Frequency", Tuner_Lock_To_Frequency(transponder->frequency * 1000000, transponder->bandwidth, transponder->module));
+    if (result != NO_ERROR)
+    {
+        lockPending = LOCK_NONE;
+        signalMonitorSetRetuning(0);
+        timerStopAndDelete(&lockTimer);
+        printf("lockTransponder: Tuner_Lock_To_Frequency %u MHz fail\n", transponder->frequency);
+        return STREAM_CONTROLLER_ERROR;
+    }
+    timerSetAndStart(&lockTimer, TUNER_LOCK_TIMEOUT, lockTimeout);
+
+    return STREAM_CONTROLLER_NO_ERROR;
+}
+
+/*Function for continuing work which waited for tuner lock, blind scan skips frequency which did not lock.*/
+static void lockFinished(uint8_t locked)
+{
+    lockReason reason = lockPending;
+
+    timerStopAndDelete(&lockTimer);
+    timerStopAndDelete(&probeTimer);
+    lockPending = LOCK_NONE;
+    signalMonitorSetRetuning(0);
+
+    switch (reason)
+    {
+    case LOCK_RETUNE:
+        tuneFinished();
+        break;
+
+    case LOCK_SCAN:
+        if (!locked && scanBlind && scanPhase == SCAN_LOCK)
+        {
+            scanMuxCaptured();
+        }
+        else
+        {
+            scanLocked();
+        }
+        break;
+
+    case LOCK_ZAP:
+        if (zapPhase == ZAP_LOCK)
+        {
+            zapSettled();
+        }
+        break;
+
+    case LOCK_NONE:
+        break;
+    }
+}
+
+/*Function called at timer trigger if tuner did not lock, transponder is used anyway as on init.*/
+static void lockTimeout()
+{
+    lockTimer = 0;
+    if (!scanBlind || lockPending != LOCK_SCAN)
+    {
+        printf("lockTransponder: tuner lock timeout (%u MHz)\n", tunedTransponder.frequency);
+    }
+
+    lockFinished(0);
+}
+
+/****************************************************************************
+ * @brief    Function for polling signal quality while blind scan waits for
+ *           lock. Frequency which shows no signal within BLIND_SCAN_SIGNAL_MS
+ *           is given up on at once, frequency with signal is given time until
+ *           BLIND_SCAN_LOCK_MS to lock.
+****************************************************************************/
+static void signalProbe()
+{
+    uint8_t result;
+    uint8_t quality = 0;
+
+    probeTimer = 0;
+    if (lockPending != LOCK_SCAN)
+    {
+        return;
+    }
+
+    TRACE_CALL(result, "Tuner_Get_Signal_Quality", Tuner_Get_Signal_Quality(&quality));
+    if (result == NO_ERROR && quality >= BLIND_SCAN_MIN_QUALITY)
+    {
+        return;
+    }
+
+    if (elapsedMs(&muxLockStart) >= BLIND_SCAN_SIGNAL_MS)
+    {
+        lockFinished(0);
+        return;
+    }
+
+    timerSetAndStartMs(&probeTimer, BLIND_SCAN_POLL_MS, signalProbe);
+}
+
+static uint8_t sameTransponder(transponderInit *first, transponderInit *second)
+{
+    return first->frequency == second->frequency && first->bandwidth == second->bandwidth && first->module == second->module;
+}
+
+/*Function for copying transponder list of configuration or building one from blind scan band, list is never empty.*/
+static streamControllerStatus setScanList(initialConfig *config)
+{
+    blindScanInit *band = &config->blindScan;
+    uint32_t count = config->transponderCount ? config->transponderCount : 1;
+    transponderInit *list;
+    uint32_t i;
+
+    /* every frequency of band is tried with every bandwidth, in order */
+    if (config->blindScanSet)
+    {
+        count = ((band->endFrequency - band->startFrequency) / band->step + 1) * band->bandwidthCount;
+    }
+
+    list = (transponderInit *)malloc(count * sizeof(transponderInit));
+    if (!list)
+    {
+        printf("setScanList: allocation fail\n");
+        return STREAM_CONTROLLER_ERROR;
+    }
+
+    if (config->blindScanSet)
+    {
+        for (i = 0; i < count; i++)
+        {
+            list[i].frequency = band->startFrequency + i / band->bandwidthCount * band->step;
+            list[i].bandwidth = band->bandwidths[i % band->bandwidthCount];
+            list[i].module = band->module;
+        }
+    }
+    else if (config->transponderCount)
+    {
+        memcpy(list, config->transponders, count * sizeof(transponderInit));
+    }
+    else
+    {
+        list[0] = config->transponder;
+    }
+
+    free(scanList);
+    scanList = list;
+    scanListCount = count;
+    scanListCrc = sectionCrc32((const uint8_t *)list, count * sizeof(transponderInit));
+    scanBlind = config->blindScanSet;
+
+    return STREAM_CONTROLLER_NO_ERROR;
+}
+
+/*Function for starting scan of transponder scanIndex, tuner is not relocked if it is already there.*/
+static void scanMuxStart()
+{
+    clock_gettime(CLOCK_MONOTONIC, &muxLockStart);
+
+    if (sameTransponder(&scanList[scanIndex], &tunedTransponder) && lockPending == LOCK_NONE)
+    {
+        scanLocked();
+        return;
+    }
+
+    scanPhase = SCAN_LOCK;
+    if (lockTransponder(&scanList[scanIndex], LOCK_SCAN) != STREAM_CONTROLLER_NO_ERROR)
+    {
+        /* transponder is skipped from scanTimeout, scanMuxCaptured of previous transponder may still be running */
+        clock_gettime(CLOCK_MONOTONIC, &muxPsiStart);
+        timerSetAndStartMs(&scanTimer, 0, scanTimeout);
+        return;
+    }
+
+    /* empty frequency is given up on by signalProbe instead of waiting for lock timeout */
+    if (scanBlind)
+    {
+        timerSetAndStartMs(&lockTimer, BLIND_SCAN_LOCK_MS, lockTimeout);
+        timerSetAndStartMs(&probeTimer, BLIND_SCAN_POLL_MS, signalProbe);
+    }
+}
+
+/*Function for finding next transponder to scan, blind scan does not try other bandwidths on frequency which locked.*/
+static uint32_t scanNextIndex(uint32_t index, uint8_t locked)
+{
+    uint32_t next = index + 1;
+
+    while (scanBlind && locked && next < scanListCount && scanList[next].frequency == scanList[index].frequency)
+    {
+        next++;
+    }
+
+    return next;
+}
+
+/*Function for starting PSI acquisition once tuner is locked to scanned transponder.*/
+static void scanLocked()
+{
+    uint8_t result;
+
+    if (scanPhase == SCAN_RETURN)
+    {
+        scanDone();
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &muxPsiStart);
+    scanLockedCount++;
+
+    /* tables of previous transponder are not valid any more */
+    sectionCacheReset(&siCache);
+
+    /* PAT is waited for on event loop, scan continues in patReceived or scanTimeout */
+    scanPhase = SCAN_PAT;
+    timerSetAndStart(&scanTimer, PAT_TIMEOUT, scanTimeout);
+
+    result = setFilter(PAT_ID, PAT_PID, &patFilterHandle);
+    if (result)
+    {
+        /* transponder is skipped from scanTimeout */
+        printf("channelsSetup: PAT filter setup fail\n");
+        timerSetAndStartMs(&scanTimer, 0, scanTimeout);
+    }
+}
+
+/*Function for arming all PMT filters at once when PAT is received.*/
+static void scanPmtStart()
+{
+    uint8_t result;
+    uint16_t programCount = 0;
+    patTableProgramInformation program;
+    int32_t i;
+
+    freeFilter(&patFilterHandle);
+
+    /* program number 0 entry points to network PID and is not a channel */
+    for (i = 0; i < pat.programCount; i++)
+    {
+        patViewProgram(&pat, i, &program);
+        programCount += program.programNumber ? 1 : 0;
+    }
+
+    /* every PMT gets its own filter, requests are filled before any filter is armed */
+    scanTransportStreamId = pat.header.transportStreamId;
+    scanPatVersion = pat.header.versionNumber;
+    scanPhase = SCAN_PMT;
+    pmtRequests = (pmtRequest *)calloc(programCount, sizeof(pmtRequest));
+    if (!pmtRequests)
+    {
+        printf("channelsSetup: allocation fail\n");
+        scanMuxCaptured();
+        return;
+    }
+
+    for (i = 0; i < pat.programCount; i++)
+    {
+        patViewProgram(&pat, i, &program);
+        if (program.programNumber)
+        {
+            pmtRequests[pmtRequestCount].programNumber = program.programNumber;
+            pmtRequests[pmtRequestCount].programMapPid = program.programMapPid;
+            pmtRequestCount++;
+        }
+    }
+
+    /* shared deadline bounds scan by the slowest PMT */
+    timerSetAndStart(&scanTimer, PMT_TIMEOUT, scanTimeout);
+
+    for (i = 0; i < pmtRequestCount; i++)
+    {
+        result = setFilter(PMT_ID, pmtRequests[i].programMapPid, &pmtRequests[i].filterHandle);
+        if (result)
+        {
+            /* demux is out of filters, this PMT is counted as finished so scan does not wait out deadline for it */
+            printf("channelsSetup: PMT filter setup fail (PID %u)\n", pmtRequests[i].programMapPid);
+            pmtFailedCount++;
+        }
+    }
+
+    if (pmtFailedCount == pmtRequestCount)
+    {
+        scanMuxCaptured();
+    }
+}
+
+/****************************************************************************
+ * @brief    Function for finishing acquisition of scanned transponder when all
+ *           PMT tables are received or deadline expired. Tuner is told to lock
+ *           to next transponder first, PMT tables of this one are parsed and
+ *           merged into channel list while tuner is locking.
+****************************************************************************/
+static void scanMuxCaptured()
+{
+    pmtRequest *requests = pmtRequests;
+    uint16_t requestCount = pmtRequestCount;
+    uint16_t receivedCount = pmtReceivedCount;
+    uint16_t transportStreamId = scanTransportStreamId;
+    uint32_t index = scanIndex;
+    uint32_t channelCount = scannedChannels.channelCount;
+    long lockMs = (muxPsiStart.tv_sec - muxLockStart.tv_sec) * 1000 + (muxPsiStart.tv_nsec - muxLockStart.tv_nsec) / 1000000;
+    long psiMs = elapsedMs(&muxPsiStart);
+    uint8_t psiReceived = scanPhase == SCAN_PMT;
+    uint8_t locked = scanPhase != SCAN_LOCK;
+    uint32_t next = scanNextIndex(index, locked);
+    int32_t i;
+
+    timerStopAndDelete(&scanTimer);
+    freeFilter(&patFilterHandle);
+    for (i = 0; i < requestCount; i++)
+    {
+        freeFilter(&pmtRequests[i].filterHandle);
+    }
+
+    /* PAT/PMT versions of home transponder identify stored database */
+    if (!index && psiReceived)
+    {
+        scannedChannels.transportStreamId = scanTransportStreamId;
+        scannedChannels.patVersion = scanPatVersion;
+    }
+
+    pmtRequests = NULL;
+    pmtRequestCount = 0;
+    pmtReceivedCount = 0;
+    pmtFailedCount = 0;
+
+    if (next < scanListCount && !scanHomeOnly)
+    {
+        scanIndex = next;
+        scanMuxStart();
+    }
+
+    if (psiReceived)
+    {
+        scanMuxStore(requests, requestCount, transportStreamId, &scanList[index]);
+    }
+    freePmtRequests(requests, requestCount);
+
+    /* blind scan reports only frequencies which locked */
+    if (locked || !scanBlind)
+    {
+        printf("channelsSetup: transponder %u/%u (%u MHz): lock %ld ms, PSI %ld ms, %u/%u PMT tables, %u new channels\n",
+               index + 1, scanListCount, scanList[index].frequency, lockMs, psiMs, receivedCount, requestCount,
+               scannedChannels.channelCount - channelCount);
+    }
+
+    if (scanHomeOnly)
+    {
+        scanHomeChecked(next);
+    }
+    else if (next == scanListCount)
+    {
+        scanFinish();
+    }
+}
+
+/*Function for parsing captured PMT tables of one transponder into merged list, services already in list are skipped.*/
+static void scanMuxStore(pmtRequest *requests, uint16_t requestCount, uint16_t transportStreamId, transponderInit *transponder)
+{
+    pmtView pmt;
+    channelData *channel;
+    uint32_t i;
+    uint32_t j;
+
+    /* keep PAT order, drop services whose PMT did not arrive */
+    for (i = 0; i < requestCount; i++)
+    {
+        if (!requests[i].section)
+        {
+            continue;
+        }
+
+        /* same service can be received from more than one transponder */
+        for (j = 0; j < scannedChannels.channelCount; j++)
+        {
+            if (scannedChannels.channel[j].transportStreamId == transportStreamId &&
+                scannedChannels.channel[j].pmtProgramNumber == requests[i].programNumber)
+            {
+                break;
+            }
+        }
+        if (j < scannedChannels.channelCount)
+        {
+            continue;
+        }
+
+        if (pmtViewInit(&pmt, requests[i].section) != TABLES_PARSER_NO_ERROR)
+        {
+            printf("channelsSetup: PMT of program %u fail\n", requests[i].programNumber);
+            continue;
+        }
+
+        channel = scanAppendChannel();
+        if (!channel)
+        {
+            printf("channelsSetup: allocation fail\n");
+            return;
+        }
+
+        pmtSaveChannel(channel, &pmt);
+        channel->pmtPid = requests[i].programMapPid;
+        channel->transportStreamId = transportStreamId;
+        channel->transponder = *transponder;
+    }
+}
+
+/*Function for adding zeroed channel to merged list, list grows by doubling.*/
+static channelData *scanAppendChannel()
+{
+    channelData *grown;
+    uint32_t capacity;
+
+    if (scannedChannels.channelCount == scannedCapacity)
+    {
+        capacity = scannedCapacity ? 2 * scannedCapacity : 16;
+        grown = (channelData *)realloc(scannedChannels.channel, capacity * sizeof(channelData));
+        if (!grown)
+        {
+            return NULL;
+        }
+        scannedChannels.channel = grown;
+        scannedCapacity = capacity;
+    }
+
+    memset(&scannedChannels.channel[scannedChannels.channelCount], 0, sizeof(channelData));
+    return &scannedChannels.channel[scannedChannels.channelCount++];
+}
+
+/*Function for keeping stored channel list if home transponder did not change, otherwise scan goes on with next transponder.*/
+static void scanHomeChecked(uint32_t next)
+{
+    scanHomeOnly = 0;
+
+    if (!homeChannelsChanged(&channels, &scannedChannels))
+    {
+        printf("channelsSetup: home transponder unchanged, %u stored channels kept (%ld ms)\n", channels.channelCount,
+               elapsedMs(&scanStart));
+        freeChannels(&scannedChannels);
+        memset(&scannedChannels, 0, sizeof(Channels));
+        scannedCapacity = 0;
+        scanDone();
+        return;
+    }
+
+    printf("channelsSetup: home transponder changed, scanning all transponders\n");
+    if (next < scanListCount)
+    {
+        scanIndex = next;
+        scanMuxStart();
+        return;
+    }
+
+    scanFinish();
+}
+
+/*Function for replacing channel list with merged one once all transponders are scanned.*/
+static void scanFinish()
+{
+    printf("channelsSetup: %u/%u transponders locked, %u channels in %ld ms\n", scanLockedCount, scanListCount,
+           scannedChannels.channelCount, elapsedMs(&scanStart));
+
+    /* scanned list replaces the loaded one, database is rewritten so its scan time is renewed */
+    if (scannedChannels.channelCount)
+    {
+        scannedChannels.scanListCrc = scanListCrc;
+        scannedChannels.scanTime = time(NULL);
+
+        freeChannels(&channels);
+        channels = scannedChannels;
+        if (currentChannel >= channels.channelCount)
+        {
+            currentChannel = 0;
+        }
+
+        if (channelDatabaseSave(CHANNEL_DATABASE_FILE, scanList[0].frequency, &channels) != CHANNEL_DATABASE_NO_ERROR)
+        {
+            printf("channelsSetup: saving %s fail\n", CHANNEL_DATABASE_FILE);
+        }
+    }
+    else
+    {
+        freeChannels(&scannedChannels);
+    }
+    memset(&scannedChannels, 0, sizeof(Channels));
+    scannedCapacity = 0;
+
+    /* streams of scan start are decoded again once tuner is back */
+    if (!sameTransponder(&scanHome, &tunedTransponder))
+    {
+        scanPhase = SCAN_RETURN;
+        if (lockTransponder(&scanHome, LOCK_SCAN) == STREAM_CONTROLLER_NO_ERROR)
+        {
+            return;
+        }
+    }
+
+    scanDone();
+}
+
+/*Function for leaving scan on home transponder, zap waiting for tuner is continued.*/
+static void scanDone()
+{
+    uint8_t result;
+
+    scanPhase = SCAN_DONE;
+
+    /* keep EIT present/following filter running, channel show data is updated as sections arrive */
+    sectionWorkersResetCaches();
+    result = setFilter(EIT_ID, EIT_PID, &eitFilterHandle);
+    if (result)
+    {
+        printf("channelsSetup: EIT filter setup fail\n");
+    }
+
+    if (zapPhase == ZAP_SCAN)
+    {
+        zapSettled();
+    }
+}
+
+/*Function for handling scan deadline at timer trigger, transponder without PAT is skipped.*/
+static void scanTimeout()
+{
+    scanTimer = 0;
+
+    if (scanPhase == SCAN_PAT)
+    {
+        printf("channelsSetup: PAT not received (%u MHz)\n", tunedTransponder.frequency);
+    }
+
+    if (scanPhase == SCAN_LOCK || scanPhase == SCAN_PAT || scanPhase == SCAN_PMT)
+    {
+        scanMuxCaptured();
+    }
+}
+
+/*Function for stopping scan and EIT acquisition, partial channel list of running scan is dropped.*/
+static streamControllerStatus scanStop()
+{
+    uint8_t result;
+    int32_t i;
+
+    timerStopAndDelete(&scanTimer);
+    if (lockPending == LOCK_SCAN)
+    {
+        timerStopAndDelete(&lockTimer);
+        timerStopAndDelete(&probeTimer);
+        lockPending = LOCK_NONE;
+    }
+
+    for (i = 0; i < pmtRequestCount; i++)
+    {
+        freeFilter(&pmtRequests[i].filterHandle);
+    }
+    freePmtRequests(pmtRequests, pmtRequestCount);
+    pmtRequests = NULL;
+    freeChannels(&scannedChannels);
+    scannedCapacity = 0;
+    pmtRequestCount = 0;
+    pmtReceivedCount = 0;
+    pmtFailedCount = 0;
+    scanPhase = SCAN_IDLE;
+    scanHomeOnly = 0;
+    freeFilter(&patFilterHandle);
+    freeFilter(&eitFilterHandle);
+    TRACE_CALL(result, "Demux_Unregister_Section_Filter_Callback", Demux_Unregister_Section_Filter_Callback(sectionCallback));
+    ASSERT_TDP_RESULT(result, "scanStop: Demux_Unregister_Section_Filter_Callback");
+
+    return STREAM_CONTROLLER_NO_ERROR;
+}
+
+static void freePmtRequests(pmtRequest *requests, uint16_t requestCount)
+{
+    uint16_t i;
+
+    for (i = 0; i < requestCount; i++)
+    {
+        free(requests[i].section);
+    }
+    free(requests);
+}
+
+/*Function for starting streams and scan of new transponder once tuner is locked.*/
+static void tuneFinished()
+{
+    if (startPlayerStream(&retuneChannel) != STREAM_CONTROLLER_NO_ERROR)
+    {
+        printf("tuneTransponder: startPlayerStream fail\n");
+    }
+
+    if (channelsSetup() != STREAM_CONTROLLER_NO_ERROR)
+    {
+        printf("tuneTransponder: channelsSetup fail\n");
+    }
+}
+
+static long elapsedMs(struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+/*Function for initializing completion.*/
+static void completionInit(completion *event)
+{
+    pthread_mutex_init(&event->mutex, NULL);
+    pthread_cond_init(&event->condition, NULL);
+    event->done = 0;
+}
+
+/*Function for destroying completion.*/
+static void completionDeinit(completion *event)
+{
+    pthread_cond_destroy(&event->condition);
+    pthread_mutex_destroy(&event->mutex);
+}
+
+/*Function for signaling completion. Signal is kept, so a later wait returns immediately.*/
+static void completionSignal(completion *event)
+{
+    pthread_mutex_lock(&event->mutex);
+    event->done = 1;
+    pthread_cond_signal(&event->condition);
+    pthread_mutex_unlock(&event->mutex);
+}
+
+/*Function for waiting for completion until absolute deadline.*/
+static streamControllerStatus completionWait(completion *event, struct timespec *deadline)
+{
+    uint8_t done;
+
+    pthread_mutex_lock(&event->mutex);
+    while (!event->done)
+    {
+        if (ETIMEDOUT == pthread_cond_timedwait(&event->condition, &event->mutex, deadline))
+        {
+            break;
+        }
+    }
+    done = event->done;
+    pthread_mutex_unlock(&event->mutex);
+
+    if (!done)
+    {
+        printf("\n\nLock timeout exceeded!\n\n");
+        return STREAM_CONTROLLER_ERROR;
+    }
+
+    return STREAM_CONTROLLER_NO_ERROR;
+}
+
+/*Function for calculating absolute deadline used by completionWait.*/
+static void deadlineAfter(struct timespec *deadline, uint8_t seconds)
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+    deadline->tv_sec = now.tv_sec + seconds;
+    deadline->tv_nsec = now.tv_usec * 1000;
+}
+
+/*Function for printing first section lost to full event loop queue since scan start, called on SDK and worker threads.*/
+static void loopDropReport(const char *function, uint8_t tableId)
+{
+    if (!__atomic_exchange_n(&loopDropReported, 1, __ATOMIC_RELAXED))
+    {
+        printf("%s: event loop queue full, table 0x%02X dropped, further drops are not printed\n", function, tableId);
+    }
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
+
+/* -------------------- CALLBACK FUNCTIONS -------------------- */
+/*Callback function for signaling tuner lock to streamControllerInit.*/
+static int32_t tunerStatusCallback(t_LockStatus status)
+{
+    uint32_t sequence = __atomic_load_n(&lockSequence, __ATOMIC_ACQUIRE);
+
+    /* init waits for completion, it does not wait out lock timeout when tuner reports it cannot lock */
+    completionSignal(&tunerLocked);
+
+    if (status == STATUS_LOCKED)
+    {
+        /* retune, scan and zap wait on event loop */
+        eventLoopPost(tunerLockReceived, (uint8_t *)&sequence, sizeof(sequence));
+    }
+    else
+    {
+        eventLoopPost(tunerLockFailed, (uint8_t *)&sequence, sizeof(sequence));
+    }
 
     return STREAM_CONTROLLER_NO_ERROR;
 }
 
-/*Callback function for setting and calling corresponding functions for EIT table parsing.*/
+/*Callback function called on SDK thread, section is only copied: EIT to worker of its service, PAT and PMT to event loop.*/
+static int32_t sectionCallback(uint8_t *buffer)
+{
+    uint16_t sectionSize = 3 + (((*(buffer + 1) & 0x0F) << 8) | *(buffer + 2));
+
+    if (buffer[0] == EIT_ID)
+    {
+        /* sections of one service go to the same worker, so they are parsed in arrival order */
+        sectionWorkersPost((uint16_t)(buffer[3] << 8) + buffer[4], buffer, sectionSize);
+        return STREAM_CONTROLLER_NO_ERROR;
+    }
+
+    if (eventLoopPost(sectionReceived, buffer, sectionSize) != EVENT_LOOP_NO_ERROR)
+    {
+        loopDropReport("sectionCallback", buffer[0]);
+    }
 
+    return STREAM_CONTROLLER_NO_ERROR;
+}
 /* -------------------- CALLBACK FUNCTIONS -------------------- */
+
+/* -------------------- SECTION PARSERS -------------------- */
+/*Function for parsing EIT present/following section on worker thread, parsed table is handed over to event loop.*/
+static void eitParse(uint8_t *section, uint16_t size, sectionCache *cache)
+{
+    eitTable eit;
+    uint8_t sectionNumber = section[6];
+
+    /* only current present/following sections are of interest */
+    if (!(section[5] & 0x01) || sectionNumber > EIT_FOLLOWING_SECTION)
+    {
+        return;
+    }
+
+    /* repeated section of unchanged version and CRC is dropped before parsing, cache belongs to this worker */
+    if (sectionCacheCheck(cache, EIT_PID, section) == SECTION_CACHE_HIT)
+    {
+        return;
+    }
+
+    if (parseEIT(section, &eit) != TABLES_PARSER_NO_ERROR)
+    {
+        sectionCacheInvalidate(cache, EIT_PID, section);
+        return;
+    }
+
+    if (eventLoopPost(eitReceived, (uint8_t *)&eit, sizeof(eitTable)) != EVENT_LOOP_NO_ERROR)
+    {
+        /* next repetition is parsed again, show data is not lost when event loop queue is full */
+        sectionCacheInvalidate(cache, EIT_PID, section);
+        loopDropReport("eitParse", section[0]);
+    }
+}
+/* -------------------- SECTION PARSERS -------------------- */
+
+/* -------------------- SECTION HANDLERS -------------------- */
+/*Function for continuing work waiting for tuner lock, lock of init tuning is not waited for here.*/
+static void tunerLockReceived(uint8_t *data, uint16_t size)
+{
+    uint8_t result;
+    uint8_t quality = 0;
+    uint32_t sequence;
+
+    /* status of earlier request (init tuning or replaced lock) is still queued when new lock is requested */
+    memcpy(&sequence, data, sizeof(sequence));
+    if (sequence != lockSequence)
+    {
+        return;
+    }
+
+    /* late lock of abandoned scan frequency can carry number of newer request as in tunerLockFailed, scan
+       takes lock only from tuner which shows signal, otherwise signalProbe and lock timeout decide */
+    if (lockPending == LOCK_SCAN)
+    {
+        TRACE_CALL(result, "Tuner_Get_Signal_Quality", Tuner_Get_Signal_Quality(&quality));
+        if (result != NO_ERROR || quality < BLIND_SCAN_MIN_QUALITY)
+        {
+            return;
+        }
+    }
+
+    /* lock state is reported to monitor only for current request */
+    signalMonitorSetLocked(1);
+    if (lockPending == LOCK_NONE)
+    {
+        signalMonitorSetRetuning(0);
+        return;
+    }
+
+    lockFinished(1);
+}
+
+/*Function for reporting lost lock to monitor and giving up on blind scan frequency as soon as tuner reports it cannot lock, other work waits for timeout.*/
+static void tunerLockFailed(uint8_t *data, uint16_t size)
+{
+    uint8_t result;
+    uint8_t quality = 0;
+    uint32_t sequence;
+
+    memcpy(&sequence, data, sizeof(sequence));
+    if (sequence != lockSequence)
+    {
+        return;
+    }
+
+    /* sequence is read when callback runs, so late failure of abandoned frequency can carry number of newer
+       request; tuner which shows signal is left to signalProbe and lock timeout */
+    TRACE_CALL(result, "Tuner_Get_Signal_Quality", Tuner_Get_Signal_Quality(&quality));
+    if (result == NO_ERROR && quality >= BLIND_SCAN_MIN_QUALITY)
+    {
+        return;
+    }
+
+    signalMonitorSetLocked(0);
+    if (lockPending == LOCK_NONE)
+    {
+        /* init tuning failed or lock was lost, following samples count as unlocked */
+        signalMonitorSetRetuning(0);
+        return;
+    }
+
+    /* quality is not measurable right after tuning, early failure is left to signalProbe */
+    if (lockPending == LOCK_SCAN && scanBlind && scanPhase == SCAN_LOCK && elapsedMs(&muxLockStart) >= BLIND_SCAN_SIGNAL_MS)
+    {
+        lockFinished(0);
+    }
+}
+
+/*Function for passing section posted by sectionCallback to handler of its table.*/
+static void sectionReceived(uint8_t *section, uint16_t size)
+{
+    switch (section[0])
+    {
+    case PAT_ID:
+        patReceived(section, size);
+        break;
+
+    case PMT_ID:
+        pmtReceived(section);
+        break;
+    }
+}
+
+/*Function for parsing PAT during scan and starting PMT acquisition.*/
+static streamControllerStatus patReceived(uint8_t *buffer, uint16_t sectionSize)
+{
+    uint8_t result;
+
+    /* PAT repetition before filter is freed */
+    if (scanPhase != SCAN_PAT || sectionSize > PAT_SECTION_MAX_SIZE ||
+        sectionCacheCheck(&siCache, PAT_PID, buffer) == SECTION_CACHE_HIT)
+    {
+        return STREAM_CONTROLLER_NO_ERROR;
+    }
+
+    /* posted buffer is reused by event loop, PAT is needed until PMT requests are built */
+    memcpy(patSection, buffer, sectionSize);
+    result = patViewInit(&pat, patSection);
+    if (result != TABLES_PARSER_NO_ERROR)
+    {
+        sectionCacheInvalidate(&siCache, PAT_PID, buffer);
+    }
+    ASSERT_TDP_RESULT(result, "patReceived: patViewInit");
+
+    scanPmtStart();
+
+    return STREAM_CONTROLLER_NO_ERROR;
+}
+
+/*Function for parsing PMT during scan, scan is finished with the last expected PMT.*/
+static streamControllerStatus pmtReceived(uint8_t *buffer)
+{
+    uint16_t sectionSize;
+    uint16_t programNumber = (uint16_t)(*(buffer + 3) << 8) + *(buffer + 4);
+    int32_t i;
+
+    if (scanPhase != SCAN_PMT)
+    {
+        return STREAM_CONTROLLER_NO_ERROR;
+    }
+
+    /* find request by program number before parsing, repetitions of received PMTs are dropped */
+    for (i = 0; i < pmtRequestCount; i++)
+    {
+        if (pmtRequests[i].programNumber == programNumber)
+        {
+            break;
+        }
+    }
+
+    if (i == pmtRequestCount || pmtRequests[i].section ||
+        sectionCacheCheck(&siCache, pmtRequests[i].programMapPid, buffer) == SECTION_CACHE_HIT)
+    {
+        return STREAM_CONTROLLER_NO_ERROR;
+    }
+
+    /* PMT is only copied here, it is parsed while tuner locks to next transponder */
+    sectionSize = PSI_SECTION_HEADER_SIZE + (((uint16_t)(buffer[1] & 0x0F) << 8) | buffer[2]);
+    pmtRequests[i].section = (uint8_t *)malloc(sectionSize);
+    if (!pmtRequests[i].section)
+    {
+        sectionCacheInvalidate(&siCache, pmtRequests[i].programMapPid, buffer);
+        printf("pmtReceived: allocation fail\n");
+        return STREAM_CONTROLLER_ERROR;
+    }
+    memcpy(pmtRequests[i].section, buffer, sectionSize);
+
+    /* filter of received PMT is not needed any more */
+    freeFilter(&pmtRequests[i].filterHandle);
+
+    if (++pmtReceivedCount + pmtFailedCount == pmtRequestCount)
+    {
+        scanMuxCaptured();
+    }
+
+    return STREAM_CONTROLLER_NO_ERROR;
+}
+
+/*Function for saving EIT parsed by section worker as show data of its channel.*/
+static void eitReceived(uint8_t *data, uint16_t size)
+{
+    eitTable eit;
+    uint32_t i;
+
+    /* tables parsed before retune are dropped */
+    if (!eitFilterHandle)
+    {
+        return;
+    }
+
+    /* posted data is not aligned for table fields */
+    memcpy(&eit, data, sizeof(eitTable));
+    for (i = 0; i < channels.channelCount; i++)
+    {
+        if (channels.channel[i].pmtProgramNumber == eit.eitHeader.serviceId &&
+            channels.channel[i].transportStreamId == eit.eitHeader.transportStreamId)
+        {
+            eitSaveShow(&channels.channel[i], &eit);
+            break;
+        }
+    }
+}
+/* -------------------- SECTION HANDLERS -------------------- */
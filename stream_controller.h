@@ -3,6 +3,8 @@
 
 #include "configuration_parser.h"
 
+#include <sys/time.h>
+
 typedef enum _streamControllerStatus
 {
     STREAM_CONTROLLER_NO_ERROR = 0,
@@ -25,6 +27,10 @@ typedef enum _streamControllerStatus
 typedef struct _channelData
 {
     uint16_t pmtProgramNumber;
+    uint16_t pmtPid;
+    uint8_t pmtVersion;
+    uint16_t transportStreamId;
+    transponderInit transponder; // channel is received from this transponder
 
     startingChannelInit channelInit;
 
@@ -46,13 +52,18 @@ typedef struct _channels
 {
     channelData *channel;
     uint32_t channelCount;
+    uint16_t transportStreamId;
+    uint8_t patVersion;
+    uint32_t scanListCrc; // of scan list channels were found with
+    int64_t scanTime;     // seconds since epoch of full scan which found channels
 } Channels;
 
 typedef enum _dvbStreamType
 {
     dvbVideo = 0x01,
     dvbVideoMPEG2 = 0x02,
-    dvbAudioMPEG = 0x03
+    dvbAudioMPEG = 0x03,
+    dvbPrivateData = 0x06 // audio or subtitles, told apart by ES descriptors
 } dvbStreamType;
 
 /*Function for tuner and player initialization.*/
@@ -61,39 +72,53 @@ streamControllerStatus streamControllerInit(initialConfig *config);
 /*Function for tuner and player deinitialization.*/
 streamControllerStatus streamControllerDeinit();
 
-/*Function for creating player stream and setting volume.*/
+/*Function for switching player streams to channel, streams whose PID and type do not change are kept.*/
 streamControllerStatus startPlayerStream(startingChannelInit *channel);
 
 /*Function for removing player stream.*/
 streamControllerStatus stopPlayerStream();
 
-/*Function for setting up channels based on information from PAT, PMT and EIT tables.*/
-void *channelsSetup();
-
-/*Function for starting player stream.*/
+/*Function for starting channel scan based on information from PAT, PMT and EIT tables. Scan continues on event
+  loop as sections arrive. Channel list loaded from channel database at init stays usable until scan finishes.
+  Fresh database is only checked against PAT/PMT versions of home transponder, which needs no retune; all
+  transponders are scanned and database rewritten if it is missing, older than CHANNEL_DATABASE_MAX_AGE_S,
+  was scanned with another transponder list or home transponder changed.*/
+streamControllerStatus channelsSetup();
+
+/*Function for checking if channel scan started by channelsSetup or tuneTransponder is still running.*/
+uint8_t channelsSetupRunning();
+
+/****************************************************************************
+ * @brief    Function for tuning to another transponder without restarting
+ *           player. Scan and streams of current transponder are stopped and
+ *           lock is waited for on event loop, then streams of starting channel
+ *           are started and all transponders of configuration are scanned
+ *           again.
+ *
+ * @param    config - [in] Configuration with transponders and starting channel.
+ *
+ * @return   STREAM_CONTROLLER_NO_ERROR, if tuning is started.
+ *           STREAM_CONTROLLER_ERROR, in case of an error.
+****************************************************************************/
+streamControllerStatus tuneTransponder(initialConfig *config);
+
+/*Function for zapping to channel with given number, zap is done on event loop.*/
 streamControllerStatus playChannel(uint16_t channelNumber);
 
-/*Function for starting player stream for next channel.*/
+/*Function for marking time of zap key press, zap latency is measured from it until new streams are created.
+  NULL marks current time. Time has to be taken from CLOCK_MONOTONIC.*/
+void zapKeyPressed(const struct timeval *keyPressTime);
+
+/*Function for zapping to next channel. Channel keys pressed in quick succession are merged, only channel where
+  user stops is zapped to.*/
 streamControllerStatus playNextChannel();
 
-/*Function for starting player stream for previous channel.*/
+/*Function for zapping to previous channel, merged like playNextChannel.*/
 streamControllerStatus playPreviousChannel();
 
-/*Function for muting or unmuting volume.*/
-streamControllerStatus volumeMute();
-
-/*Function for increasing volume.*/
-streamControllerStatus volumeUp();
-
-/*Function for decreasing volume.*/
-streamControllerStatus volumeDown();
-
 /*Function for calling functions for drawing and showing channel information banner.*/
 streamControllerStatus showChannelInfo();
 
-/*Function for calling functions for drawing and showing channel volume banner.*/
-streamControllerStatus showVolumeInfo();
-
 /*Function for calling functions for drawing and showing input channel number value.*/
 streamControllerStatus showChannelNumber(uint16_t channelNumberValue);
 
@@ -2,36 +2,49 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+/* helper keywords needed only for tables parser module */
+#define PSI_HEADER_SIZE 8 // table_id up to and including last_section_number
+#define PAT_PROGRAM_SIZE 4
+#define PMT_HEADER_SIZE 12
+#define PMT_STREAM_HEADER_SIZE 5
+#define EIT_HEADER_SIZE 14
+#define EIT_EVENT_HEADER_SIZE 12
+#define CRC_SIZE 4
+#define MJD_UNIX_EPOCH 40587 // Modified Julian Date of 1970-01-01
+
+/* helper functions needed only for tables parser module */
+static uint32_t bcdToSeconds(uint8_t *bcd);
+static void copyDvbText(char *destination, const uint8_t *source, uint8_t length);
 
 tablesParserStatus parsePAT(uint8_t *buffer, patTable *pat)
 {
-    pat->patHeader.tableId = (uint8_t)*buffer;
-
-    pat->patHeader.sectionSyntaxIndicator = (uint8_t)(*(buffer + 1) >> 7) & 0x01;
-
-    pat->patHeader.sectionLength = (uint16_t)((*(buffer + 1) << 8) + *(buffer + 2)) & 0x0FFF;
-
-    pat->patHeader.transportStreamId = (uint16_t)(*(buffer + 3) << 8) + *(buffer + 4);
-
-    pat->patHeader.versionNumber = (uint8_t)(*(buffer + 5) >> 1) & 0x001F;
+    patView view;
+    int i;
 
-    pat->patHeader.currentNextIndicator = (uint8_t)(*(buffer + 5) >> 7) & 0x01;
+    pat->programInformation = NULL;
+    pat->sectionCount = 0;
+    pat->programCount = 0;
 
-    pat->patHeader.sectionNumber = (uint8_t) * (buffer + 6);
+    if (patViewInit(&view, buffer) != TABLES_PARSER_NO_ERROR)
+    {
+        return TABLES_PARSER_ERROR;
+    }
 
-    pat->patHeader.lastSectionNumber = (uint8_t) * (buffer + 7);
-
-    pat->programCount = 0;
-    pat->sectionCount = (uint8_t)(pat->patHeader.sectionLength - 9) / 4;
+    pat->patHeader = view.header;
+    pat->sectionCount = (uint8_t)view.programCount;
 
     pat->programInformation = (patTableProgramInformation *)malloc(pat->sectionCount * sizeof(patTableProgramInformation));
-
-    int i;
+    if (!pat->programInformation)
+    {
+        pat->sectionCount = 0;
+        return TABLES_PARSER_ERROR;
+    }
 
     for (i = 0; i < pat->sectionCount; i++)
     {
-        pat->programInformation[i].programNumber = (uint16_t)(*(buffer + 8 + i * 4) << 8) + *(buffer + 9 + i * 4);
-        pat->programInformation[i].programMapPid = (uint16_t)((*(buffer + 10 + i * 4) << 8) + *(buffer + 11 + i * 4)) & 0x1FFF;
+        patViewProgram(&view, i, &pat->programInformation[i]);
 
         if (pat->programInformation[i].programNumber)
         {
@@ -39,69 +52,266 @@ tablesParserStatus parsePAT(uint8_t *buffer, patTable *pat)
         }
     }
 
-    
-
     return TABLES_PARSER_NO_ERROR;
 }
 
 tablesParserStatus parsePMT(uint8_t *buffer, pmtTable *pmt)
 {
-    pmt->pmtHeader.tableId = (uint8_t)*buffer;
+    pmtView view;
+    pmtStreamIterator iterator;
+    pmtStreamView stream;
+    char subtitles[PMT_SUBTITLES_MAX * SUBTITLE_CHARACTERS_COUNT + 1] = "";
+    int i = 0;
 
-    pmt->pmtHeader.sectionSyntaxIndicator = (uint8_t)(*(buffer + 1) >> 7) & 0x01;
+    pmt->elementaryInformation = NULL;
+    pmt->elementaryInformationCount = 0;
+    pmt->subtitleCount = 0;
+    pmt->subtitles = NULL;
 
-    pmt->pmtHeader.sectionLength = (uint16_t)(((*(buffer + 1) << 8) + *(buffer + 2)) & 0x0FFF);
+    if (pmtViewInit(&view, buffer) != TABLES_PARSER_NO_ERROR)
+    {
+        return TABLES_PARSER_ERROR;
+    }
 
-    pmt->pmtHeader.programNumber = (uint16_t)(*(buffer + 3) << 8) + *(buffer + 4);
+    pmt->pmtHeader = view.header;
 
-    pmt->pmtHeader.versionNumber = (uint8_t)(*(buffer + 5) >> 1) & 0x001F;
+    /* stream entries have variable length, so they are counted before allocation */
+    pmtViewStreams(&view, &iterator);
+    while (pmtStreamNext(&iterator, &stream))
+    {
+        pmt->elementaryInformationCount++;
+    }
 
-    pmt->pmtHeader.currentNextIndicator = (uint8_t)(*(buffer + 5) >> 7) & 0x01;
+    pmt->elementaryInformation = (pmtTableElementaryInformation *)malloc(pmt->elementaryInformationCount * sizeof(pmtTableElementaryInformation));
+    if (!pmt->elementaryInformation)
+    {
+        pmt->elementaryInformationCount = 0;
+        return TABLES_PARSER_ERROR;
+    }
 
-    pmt->pmtHeader.sectionNumber = (uint8_t) * (buffer + 6);
+    pmtViewStreams(&view, &iterator);
+    while (pmtStreamNext(&iterator, &stream))
+    {
+        pmt->elementaryInformation[i].streamType = stream.streamType;
+        pmt->elementaryInformation[i].elementaryPid = stream.elementaryPid;
+        pmt->elementaryInformation[i].esInfoLength = stream.esInfoLength;
+        i++;
 
-    pmt->pmtHeader.lastSectionNumber = (uint8_t) * (buffer + 7);
+        pmt->subtitleCount += pmtStreamSubtitles(&stream, subtitles, pmt->subtitleCount, PMT_SUBTITLES_MAX);
+    }
 
-    pmt->pmtHeader.pcrPid = (uint16_t)((*(buffer + 8) << 8) + *(buffer + 9)) & 0x1FFF;
+    if (pmt->subtitleCount)
+    {
+        pmt->subtitles = strdup(subtitles);
+    }
 
-    pmt->pmtHeader.programInfoLength = (uint16_t)((*(buffer + 10) << 8) + *(buffer + 11)) & 0x0FFF;
+    return TABLES_PARSER_NO_ERROR;
+}
 
-    pmt->elementaryInformationCount = (uint8_t)(pmt->pmtHeader.sectionLength - 13) / 5;
-    pmt->elementaryInformation = (pmtTableElementaryInformation *)malloc(pmt->elementaryInformationCount * sizeof(pmtTableElementaryInformation));
+tablesParserStatus patViewInit(patView *view, const uint8_t *buffer)
+{
+    view->buffer = buffer;
+
+    view->header.tableId = *buffer;
+    view->header.sectionSyntaxIndicator = (*(buffer + 1) >> 7) & 0x01;
+    view->header.sectionLength = (uint16_t)((*(buffer + 1) << 8) + *(buffer + 2)) & 0x0FFF;
+    view->header.transportStreamId = (uint16_t)(*(buffer + 3) << 8) + *(buffer + 4);
+    view->header.versionNumber = (*(buffer + 5) >> 1) & 0x1F;
+    view->header.currentNextIndicator = *(buffer + 5) & 0x01;
+    view->header.sectionNumber = *(buffer + 6);
+    view->header.lastSectionNumber = *(buffer + 7);
+
+    if (view->header.sectionLength < PSI_HEADER_SIZE - 3 + CRC_SIZE)
+    {
+        view->programCount = 0;
+        return TABLES_PARSER_ERROR;
+    }
 
-    pmt->subtitleCount = 0;
-    pmt->subtitles = NULL;
+    view->programCount = (view->header.sectionLength - (PSI_HEADER_SIZE - 3) - CRC_SIZE) / PAT_PROGRAM_SIZE;
 
-    int offset = 0;
-    int i;
-    int j;
+    return TABLES_PARSER_NO_ERROR;
+}
 
-    for (i = 0; i < pmt->elementaryInformationCount; i++)
+void patViewProgram(const patView *view, uint16_t index, patTableProgramInformation *program)
+{
+    const uint8_t *entry = view->buffer + PSI_HEADER_SIZE + index * PAT_PROGRAM_SIZE;
+
+    program->programNumber = (uint16_t)(*entry << 8) + *(entry + 1);
+    program->programMapPid = (uint16_t)((*(entry + 2) << 8) + *(entry + 3)) & 0x1FFF;
+}
+
+tablesParserStatus pmtViewInit(pmtView *view, const uint8_t *buffer)
+{
+    const uint8_t *sectionEnd;
+
+    view->buffer = buffer;
+
+    view->header.tableId = *buffer;
+    view->header.sectionSyntaxIndicator = (*(buffer + 1) >> 7) & 0x01;
+    view->header.sectionLength = (uint16_t)((*(buffer + 1) << 8) + *(buffer + 2)) & 0x0FFF;
+    view->header.programNumber = (uint16_t)(*(buffer + 3) << 8) + *(buffer + 4);
+    view->header.versionNumber = (*(buffer + 5) >> 1) & 0x1F;
+    view->header.currentNextIndicator = *(buffer + 5) & 0x01;
+    view->header.sectionNumber = *(buffer + 6);
+    view->header.lastSectionNumber = *(buffer + 7);
+    view->header.pcrPid = (uint16_t)((*(buffer + 8) << 8) + *(buffer + 9)) & 0x1FFF;
+    view->header.programInfoLength = (uint16_t)((*(buffer + 10) << 8) + *(buffer + 11)) & 0x0FFF;
+
+    /* section length counts bytes after length field, up to and including CRC */
+    sectionEnd = buffer + 3 + view->header.sectionLength - CRC_SIZE;
+
+    view->programInfo = buffer + PMT_HEADER_SIZE;
+    view->streamLoop = view->programInfo + view->header.programInfoLength;
+    view->streamLoopEnd = sectionEnd;
+
+    if (view->header.sectionLength < PMT_HEADER_SIZE - 3 + CRC_SIZE || view->streamLoop > sectionEnd)
     {
-        pmt->elementaryInformation[i].streamType = (uint8_t) * (buffer + 12 + i * 5 + offset);
-        pmt->elementaryInformation[i].elementaryPid = (uint16_t)((*(buffer + 13 + i * 5 + offset) << 8) + *(buffer + 14 + i * 5 + offset)) & 0x1FFF;
-        pmt->elementaryInformation[i].esInfoLength = (uint16_t)((*(buffer + 15 + i * 5 + offset) << 8) + *(buffer + 16 + i * 5 + offset)) & 0x0FFF;
+        view->streamLoop = view->streamLoopEnd = view->programInfo;
+        return TABLES_PARSER_ERROR;
+    }
 
-        if (((uint8_t) * (buffer + 17 + i * 5 + offset)) == SUBTITLING_DESCRIPTOR_TAG)
-        {
+    return TABLES_PARSER_NO_ERROR;
+}
+
+void pmtViewStreams(const pmtView *view, pmtStreamIterator *iterator)
+{
+    iterator->position = view->streamLoop;
+    iterator->end = view->streamLoopEnd;
+}
 
-            pmt->subtitleCount = ((uint8_t) * (buffer + 18 + i * 5 + offset)) / 8;
+uint8_t pmtStreamNext(pmtStreamIterator *iterator, pmtStreamView *stream)
+{
+    const uint8_t *entry = iterator->position;
 
-            pmt->subtitles = (char *)malloc(sizeof(char) * pmt->subtitleCount * SUBTITLE_CHARACTERS_COUNT + 1);
+    if (entry + PMT_STREAM_HEADER_SIZE > iterator->end)
+    {
+        return 0;
+    }
 
-            for (j = 0; j < pmt->subtitleCount; j++)
-            {
-                pmt->subtitles[j * SUBTITLE_CHARACTERS_COUNT] = (uint8_t) * (buffer + 19 + i * 5 + offset);
-                pmt->subtitles[j * SUBTITLE_CHARACTERS_COUNT + 1] = (uint8_t) * (buffer + 20 + i * 5 + offset);
-                pmt->subtitles[j * SUBTITLE_CHARACTERS_COUNT + 2] = (uint8_t) * (buffer + 21 + i * 5 + offset);
-                pmt->subtitles[j * SUBTITLE_CHARACTERS_COUNT + 3] = '\0';
-            }
-        }
+    stream->streamType = *entry;
+    stream->elementaryPid = (uint16_t)((*(entry + 1) << 8) + *(entry + 2)) & 0x1FFF;
+    stream->esInfoLength = (uint16_t)((*(entry + 3) << 8) + *(entry + 4)) & 0x0FFF;
+    stream->esInfo = entry + PMT_STREAM_HEADER_SIZE;
+
+    if (stream->esInfo + stream->esInfoLength > iterator->end)
+    {
+        iterator->position = iterator->end;
+        return 0;
+    }
+
+    iterator->position = stream->esInfo + stream->esInfoLength;
+    return 1;
+}
+
+uint8_t pmtStreamSubtitles(const pmtStreamView *stream, char *languages, uint8_t languageCount, uint8_t maxLanguages)
+{
+    descriptorIterator iterator;
+    descriptor esDescriptor;
+    uint8_t appended = 0;
 
-        offset += pmt->elementaryInformation[i].esInfoLength;
+    /* subtitling descriptor may be anywhere in ES info loop */
+    descriptorIteratorInit(&iterator, stream->esInfo, stream->esInfoLength);
+    while (descriptorNext(&iterator, &esDescriptor))
+    {
+        appended += descriptorSubtitles(&esDescriptor, languages, languageCount + appended, maxLanguages);
     }
 
-    //printPMT(pmt);
+    return appended;
+}
+
+uint8_t descriptorSubtitles(const descriptor *esDescriptor, char *languages, uint8_t languageCount, uint8_t maxLanguages)
+{
+    subtitlingEntry entry;
+    uint8_t appended = 0;
+    uint8_t i;
+
+    if (esDescriptor->tag != SUBTITLING_DESCRIPTOR_TAG || !esDescriptor->decoded)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < esDescriptor->typed.subtitling.subtitleCount && languageCount + appended < maxLanguages; i++)
+    {
+        subtitlingDescriptorEntry(&esDescriptor->typed.subtitling, i, &entry);
+        memcpy(languages + (languageCount + appended) * SUBTITLE_CHARACTERS_COUNT, entry.language, SUBTITLE_CHARACTERS_COUNT);
+        appended++;
+        languages[(languageCount + appended) * SUBTITLE_CHARACTERS_COUNT] = '\0';
+    }
+
+    return appended;
+}
+
+tablesParserStatus parseEIT(uint8_t *buffer, eitTable *eit)
+{
+    eit->eitHeader.tableId = (uint8_t)*buffer;
+
+    eit->eitHeader.sectionSyntaxIndicator = (uint8_t)(*(buffer + 1) >> 7) & 0x01;
+
+    eit->eitHeader.sectionLength = (uint16_t)(((*(buffer + 1) << 8) + *(buffer + 2)) & 0x0FFF);
+
+    eit->eitHeader.serviceId = (uint16_t)(*(buffer + 3) << 8) + *(buffer + 4);
+
+    eit->eitHeader.versionNumber = (uint8_t)(*(buffer + 5) >> 1) & 0x001F;
+
+    eit->eitHeader.currentNextIndicator = (uint8_t) * (buffer + 5) & 0x01;
+
+    eit->eitHeader.sectionNumber = (uint8_t) * (buffer + 6);
+
+    eit->eitHeader.lastSectionNumber = (uint8_t) * (buffer + 7);
+
+    eit->eitHeader.transportStreamId = (uint16_t)(*(buffer + 8) << 8) + *(buffer + 9);
+
+    eit->eitHeader.originalNetworkId = (uint16_t)(*(buffer + 10) << 8) + *(buffer + 11);
+
+    eit->eitHeader.segmentLastSectionNumber = (uint8_t) * (buffer + 12);
+
+    eit->eitHeader.lastTableId = (uint8_t) * (buffer + 13);
+
+    eit->eventCount = 0;
+    eit->event.eventName[0] = '\0';
+    eit->event.eventDescription[0] = '\0';
+
+    /* section length counts bytes after length field, up to and including CRC */
+    uint8_t *sectionEnd = buffer + 3 + eit->eitHeader.sectionLength - CRC_SIZE;
+    uint8_t *event = buffer + EIT_HEADER_SIZE;
+
+    if (eit->eitHeader.sectionLength < EIT_HEADER_SIZE - 3 + CRC_SIZE)
+    {
+        return TABLES_PARSER_ERROR;
+    }
+
+    if (event + EIT_EVENT_HEADER_SIZE > sectionEnd)
+    {
+        /* empty present or following section */
+        return TABLES_PARSER_NO_ERROR;
+    }
+
+    uint16_t mjd = (uint16_t)(*(event + 2) << 8) + *(event + 3);
+    uint16_t descriptorsLoopLength = (uint16_t)((*(event + 10) << 8) + *(event + 11)) & 0x0FFF;
+
+    eit->event.eventId = (uint16_t)(*event << 8) + *(event + 1);
+    eit->event.startTime = (uint32_t)(mjd - MJD_UNIX_EPOCH) * 86400 + bcdToSeconds(event + 4);
+    eit->event.duration = bcdToSeconds(event + 7);
+    eit->event.runningStatus = (uint8_t)(*(event + 10) >> 5) & 0x07;
+    eit->eventCount = 1;
+
+    descriptorIterator iterator;
+    descriptor eventDescriptor;
+
+    if (event + EIT_EVENT_HEADER_SIZE + descriptorsLoopLength > sectionEnd)
+    {
+        return TABLES_PARSER_ERROR;
+    }
+
+    descriptorIteratorInit(&iterator, event + EIT_EVENT_HEADER_SIZE, descriptorsLoopLength);
+    while (descriptorNext(&iterator, &eventDescriptor))
+    {
+        if (eventDescriptor.tag == SHORT_EVENT_DESCRIPTOR_TAG && eventDescriptor.decoded)
+        {
+            copyDvbText(eit->event.eventName, eventDescriptor.typed.shortEvent.eventName, eventDescriptor.typed.shortEvent.eventNameLength);
+            copyDvbText(eit->event.eventDescription, eventDescriptor.typed.shortEvent.text, eventDescriptor.typed.shortEvent.textLength);
+        }
+    }
 
     return TABLES_PARSER_NO_ERROR;
 }
@@ -182,3 +392,55 @@ tablesParserStatus printPMT(pmtTable *pmt)
 
     return TABLES_PARSER_NO_ERROR;
 }
+
+tablesParserStatus printEIT(eitTable *eit)
+{
+    printf("\nEIT TABLE\n");
+    printf("\tTable ID (hex): %#04x\n", eit->eitHeader.tableId);
+    printf("\tSection length: %d\n", eit->eitHeader.sectionLength);
+    printf("\tService id: %d\n", eit->eitHeader.serviceId);
+    printf("\tVersion number: %d\n", eit->eitHeader.versionNumber);
+    printf("\tSection number: %d\n", eit->eitHeader.sectionNumber);
+    printf("\tTransport stream id: %d\n", eit->eitHeader.transportStreamId);
+    printf("\tOriginal network id: %d\n", eit->eitHeader.originalNetworkId);
+    if (eit->eventCount)
+    {
+        printf("\tEvent id: %d\n", eit->event.eventId);
+        printf("\tStart time: %u\n", eit->event.startTime);
+        printf("\tDuration: %u\n", eit->event.duration);
+        printf("\tRunning status: %d\n", eit->event.runningStatus);
+        printf("\tName: %s\n", eit->event.eventName);
+        printf("\tDescription: %s\n", eit->event.eventDescription);
+    }
+
+    return TABLES_PARSER_NO_ERROR;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for converting 24 bit BCD coded hhmmss field to seconds.*/
+static uint32_t bcdToSeconds(uint8_t *bcd)
+{
+    uint32_t hours = (*bcd >> 4) * 10 + (*bcd & 0x0F);
+    uint32_t minutes = (*(bcd + 1) >> 4) * 10 + (*(bcd + 1) & 0x0F);
+    uint32_t seconds = (*(bcd + 2) >> 4) * 10 + (*(bcd + 2) & 0x0F);
+
+    return hours * 3600 + minutes * 60 + seconds;
+}
+
+/*Function for copying DVB text to null terminated string, leading character table selector is skipped.*/
+static void copyDvbText(char *destination, const uint8_t *source, uint8_t length)
+{
+    if (length && *source < 0x20)
+    {
+        /* 0x10 selector is followed by two more bytes of table id */
+        uint8_t selectorLength = (*source == 0x10) ? 3 : 1;
+
+        selectorLength = selectorLength > length ? length : selectorLength;
+        source += selectorLength;
+        length -= selectorLength;
+    }
+
+    memcpy(destination, source, length);
+    destination[length] = '\0';
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
@@ -1,11 +1,11 @@
 #ifndef _TABLES_PARSER_H_
 #define _TABLES_PARSER_H_
 
-#include <stdint.h>
+#include "descriptor_parser.h"
 
-#define SUBTITLING_DESCRIPTOR_TAG 0x59
-#define SHORT_EVENT_DESCRIPTOR_TAG 0x4D
-#define SUBTITLE_CHARACTERS_COUNT 3
+#define SUBTITLE_CHARACTERS_COUNT ISO_639_CODE_SIZE
+#define EIT_TEXT_MAX 255 // short event descriptor name and text length fields are 8 bit
+#define PMT_SUBTITLES_MAX 32 // subtitle languages collected from all streams of one PMT
 
 typedef enum _tablesParserStatus
 {
@@ -74,18 +74,130 @@ typedef struct _pmtTable
 } pmtTable;
 /* ---- PMT table ---- */
 
+/* ---- EIT table ---- */
+typedef struct _eitTableHeader
+{
+    uint8_t tableId;
+    uint8_t sectionSyntaxIndicator;
+    uint16_t sectionLength;
+    uint16_t serviceId;
+    uint8_t versionNumber;
+    uint8_t currentNextIndicator;
+    uint8_t sectionNumber;
+    uint8_t lastSectionNumber;
+    uint16_t transportStreamId;
+    uint16_t originalNetworkId;
+    uint8_t segmentLastSectionNumber;
+    uint8_t lastTableId;
+} eitTableHeader;
+
+typedef struct _eitTableEvent
+{
+    uint16_t eventId;
+    uint32_t startTime; // UTC, seconds since 1970-01-01
+    uint32_t duration;  // seconds
+    uint8_t runningStatus;
+    char eventName[EIT_TEXT_MAX + 1];
+    char eventDescription[EIT_TEXT_MAX + 1];
+} eitTableEvent;
+
+typedef struct _eitTable
+{
+    eitTableHeader eitHeader;
+    eitTableEvent event; // present/following sections carry at most one event
+    uint8_t eventCount;
+} eitTable;
+/* ---- EIT table ---- */
+
+/* ---- Section views ---- */
+/* views point into the section buffer and are valid only as long as it is, nothing is allocated */
+typedef struct _patView
+{
+    const uint8_t *buffer;
+    patTableHeader header;
+    uint16_t programCount; // entries in program loop, network PID entry included
+} patView;
 
-/*Function for parsing PAT table from transport stream.*/
+typedef struct _pmtView
+{
+    const uint8_t *buffer;
+    pmtTableHeader header;
+    const uint8_t *programInfo; // program descriptors, header.programInfoLength bytes
+    const uint8_t *streamLoop;
+    const uint8_t *streamLoopEnd;
+} pmtView;
+
+typedef struct _pmtStreamView
+{
+    uint8_t streamType;
+    uint16_t elementaryPid;
+    uint16_t esInfoLength;
+    const uint8_t *esInfo; // stream descriptors, esInfoLength bytes
+} pmtStreamView;
+
+typedef struct _pmtStreamIterator
+{
+    const uint8_t *position;
+    const uint8_t *end;
+} pmtStreamIterator;
+/* ---- Section views ---- */
+
+/****************************************************************************
+ * @brief    Function for decoding PAT header and checking section bounds
+ *           without copying or allocating anything.
+ *
+ * @param    view - [out] PAT view over buffer.
+ *           buffer - [in] Complete PAT section starting with table_id.
+ *
+ * @return   TABLES_PARSER_NO_ERROR, if section is usable.
+ *           TABLES_PARSER_ERROR, if section length is inconsistent.
+****************************************************************************/
+tablesParserStatus patViewInit(patView *view, const uint8_t *buffer);
+
+/*Function for reading program loop entry at index (0 <= index < view->programCount).*/
+void patViewProgram(const patView *view, uint16_t index, patTableProgramInformation *program);
+
+/****************************************************************************
+ * @brief    Function for decoding PMT header and locating elementary stream
+ *           loop without copying or allocating anything.
+ *
+ * @param    view - [out] PMT view over buffer.
+ *           buffer - [in] Complete PMT section starting with table_id.
+ *
+ * @return   TABLES_PARSER_NO_ERROR, if section is usable.
+ *           TABLES_PARSER_ERROR, if section or program info length is inconsistent.
+****************************************************************************/
+tablesParserStatus pmtViewInit(pmtView *view, const uint8_t *buffer);
+
+/*Function for positioning iterator at first elementary stream of PMT view.*/
+void pmtViewStreams(const pmtView *view, pmtStreamIterator *iterator);
+
+/*Function for reading next elementary stream, returns 0 when loop is exhausted or truncated.*/
+uint8_t pmtStreamNext(pmtStreamIterator *iterator, pmtStreamView *stream);
+
+/*Function for appending subtitle languages of stream to null terminated languages string, returns number of languages appended.*/
+uint8_t pmtStreamSubtitles(const pmtStreamView *stream, char *languages, uint8_t languageCount, uint8_t maxLanguages);
+
+/*Function for appending subtitle languages of one ES descriptor, for callers walking descriptors themselves. Returns 0 for other descriptors.*/
+uint8_t descriptorSubtitles(const descriptor *esDescriptor, char *languages, uint8_t languageCount, uint8_t maxLanguages);
+
+/*Function for parsing PAT table from transport stream. Built from patView, program array is allocated and owned by caller.*/
 tablesParserStatus parsePAT(uint8_t *buffer, patTable *pat);
 
-/*Function for parsing PMT table from transport stream.*/
+/*Function for parsing PMT table from transport stream. Built from pmtView, elementary and subtitle arrays are allocated and owned by caller.*/
 tablesParserStatus parsePMT(uint8_t *buffer, pmtTable *pmt);
 
+/*Function for parsing EIT present/following table section from transport stream.*/
+tablesParserStatus parseEIT(uint8_t *buffer, eitTable *eit);
+
 /*Function for printing PAT table variables values.*/
 tablesParserStatus printPAT(patTable *pat);
 
 /*Function for printing PMT table variables values.*/
 tablesParserStatus printPMT(pmtTable *pmt);
 
+/*Function for printing EIT table variables values.*/
+tablesParserStatus printEIT(eitTable *eit);
+
 
 #endif // _TABLES_PARSER_H_
@@ -0,0 +1,238 @@
+/**
+ * @file tables_parser_benchmark.c
+ *
+ * @brief Microbenchmark comparing allocating PAT/PMT parsers with zero-copy section views.
+ *
+ * Usage: tables_parser_benchmark
+ * Sections are generated with typical layout of a DVB-T multiplex (32 programs,
+ * PMT with video, audio, second audio and subtitle stream).
+ */
+
+#include "tables_parser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* helper keywords needed only for benchmark */
+#define BENCHMARK_SECTIONS 1000000
+#define BENCHMARK_ROUNDS 5
+#define BENCHMARK_PROGRAMS 32
+#define SECTION_BUFFER_SIZE 1024
+
+typedef uint32_t (*parseFunction)(uint8_t *section);
+
+/* helper functions needed only for benchmark */
+static uint16_t generatePAT(uint8_t *section);
+static uint16_t generatePMT(uint8_t *section);
+static void finishSection(uint8_t *section, uint16_t size);
+static uint32_t parsePATAllocating(uint8_t *section);
+static uint32_t parsePATView(uint8_t *section);
+static uint32_t parsePMTAllocating(uint8_t *section);
+static uint32_t parsePMTView(uint8_t *section);
+static double runParser(parseFunction parse, uint8_t *section, uint32_t *checksum);
+
+int main()
+{
+    uint8_t pat[SECTION_BUFFER_SIZE];
+    uint8_t pmt[SECTION_BUFFER_SIZE];
+    uint32_t allocatingChecksum;
+    uint32_t viewChecksum;
+    double allocatingSeconds;
+    double viewSeconds;
+    uint8_t failed = 0;
+
+    generatePAT(pat);
+    generatePMT(pmt);
+
+    printf("sections per round: %d, best of %d rounds\n", BENCHMARK_SECTIONS, BENCHMARK_ROUNDS);
+
+    allocatingSeconds = runParser(parsePATAllocating, pat, &allocatingChecksum);
+    viewSeconds = runParser(parsePATView, pat, &viewChecksum);
+    printf("PAT parsePAT:     %10.2f Msections/s\n", BENCHMARK_SECTIONS / allocatingSeconds / 1e6);
+    printf("PAT patView:      %10.2f Msections/s (%.2fx)\n", BENCHMARK_SECTIONS / viewSeconds / 1e6, allocatingSeconds / viewSeconds);
+    failed |= allocatingChecksum != viewChecksum;
+
+    allocatingSeconds = runParser(parsePMTAllocating, pmt, &allocatingChecksum);
+    viewSeconds = runParser(parsePMTView, pmt, &viewChecksum);
+    printf("PMT parsePMT:     %10.2f Msections/s\n", BENCHMARK_SECTIONS / allocatingSeconds / 1e6);
+    printf("PMT pmtView:      %10.2f Msections/s (%.2fx)\n", BENCHMARK_SECTIONS / viewSeconds / 1e6, allocatingSeconds / viewSeconds);
+    failed |= allocatingChecksum != viewChecksum;
+
+    if (failed)
+    {
+        printf("Results of allocating and view parsers differ!\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for generating PAT with network entry and BENCHMARK_PROGRAMS programs.*/
+static uint16_t generatePAT(uint8_t *section)
+{
+    uint16_t size = 8;
+    uint16_t i;
+
+    for (i = 0; i <= BENCHMARK_PROGRAMS; i++)
+    {
+        uint16_t pid = i ? 0x0100 + i * 0x10 : 0x0010;
+
+        section[size++] = i >> 8;
+        section[size++] = i & 0xFF;
+        section[size++] = 0xE0 | (pid >> 8);
+        section[size++] = pid & 0xFF;
+    }
+
+    section[0] = 0x00;
+    section[3] = 0x00;
+    section[4] = 0x01;
+    finishSection(section, size);
+
+    return size;
+}
+
+/*Function for generating PMT with program descriptor and four streams, last one carrying two subtitle languages.*/
+static uint16_t generatePMT(uint8_t *section)
+{
+    static const uint8_t body[] = {
+        0xE1, 0x00, 0xF0, 0x06, 0x09, 0x04, 0x0B, 0x00, 0xE1, 0xF0,                         // PCR PID, CA descriptor
+        0x02, 0xE1, 0x00, 0xF0, 0x03, 0x52, 0x01, 0x01,                                     // MPEG-2 video, stream identifier
+        0x03, 0xE1, 0x01, 0xF0, 0x06, 0x0A, 0x04, 'e', 'n', 'g', 0x00,                      // MPEG audio, ISO 639 language
+        0x03, 0xE1, 0x02, 0xF0, 0x06, 0x0A, 0x04, 's', 'r', 'p', 0x00,                      // MPEG audio, ISO 639 language
+        0x06, 0xE1, 0x03, 0xF0, 0x12, 0x59, 0x10, 'e', 'n', 'g', 0x10, 0x00, 0x01, 0x00, 0x01, // private data, subtitling
+        's', 'r', 'p', 0x10, 0x00, 0x02, 0x00, 0x02};
+    uint16_t size = 8 + sizeof(body);
+
+    memcpy(section + 8, body, sizeof(body));
+    section[0] = 0x02;
+    section[3] = 0x00;
+    section[4] = 0x01;
+    finishSection(section, size);
+
+    return size;
+}
+
+/*Function for filling section length and common header fields, CRC field is left zero since parsers do not check it.*/
+static void finishSection(uint8_t *section, uint16_t size)
+{
+    uint16_t sectionLength = size + 4 - 3;
+
+    section[1] = 0xB0 | (sectionLength >> 8);
+    section[2] = sectionLength & 0xFF;
+    section[5] = 0xC1;
+    section[6] = 0x00;
+    section[7] = 0x00;
+    memset(section + size, 0, 4);
+}
+
+/*Function for parsing PAT into allocated tables the way callbacks used to.*/
+static uint32_t parsePATAllocating(uint8_t *section)
+{
+    patTable pat;
+    uint32_t sum = 0;
+    int32_t i;
+
+    parsePAT(section, &pat);
+    for (i = 0; i < pat.sectionCount; i++)
+    {
+        sum += pat.programInformation[i].programNumber + pat.programInformation[i].programMapPid;
+    }
+    free(pat.programInformation);
+
+    return sum;
+}
+
+/*Function for walking PAT program loop in place.*/
+static uint32_t parsePATView(uint8_t *section)
+{
+    patView pat;
+    patTableProgramInformation program;
+    uint32_t sum = 0;
+    int32_t i;
+
+    patViewInit(&pat, section);
+    for (i = 0; i < pat.programCount; i++)
+    {
+        patViewProgram(&pat, i, &program);
+        sum += program.programNumber + program.programMapPid;
+    }
+
+    return sum;
+}
+
+/*Function for parsing PMT into allocated tables the way callbacks used to.*/
+static uint32_t parsePMTAllocating(uint8_t *section)
+{
+    pmtTable pmt;
+    uint32_t sum = 0;
+    int32_t i;
+
+    parsePMT(section, &pmt);
+    for (i = 0; i < pmt.elementaryInformationCount; i++)
+    {
+        sum += pmt.elementaryInformation[i].streamType + pmt.elementaryInformation[i].elementaryPid;
+    }
+    sum += pmt.subtitleCount ? pmt.subtitleCount + pmt.subtitles[3] : 0;
+    free(pmt.elementaryInformation);
+    free(pmt.subtitles);
+
+    return sum;
+}
+
+/*Function for walking PMT stream loop in place.*/
+static uint32_t parsePMTView(uint8_t *section)
+{
+    pmtView pmt;
+    pmtStreamIterator iterator;
+    pmtStreamView stream;
+    char subtitles[PMT_SUBTITLES_MAX * SUBTITLE_CHARACTERS_COUNT + 1];
+    uint8_t subtitleCount = 0;
+    uint32_t sum = 0;
+
+    pmtViewInit(&pmt, section);
+    pmtViewStreams(&pmt, &iterator);
+    while (pmtStreamNext(&iterator, &stream))
+    {
+        sum += stream.streamType + stream.elementaryPid;
+        subtitleCount += pmtStreamSubtitles(&stream, subtitles, subtitleCount, PMT_SUBTITLES_MAX);
+    }
+    sum += subtitleCount ? subtitleCount + subtitles[3] : 0;
+
+    return sum;
+}
+
+/*Function for timing parser over BENCHMARK_SECTIONS sections, returns fastest round.*/
+static double runParser(parseFunction parse, uint8_t *section, uint32_t *checksum)
+{
+    struct timespec start;
+    struct timespec end;
+    double seconds;
+    double bestSeconds = 0;
+    int32_t round;
+    int32_t i;
+
+    for (round = 0; round < BENCHMARK_ROUNDS; round++)
+    {
+        *checksum = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < BENCHMARK_SECTIONS; i++)
+        {
+            /* consume result, so work can not be optimised away and both parsers can be compared */
+            *checksum += parse(section);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        if (round == 0 || seconds < bestSeconds)
+        {
+            bestSeconds = seconds;
+        }
+    }
+
+    return bestSeconds;
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
@@ -0,0 +1,796 @@
+/**
+ * @file tdp_sim.c
+ *
+ * @brief File-backed simulator of the Tuner Demultiplexer and Player API.
+ *
+ * Drop-in replacement for libtdp which demultiplexes a recorded MPEG-TS capture
+ * instead of talking to the STB hardware. Behaviour is configured through
+ * environment variables:
+ *
+ *   TDP_SIM_TS_FILE         - path to the .ts capture (required)
+ *   TDP_SIM_TS_FILE_<MHz>   - capture used when locked to given frequency in MHz, e.g. TDP_SIM_TS_FILE_754
+ *                             (default TDP_SIM_TS_FILE)
+ *   TDP_SIM_REALTIME        - 1 to pace packets by recorded PCR, 0 (default) to run as fast as possible
+ *   TDP_SIM_FREQUENCIES     - comma separated frequencies in MHz which carry signal, e.g. 754,818 (default all)
+ *   TDP_SIM_LOCK_DELAY_MS   - simulated tuner lock time in milliseconds (default 100)
+ *   TDP_SIM_NO_SIGNAL_MS    - time until lock failure is reported on frequency without signal (default 2000)
+ *   TDP_SIM_SIGNAL_QUALITY  - value reported by Tuner_Get_Signal_Quality on frequency with signal (default 80)
+ *   TDP_SIM_SIGNAL_DETECT_MS - time after lock request until signal quality is reported, before lock (default 5)
+ *   TDP_SIM_SIGNAL_NOISE    - signal quality drops by random amount up to given value on every read (default 0)
+ *   TDP_SIM_STREAM_SETUP_MS - simulated decoder start/stop time per Player_Stream_Create/Remove (default 0)
+ *   TDP_SIM_STALE_CALLBACKS - 1 to report status of lock request replaced by newer one, as a late callback of
+ *                             the real tuner; 0 (default) drops it
+ *
+ * The capture is looped at end of file so tables keep repeating as on air.
+ */
+
+#include "tdp_api.h"
+#include "section_assembler.h"
+#include "ts_scanner.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+/* helper keywords needed only for simulator module */
+#define SIM_MAX_FILTERS 256 // PMT filter of every program of one PAT section at once, plus PAT and EIT
+#define SIM_MAX_STREAMS 8
+#define SIM_READ_PACKETS 512
+#define SIM_REALTIME_READ_PACKETS 16 // small chunks keep PCR pacing smooth
+
+#define SIM_PLAYER_HANDLE 0x5100
+#define SIM_SOURCE_HANDLE 0x5200
+#define SIM_FILTER_HANDLE_BASE 0x5300
+#define SIM_STREAM_HANDLE_BASE 0x5400
+
+#define SIM_DEFAULT_LOCK_DELAY_MS 100
+#define SIM_DEFAULT_SIGNAL_QUALITY 80
+#define SIM_DEFAULT_NO_SIGNAL_MS 2000
+#define SIM_DEFAULT_SIGNAL_DETECT_MS 5
+#define SIM_ENV_NAME_SIZE 64
+#define PCR_CLOCK_HZ 27000000ULL
+
+typedef struct _simFilter
+{
+    uint8_t used;
+    uint32_t pid;
+    uint32_t tableId;
+    uint32_t handle;
+    uint32_t generation; // incremented whenever slot is set, assembler of older filter is reinitialized
+
+    /* owned by feeder thread */
+    sectionAssembler assembler;
+    uint32_t assemblerGeneration;
+} simFilter;
+
+typedef struct _simStream
+{
+    uint8_t used;
+    uint32_t pid;
+    tStreamType type;
+} simStream;
+
+/* helper variables needed only for simulator module */
+static pthread_mutex_t simMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static Tuner_Status_Callback statusCallback;
+static Demux_Section_Filter_Callback sectionCallback;
+
+static uint8_t tunerInitialized;
+static uint8_t tunerLocked;
+static uint32_t lockFrequency; // Hz, of newest lock request
+static uint32_t lockRequests;  // lock thread of older request does not report lock
+static uint32_t noiseSeed = 1; // rand_r state of signal quality noise
+static uint8_t lockSignal;     // frequency of newest lock request carries signal
+static struct timespec lockRequestTime;
+static uint8_t playerInitialized;
+static uint8_t sourceOpened;
+static uint32_t currentVolume;
+
+static simFilter filters[SIM_MAX_FILTERS];
+static simStream streams[SIM_MAX_STREAMS];
+
+static pthread_t feederThread;
+static uint8_t feederRunning;
+static volatile uint8_t feederStop;
+static tsScanner scanner;
+static uint8_t filtersChanged;
+
+/* copy of set filters owned by feeder thread, taken under lock whenever filters change */
+static uint32_t activeFilters[SIM_MAX_FILTERS];
+static uint32_t activeFilterPids[SIM_MAX_FILTERS];
+static uint32_t activeFilterCount;
+
+/* helper functions needed only for simulator module */
+static uint32_t getEnvValue(const char *name, uint32_t defaultValue);
+static void sleepMs(uint32_t milliseconds);
+static uint8_t hasSignal(uint32_t frequency);
+static void *lockThread(void *arg);
+static void reportStaleLock(t_LockStatus status);
+static void *feederLoop(void *arg);
+static void stopFeeder();
+static void dispatchPackets(uint8_t *buffer, uint32_t packetCount);
+static void updateActiveFilters(uint8_t restart);
+static void paceByPcr(uint8_t *buffer, uint32_t packetCount, int64_t *firstPcr, int32_t *pcrPid, struct timespec *start);
+static void deliverSection(uint8_t *section, uint16_t sectionLength, void *userData);
+static int64_t readPcr(uint8_t *packet);
+
+/* -------------------- TUNER -------------------- */
+t_Error Tuner_Init()
+{
+    pthread_mutex_lock(&simMutex);
+    tunerInitialized = 1;
+    tunerLocked = 0;
+    pthread_mutex_unlock(&simMutex);
+
+    return NO_ERROR;
+}
+
+#ifdef SATELITE
+t_Error Tuner_Lock_To_Frequency(uint32_t tuneFrequency, t_Polarization polarization, t_Band band, uint32_t symbolRate)
+#else
+t_Error Tuner_Lock_To_Frequency(uint32_t tuneFrequency, uint32_t bandwidth, t_Module modul)
+#endif
+{
+    pthread_t lockThreadHandle;
+    uint32_t request;
+
+    if (!tunerInitialized)
+    {
+        return ERROR;
+    }
+
+    /* request is counted before feeder is stopped, so lock thread of older request cannot start feeder after it */
+    pthread_mutex_lock(&simMutex);
+    tunerLocked = 0;
+    lockFrequency = tuneFrequency;
+    lockSignal = hasSignal(tuneFrequency / 1000000);
+    clock_gettime(CLOCK_MONOTONIC, &lockRequestTime);
+    request = ++lockRequests;
+    pthread_mutex_unlock(&simMutex);
+
+    stopFeeder();
+
+    /* lock is reported asynchronously from another thread, as on the real tuner */
+    if (pthread_create(&lockThreadHandle, NULL, lockThread, (void *)(uintptr_t)request))
+    {
+        return ERROR;
+    }
+    pthread_detach(lockThreadHandle);
+
+    return NO_ERROR;
+}
+
+t_Error Tuner_Register_Status_Callback(Tuner_Status_Callback tunerStatusCallback)
+{
+    pthread_mutex_lock(&simMutex);
+    statusCallback = tunerStatusCallback;
+    pthread_mutex_unlock(&simMutex);
+
+    return NO_ERROR;
+}
+
+t_Error Tuner_Unregister_Status_Callback(Tuner_Status_Callback tunerStatusCallback)
+{
+    pthread_mutex_lock(&simMutex);
+    if (statusCallback == tunerStatusCallback)
+    {
+        statusCallback = NULL;
+    }
+    pthread_mutex_unlock(&simMutex);
+
+    return NO_ERROR;
+}
+
+t_Error Tuner_Get_Signal_Quality(uint8_t *signalQuality)
+{
+    struct timespec now;
+    uint32_t elapsedMs;
+    uint32_t quality;
+    uint32_t noise = getEnvValue("TDP_SIM_SIGNAL_NOISE", 0);
+    uint8_t signal;
+
+    if (!signalQuality)
+    {
+        return ERROR;
+    }
+
+    /* signal is measurable shortly after tuning, long before demodulator locks */
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    pthread_mutex_lock(&simMutex);
+    elapsedMs = (now.tv_sec - lockRequestTime.tv_sec) * 1000 + (now.tv_nsec - lockRequestTime.tv_nsec) / 1000000;
+    signal = tunerLocked || (lockSignal && elapsedMs >= getEnvValue("TDP_SIM_SIGNAL_DETECT_MS", SIM_DEFAULT_SIGNAL_DETECT_MS));
+    noise = noise ? rand_r(&noiseSeed) % (noise + 1) : 0;
+    pthread_mutex_unlock(&simMutex);
+
+    quality = getEnvValue("TDP_SIM_SIGNAL_QUALITY", SIM_DEFAULT_SIGNAL_QUALITY);
+    *signalQuality = signal && quality > noise ? (uint8_t)(quality - noise) : 0;
+
+    return NO_ERROR;
+}
+
+t_Error Tuner_Deinit()
+{
+    /* pending lock threads neither report nor start feeder any more */
+    pthread_mutex_lock(&simMutex);
+    tunerInitialized = 0;
+    tunerLocked = 0;
+    lockRequests++;
+    pthread_mutex_unlock(&simMutex);
+
+    stopFeeder();
+
+    return NO_ERROR;
+}
+/* -------------------- TUNER -------------------- */
+
+/* -------------------- DEMUX -------------------- */
+t_Error Demux_Set_Filter(uint32_t playerHandle, uint32_t PID, uint32_t tableID, uint32_t *filterHandle)
+{
+    int32_t i;
+
+    if (playerHandle != SIM_PLAYER_HANDLE || !playerInitialized || PID >= TS_PID_COUNT || !filterHandle)
+    {
+        return ERROR;
+    }
+
+    pthread_mutex_lock(&simMutex);
+    for (i = 0; i < SIM_MAX_FILTERS; i++)
+    {
+        if (!filters[i].used)
+        {
+            filters[i].used = 1;
+            filters[i].pid = PID;
+            filters[i].tableId = tableID;
+            filters[i].handle = SIM_FILTER_HANDLE_BASE + i;
+            filters[i].generation++;
+            filtersChanged = 1;
+
+            *filterHandle = filters[i].handle;
+            pthread_mutex_unlock(&simMutex);
+            return NO_ERROR;
+        }
+    }
+    pthread_mutex_unlock(&simMutex);
+
+    return ERROR;
+}
+
+t_Error Demux_Free_Filter(uint32_t playerHandle, uint32_t filterHandle)
+{
+    uint32_t index = filterHandle - SIM_FILTER_HANDLE_BASE;
+
+    if (playerHandle != SIM_PLAYER_HANDLE || index >= SIM_MAX_FILTERS)
+    {
+        return ERROR;
+    }
+
+    pthread_mutex_lock(&simMutex);
+    if (!filters[index].used)
+    {
+        pthread_mutex_unlock(&simMutex);
+        return ERROR;
+    }
+    filters[index].used = 0;
+    filtersChanged = 1;
+    pthread_mutex_unlock(&simMutex);
+
+    return NO_ERROR;
+}
+
+t_Error Demux_Register_Section_Filter_Callback(Demux_Section_Filter_Callback demuxSectionFilterCallback)
+{
+    pthread_mutex_lock(&simMutex);
+    sectionCallback = demuxSectionFilterCallback;
+    pthread_mutex_unlock(&simMutex);
+
+    return NO_ERROR;
+}
+
+t_Error Demux_Unregister_Section_Filter_Callback(Demux_Section_Filter_Callback demuxSectionFilterCallback)
+{
+    pthread_mutex_lock(&simMutex);
+    if (sectionCallback == demuxSectionFilterCallback)
+    {
+        sectionCallback = NULL;
+    }
+    pthread_mutex_unlock(&simMutex);
+
+    return NO_ERROR;
+}
+/* -------------------- DEMUX -------------------- */
+
+/* -------------------- PLAYER -------------------- */
+t_Error Player_Init(uint32_t *playerHandle)
+{
+    if (!playerHandle)
+    {
+        return ERROR;
+    }
+
+    pthread_mutex_lock(&simMutex);
+    playerInitialized = 1;
+    currentVolume = 0;
+    memset(streams, 0, sizeof(streams));
+    pthread_mutex_unlock(&simMutex);
+
+    *playerHandle = SIM_PLAYER_HANDLE;
+    return NO_ERROR;
+}
+
+t_Error Player_Deinit(uint32_t playerHandle)
+{
+    if (playerHandle != SIM_PLAYER_HANDLE || !playerInitialized)
+    {
+        return ERROR;
+    }
+
+    pthread_mutex_lock(&simMutex);
+    playerInitialized = 0;
+    memset(filters, 0, sizeof(filters));
+    filtersChanged = 1;
+    pthread_mutex_unlock(&simMutex);
+
+    return NO_ERROR;
+}
+
+t_Error Player_Source_Open(uint32_t playerHandle, uint32_t *sourceHandle)
+{
+    if (playerHandle != SIM_PLAYER_HANDLE || !playerInitialized || !sourceHandle)
+    {
+        return ERROR;
+    }
+
+    sourceOpened = 1;
+    *sourceHandle = SIM_SOURCE_HANDLE;
+    return NO_ERROR;
+}
+
+t_Error Player_Source_Close(uint32_t playerHandle, uint32_t sourceHandle)
+{
+    if (playerHandle != SIM_PLAYER_HANDLE || sourceHandle != SIM_SOURCE_HANDLE || !sourceOpened)
+    {
+        return ERROR;
+    }
+
+    sourceOpened = 0;
+    return NO_ERROR;
+}
+
+t_Error Player_Stream_Create(uint32_t playerHandle, uint32_t sourceHandle, uint32_t PID, tStreamType streamType, uint32_t *streamHandle)
+{
+    int32_t i;
+
+    if (playerHandle != SIM_PLAYER_HANDLE || sourceHandle != SIM_SOURCE_HANDLE || !sourceOpened || PID >= TS_PID_COUNT || !streamHandle)
+    {
+        return ERROR;
+    }
+
+    if (streamType < AUDIO_TYPE_DOLBY_AC3 || streamType > VIDEO_TYPE_VP6F)
+    {
+        return ERROR;
+    }
+
+    sleepMs(getEnvValue("TDP_SIM_STREAM_SETUP_MS", 0));
+
+    pthread_mutex_lock(&simMutex);
+    for (i = 0; i < SIM_MAX_STREAMS; i++)
+    {
+        if (!streams[i].used)
+        {
+            streams[i].used = 1;
+            streams[i].pid = PID;
+            streams[i].type = streamType;
+
+            *streamHandle = SIM_STREAM_HANDLE_BASE + i;
+            pthread_mutex_unlock(&simMutex);
+            return NO_ERROR;
+        }
+    }
+    pthread_mutex_unlock(&simMutex);
+
+    return ERROR;
+}
+
+t_Error Player_Stream_Remove(uint32_t playerHandle, uint32_t sourceHandle, uint32_t streamHandle)
+{
+    uint32_t index = streamHandle - SIM_STREAM_HANDLE_BASE;
+
+    if (playerHandle != SIM_PLAYER_HANDLE || sourceHandle != SIM_SOURCE_HANDLE || index >= SIM_MAX_STREAMS)
+    {
+        return ERROR;
+    }
+
+    pthread_mutex_lock(&simMutex);
+    if (!streams[index].used)
+    {
+        pthread_mutex_unlock(&simMutex);
+        return ERROR;
+    }
+    streams[index].used = 0;
+    pthread_mutex_unlock(&simMutex);
+
+    sleepMs(getEnvValue("TDP_SIM_STREAM_SETUP_MS", 0));
+
+    return NO_ERROR;
+}
+
+t_Error Player_Volume_Set(uint32_t playerHandle, uint32_t volume)
+{
+    if (playerHandle != SIM_PLAYER_HANDLE || !playerInitialized)
+    {
+        return ERROR;
+    }
+
+    currentVolume = volume;
+    return NO_ERROR;
+}
+
+t_Error Player_Volume_Get(uint32_t playerHandle, uint32_t *volume)
+{
+    if (playerHandle != SIM_PLAYER_HANDLE || !playerInitialized || !volume)
+    {
+        return ERROR;
+    }
+
+    *volume = currentVolume;
+    return NO_ERROR;
+}
+/* -------------------- PLAYER -------------------- */
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for reading numeric simulator setting from environment.*/
+static uint32_t getEnvValue(const char *name, uint32_t defaultValue)
+{
+    const char *value = getenv(name);
+
+    if (!value || !*value)
+    {
+        return defaultValue;
+    }
+
+    return (uint32_t)strtoul(value, NULL, 0);
+}
+
+/*Function for sleeping given number of milliseconds.*/
+static void sleepMs(uint32_t milliseconds)
+{
+    struct timespec delay;
+
+    delay.tv_sec = milliseconds / 1000;
+    delay.tv_nsec = (milliseconds % 1000) * 1000000L;
+    nanosleep(&delay, NULL);
+}
+
+/*Function for checking if frequency in MHz is listed in TDP_SIM_FREQUENCIES, all frequencies carry signal if it is not set.*/
+static uint8_t hasSignal(uint32_t frequency)
+{
+    const char *list = getenv("TDP_SIM_FREQUENCIES");
+    char *end;
+
+    if (!list || !*list)
+    {
+        return 1;
+    }
+
+    while (*list)
+    {
+        if (strtoul(list, &end, 10) == frequency && end != list)
+        {
+            return 1;
+        }
+        list = *end ? end + 1 : end;
+    }
+
+    return 0;
+}
+
+/*Function for simulating tuner lock and starting capture playback.*/
+static void *lockThread(void *arg)
+{
+    Tuner_Status_Callback callback;
+    t_LockStatus status = STATUS_ERROR;
+    char envName[SIM_ENV_NAME_SIZE];
+    const char *fileName;
+    FILE *file = NULL;
+    uint32_t frequency;
+    uint8_t signal;
+
+    pthread_mutex_lock(&simMutex);
+    frequency = lockFrequency;
+    signal = lockSignal;
+    pthread_mutex_unlock(&simMutex);
+
+    /* frequency without signal never locks, failure is reported after a while as by the real tuner */
+    sleepMs(signal ? getEnvValue("TDP_SIM_LOCK_DELAY_MS", SIM_DEFAULT_LOCK_DELAY_MS)
+                   : getEnvValue("TDP_SIM_NO_SIGNAL_MS", SIM_DEFAULT_NO_SIGNAL_MS));
+
+    /* tuner was retuned meanwhile, newer lock thread reports */
+    pthread_mutex_lock(&simMutex);
+    if ((uint32_t)(uintptr_t)arg != lockRequests)
+    {
+        pthread_mutex_unlock(&simMutex);
+        reportStaleLock(signal ? STATUS_LOCKED : STATUS_ERROR);
+        return NULL;
+    }
+    pthread_mutex_unlock(&simMutex);
+
+    snprintf(envName, SIM_ENV_NAME_SIZE, "TDP_SIM_TS_FILE_%u", frequency / 1000000);
+    fileName = getenv(envName);
+    if (!fileName)
+    {
+        fileName = getenv("TDP_SIM_TS_FILE");
+    }
+
+    if (signal && fileName && (file = fopen(fileName, "rb")) != NULL)
+    {
+        status = STATUS_LOCKED;
+    }
+    else if (signal)
+    {
+        fprintf(stderr, "tdp_sim: cannot open TDP_SIM_TS_FILE (%s)\n", fileName ? fileName : "not set");
+    }
+
+    pthread_mutex_lock(&simMutex);
+    if ((uint32_t)(uintptr_t)arg != lockRequests)
+    {
+        pthread_mutex_unlock(&simMutex);
+        if (file)
+        {
+            fclose(file);
+        }
+        reportStaleLock(status);
+        return NULL;
+    }
+    tunerLocked = (status == STATUS_LOCKED);
+    callback = statusCallback;
+    if (file)
+    {
+        feederStop = 0;
+        feederRunning = !pthread_create(&feederThread, NULL, feederLoop, file);
+        if (!feederRunning)
+        {
+            fclose(file);
+        }
+    }
+    pthread_mutex_unlock(&simMutex);
+
+    if (callback)
+    {
+        callback(status);
+    }
+
+    return NULL;
+}
+
+/*Function for reporting status of replaced lock request when TDP_SIM_STALE_CALLBACKS is set, tuner state is not changed.*/
+static void reportStaleLock(t_LockStatus status)
+{
+    Tuner_Status_Callback callback;
+
+    if (!getEnvValue("TDP_SIM_STALE_CALLBACKS", 0))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&simMutex);
+    callback = tunerInitialized ? statusCallback : NULL;
+    pthread_mutex_unlock(&simMutex);
+
+    if (callback)
+    {
+        callback(status);
+    }
+}
+
+/*Function for stopping capture playback thread.*/
+static void stopFeeder()
+{
+    uint8_t running;
+
+    pthread_mutex_lock(&simMutex);
+    running = feederRunning;
+    feederRunning = 0;
+    feederStop = 1;
+    pthread_mutex_unlock(&simMutex);
+
+    if (running && !pthread_equal(pthread_self(), feederThread))
+    {
+        pthread_join(feederThread, NULL);
+    }
+}
+
+/*Function for reading capture, pacing it by PCR and dispatching packets to demux filters.*/
+static void *feederLoop(void *arg)
+{
+    FILE *file = (FILE *)arg;
+    uint8_t buffer[SIM_READ_PACKETS * TS_PACKET_SIZE];
+    uint8_t realtime = getEnvValue("TDP_SIM_REALTIME", 0) != 0;
+    uint32_t chunkPackets = realtime ? SIM_REALTIME_READ_PACKETS : SIM_READ_PACKETS;
+    struct timespec start;
+    int64_t firstPcr = -1;
+    int32_t pcrPid = -1;
+    size_t packetCount;
+
+    if (tsScannerInit(&scanner, SIM_READ_PACKETS))
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    /* partial sections of previous transponder are dropped */
+    updateActiveFilters(1);
+
+    while (!feederStop)
+    {
+        packetCount = fread(buffer, TS_PACKET_SIZE, chunkPackets, file);
+        if (packetCount == 0)
+        {
+            /* loop capture, PCR restarts from the beginning of the file */
+            rewind(file);
+            firstPcr = -1;
+            continue;
+        }
+
+        if (realtime)
+        {
+            paceByPcr(buffer, packetCount, &firstPcr, &pcrPid, &start);
+        }
+
+        dispatchPackets(buffer, packetCount);
+    }
+
+    tsScannerDeinit(&scanner);
+    fclose(file);
+    return NULL;
+}
+
+/*Function for sleeping until wall clock catches up with PCR carried in given packets.*/
+static void paceByPcr(uint8_t *buffer, uint32_t packetCount, int64_t *firstPcr, int32_t *pcrPid, struct timespec *start)
+{
+    struct timespec now;
+    int64_t pcr;
+    int64_t targetUs;
+    int64_t elapsedUs;
+    int32_t pid;
+    uint32_t i;
+
+    for (i = 0; i < packetCount; i++)
+    {
+        uint8_t *packet = buffer + i * TS_PACKET_SIZE;
+
+        if (packet[0] != TS_SYNC_BYTE || (pcr = readPcr(packet)) < 0)
+        {
+            continue;
+        }
+
+        pid = ((packet[1] & 0x1F) << 8) | packet[2];
+        if (*pcrPid < 0)
+        {
+            *pcrPid = pid;
+        }
+
+        if (pid != *pcrPid)
+        {
+            continue;
+        }
+
+        if (*firstPcr < 0 || pcr < *firstPcr)
+        {
+            *firstPcr = pcr;
+            clock_gettime(CLOCK_MONOTONIC, start);
+            continue;
+        }
+
+        targetUs = (pcr - *firstPcr) * 1000000 / PCR_CLOCK_HZ;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsedUs = (now.tv_sec - start->tv_sec) * 1000000LL + (now.tv_nsec - start->tv_nsec) / 1000;
+        if (targetUs > elapsedUs)
+        {
+            usleep(targetUs - elapsedUs);
+        }
+    }
+}
+
+/*Function for reading PCR from packet adaptation field, returns -1 if packet carries no PCR.*/
+static int64_t readPcr(uint8_t *packet)
+{
+    int64_t base;
+
+    if (!(packet[3] & 0x20) || packet[4] < 7 || !(packet[5] & 0x10))
+    {
+        return -1;
+    }
+
+    base = ((int64_t)packet[6] << 25) | (packet[7] << 17) | (packet[8] << 9) | (packet[9] << 1) | (packet[10] >> 7);
+    return base * 300 + (((packet[10] & 0x01) << 8) | packet[11]);
+}
+
+/*Function for sorting packets by PID and feeding them to section assemblers of filters set on that PID.*/
+static void dispatchPackets(uint8_t *buffer, uint32_t packetCount)
+{
+    tsPidBatch *batch;
+    uint32_t i;
+    uint32_t j;
+    uint32_t k;
+
+    updateActiveFilters(0);
+    tsScannerClassify(&scanner, buffer, packetCount);
+
+    /* filter freed meanwhile still gets packets of this chunk, deliverSection drops its sections */
+    for (i = 0; i < scanner.batchCount && !feederStop; i++)
+    {
+        batch = &scanner.batches[i];
+        for (k = 0; k < activeFilterCount; k++)
+        {
+            if (activeFilterPids[k] != batch->pid)
+            {
+                continue;
+            }
+
+            for (j = 0; j < batch->count; j++)
+            {
+                sectionAssemblerPushPacket(&filters[activeFilters[k]].assembler, buffer + batch->offsets[j]);
+            }
+        }
+    }
+}
+
+/*Function for copying set filters under lock, assembler of newly set filter (or every one on restart) is reinitialized.*/
+static void updateActiveFilters(uint8_t restart)
+{
+    uint32_t k;
+
+    pthread_mutex_lock(&simMutex);
+    if (!filtersChanged && !restart)
+    {
+        pthread_mutex_unlock(&simMutex);
+        return;
+    }
+
+    tsScannerClearPids(&scanner);
+    activeFilterCount = 0;
+    for (k = 0; k < SIM_MAX_FILTERS; k++)
+    {
+        if (!filters[k].used)
+        {
+            continue;
+        }
+
+        if (restart || filters[k].assemblerGeneration != filters[k].generation)
+        {
+            sectionAssemblerInit(&filters[k].assembler, filters[k].pid, deliverSection, &filters[k]);
+            filters[k].assemblerGeneration = filters[k].generation;
+        }
+        tsScannerAddPid(&scanner, filters[k].pid);
+        activeFilters[activeFilterCount] = k;
+        activeFilterPids[activeFilterCount++] = filters[k].pid;
+    }
+    filtersChanged = 0;
+    pthread_mutex_unlock(&simMutex);
+}
+
+/*Function for calling registered section callback if filter is still set for the section table id.*/
+static void deliverSection(uint8_t *section, uint16_t sectionLength, void *userData)
+{
+    simFilter *filter = (simFilter *)userData;
+    Demux_Section_Filter_Callback callback;
+
+    pthread_mutex_lock(&simMutex);
+    callback = sectionCallback;
+    if (!filter->used || filter->tableId != section[0] || filter->generation != filter->assemblerGeneration)
+    {
+        callback = NULL;
+    }
+    pthread_mutex_unlock(&simMutex);
+
+    /* callback is called without lock held, it is allowed to free filters */
+    if (callback)
+    {
+        callback(section);
+    }
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
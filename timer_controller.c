@@ -1,41 +1,334 @@
 #include "timer_controller.h"
+#include "event_loop.h"
 
-#include <signal.h>
+#include <errno.h>
+#include <stdio.h>
 #include <string.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
-void timerSetAndStart(timer_t *timerId, time_t triggerSec, void *callback)
+/* helper keywords needed only for timer controller module */
+#define NS_PER_TICK ((uint64_t)TIMER_TICK_MS * 1000000)
+#define EXPIRED_LIST TIMER_WHEEL_SLOTS // list index of timers waiting for their callback
+#define NO_TIMER (-1)
+#define HANDLE_INDEX_BITS 8
+#define HANDLE_INDEX_MASK ((1 << HANDLE_INDEX_BITS) - 1)
+
+/* armed timer is linked into list of its wheel slot, freed timer into free list */
+typedef struct _timerEntry
 {
-    struct sigevent signalEvent;
-    struct itimerspec timerSpec;
+    uint32_t generation; // changed on every free, so stale handles do not match
+    uint8_t used;
+    uint16_t list;   // wheel slot or EXPIRED_LIST
+    uint32_t rounds; // wheel turns left before expiry
+    int16_t prev;
+    int16_t next;
+    timerCallback callback;
+} timerEntry;
 
-    /* tell OS to send notification by calling specific function from specific thread*/
-    signalEvent.sigev_notify = SIGEV_THREAD;
+/* helper variables needed only for timer controller module */
+static timerEntry timers[TIMER_MAX_TIMERS];
+static int16_t listHead[TIMER_WHEEL_SLOTS + 1];
+static int16_t freeHead;
+static uint32_t armedCount;  // timerfd ticks only while a timer is armed
+static uint64_t currentTick; // last tick processed
+static uint64_t startTime;   // monotonic time of tick 0 in nanoseconds
+static int32_t tickFd = -1;
 
-    /* function which OS will call when interval expires */
-    signalEvent.sigev_notify_function = callback;
+/* helper functions needed only for timer controller module */
+static void tickReadable(int32_t fd, uint32_t events);
+static void startTicking();
+static void stopTicking();
+static void expireSlot(uint16_t slot);
+static timerEntry *lookupTimer(timerHandle handle);
+static void linkTimer(int16_t index, uint16_t list);
+static void unlinkTimer(int16_t index);
+static void freeTimer(int16_t index);
+static uint64_t monotonicNow();
 
-    /* function arguments */
-    signalEvent.sigev_value.sival_ptr = NULL;
+timerControllerStatus timerControllerInit()
+{
+    int16_t i;
 
-    /* thread attributes - if NULL default attributes are applied */
-    signalEvent.sigev_notify_attributes = NULL;
+    for (i = 0; i <= TIMER_WHEEL_SLOTS; i++)
+    {
+        listHead[i] = NO_TIMER;
+    }
 
-    /*parameters: system clock for time measurement, timer setup, where to put new timer ID*/
-    timer_create(CLOCK_REALTIME, &signalEvent, timerId);
+    /* every timer is put to free list, generation is kept so handles from before a restart stay stale */
+    for (i = 0; i < TIMER_MAX_TIMERS; i++)
+    {
+        timers[i].used = 0;
+        timers[i].next = i + 1 < TIMER_MAX_TIMERS ? i + 1 : NO_TIMER;
+    }
+    freeHead = 0;
+    armedCount = 0;
 
-    memset(&timerSpec, 0, sizeof(timerSpec));
-    /* timer initial value */
-    timerSpec.it_value.tv_sec = triggerSec;
-    timerSpec.it_value.tv_nsec = 0;
+    currentTick = 0;
+    startTime = monotonicNow();
+
+    tickFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tickFd < 0)
+    {
+        printf("timerControllerInit: %s\n", strerror(errno));
+        return TIMER_CONTROLLER_ERROR;
+    }
+
+    if (eventLoopAddSource(tickFd, tickReadable) != EVENT_LOOP_NO_ERROR)
+    {
+        close(tickFd);
+        tickFd = -1;
+        return TIMER_CONTROLLER_ERROR;
+    }
+
+    return TIMER_CONTROLLER_NO_ERROR;
+}
+
+timerControllerStatus timerControllerDeinit()
+{
+    int16_t i;
+
+    if (tickFd < 0)
+    {
+        return TIMER_CONTROLLER_ERROR;
+    }
+
+    eventLoopRemoveSource(tickFd);
+    close(tickFd);
+    tickFd = -1;
 
-    /* arms or disarms the timer identified by timerId */
-    timer_settime(*timerId, 0, &timerSpec, NULL);
+    /* drop timers still armed, their handles become stale */
+    for (i = 0; i < TIMER_MAX_TIMERS; i++)
+    {
+        if (timers[i].used)
+        {
+            freeTimer(i);
+        }
+    }
+
+    return TIMER_CONTROLLER_NO_ERROR;
 }
 
-void timerStopAndDelete(timer_t *timerId)
+timerControllerStatus timerSetAndStart(timerHandle *timer, time_t triggerSec, timerCallback callback)
+{
+    return timerSetAndStartMs(timer, triggerSec * 1000, callback);
+}
+
+timerControllerStatus timerSetAndStartMs(timerHandle *timer, uint32_t triggerMs, timerCallback callback)
+{
+    timerEntry *entry;
+    int16_t index;
+    uint64_t ticks = ((uint64_t)triggerMs + TIMER_TICK_MS - 1) / TIMER_TICK_MS;
+
+    if (!ticks)
+    {
+        ticks = 1;
+    }
+
+    if (tickFd < 0)
+    {
+        return TIMER_CONTROLLER_ERROR;
+    }
+
+    entry = lookupTimer(*timer);
+    if (entry)
+    {
+        /* re-arm, timer is moved from its slot (or expired list) to the new one */
+        index = entry - timers;
+        unlinkTimer(index);
+    }
+    else
+    {
+        if (freeHead == NO_TIMER)
+        {
+            printf("No free timers!\n");
+            return TIMER_CONTROLLER_ERROR;
+        }
+
+        if (!armedCount++)
+        {
+            startTicking();
+        }
+
+        index = freeHead;
+        entry = &timers[index];
+        freeHead = entry->next;
+        entry->used = 1;
+    }
+
+    /* slot is visited (ticks - 1) / TIMER_WHEEL_SLOTS times before the visit which expires timer */
+    entry->callback = callback;
+    entry->rounds = (ticks - 1) / TIMER_WHEEL_SLOTS;
+    linkTimer(index, (currentTick + ticks) % TIMER_WHEEL_SLOTS);
+
+    *timer = (entry->generation << HANDLE_INDEX_BITS) | (index + 1);
+
+    return TIMER_CONTROLLER_NO_ERROR;
+}
+
+void timerStopAndDelete(timerHandle *timer)
+{
+    timerEntry *entry = lookupTimer(*timer);
+
+    if (entry)
+    {
+        unlinkTimer(entry - timers);
+        freeTimer(entry - timers);
+    }
+    *timer = 0;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/****************************************************************************
+ * @brief    Function called by event loop on timerfd tick. Wheel is advanced
+ *           one slot per tick, ticks missed by a late wake up are caught up.
+ *           Expired timers are called one at a time, so a callback may arm
+ *           or cancel timers, and a timer cancelled or re-armed before its
+ *           turn is not called.
+****************************************************************************/
+static void tickReadable(int32_t fd, uint32_t events)
+{
+    uint64_t expirations;
+    uint64_t now;
+    timerCallback callback;
+    int16_t index;
+
+    if (read(fd, &expirations, sizeof(expirations)) < 0)
+    {
+        return;
+    }
+
+    now = monotonicNow();
+    while (armedCount && startTime + (currentTick + 1) * NS_PER_TICK <= now)
+    {
+        currentTick++;
+        expireSlot(currentTick % TIMER_WHEEL_SLOTS);
+
+        while (listHead[EXPIRED_LIST] != NO_TIMER)
+        {
+            index = listHead[EXPIRED_LIST];
+            callback = timers[index].callback;
+            unlinkTimer(index);
+            freeTimer(index);
+
+            callback();
+        }
+    }
+}
+
+/*Function for starting periodic timerfd on tick grid, ticks passed while idle are skipped.*/
+static void startTicking()
+{
+    struct itimerspec timerSpec;
+    uint64_t firstTick;
+
+    currentTick = (monotonicNow() - startTime) / NS_PER_TICK;
+    firstTick = startTime + (currentTick + 1) * NS_PER_TICK;
+
+    timerSpec.it_value.tv_sec = firstTick / 1000000000;
+    timerSpec.it_value.tv_nsec = firstTick % 1000000000;
+    timerSpec.it_interval.tv_sec = 0;
+    timerSpec.it_interval.tv_nsec = NS_PER_TICK;
+    timerfd_settime(tickFd, TFD_TIMER_ABSTIME, &timerSpec, NULL);
+}
+
+/*Function for disarming timerfd, so idle loop is not woken up.*/
+static void stopTicking()
 {
     struct itimerspec timerSpec;
+
     memset(&timerSpec, 0, sizeof(timerSpec));
-    timer_settime(timerId, 0, &timerSpec, NULL);
-    timer_delete(*timerId);
+    if (tickFd >= 0)
+    {
+        timerfd_settime(tickFd, 0, &timerSpec, NULL);
+    }
+}
+
+/*Function for moving timers of slot which are in their last round to expired list.*/
+static void expireSlot(uint16_t slot)
+{
+    int16_t index = listHead[slot];
+    int16_t next;
+
+    while (index != NO_TIMER)
+    {
+        next = timers[index].next;
+        if (timers[index].rounds)
+        {
+            timers[index].rounds--;
+        }
+        else
+        {
+            unlinkTimer(index);
+            linkTimer(index, EXPIRED_LIST);
+        }
+        index = next;
+    }
+}
+
+/*Function for finding armed timer of handle, returns NULL for zero or stale handle.*/
+static timerEntry *lookupTimer(timerHandle handle)
+{
+    uint32_t index = (handle & HANDLE_INDEX_MASK) - 1;
+
+    if (!handle || index >= TIMER_MAX_TIMERS || !timers[index].used ||
+        timers[index].generation != handle >> HANDLE_INDEX_BITS)
+    {
+        return NULL;
+    }
+
+    return &timers[index];
+}
+
+static void linkTimer(int16_t index, uint16_t list)
+{
+    timers[index].list = list;
+    timers[index].prev = NO_TIMER;
+    timers[index].next = listHead[list];
+    if (listHead[list] != NO_TIMER)
+    {
+        timers[listHead[list]].prev = index;
+    }
+    listHead[list] = index;
+}
+
+static void unlinkTimer(int16_t index)
+{
+    timerEntry *entry = &timers[index];
+
+    if (entry->prev != NO_TIMER)
+    {
+        timers[entry->prev].next = entry->next;
+    }
+    else
+    {
+        listHead[entry->list] = entry->next;
+    }
+    if (entry->next != NO_TIMER)
+    {
+        timers[entry->next].prev = entry->prev;
+    }
+}
+
+/*Function for returning unlinked timer to free list, its handles become stale.*/
+static void freeTimer(int16_t index)
+{
+    timers[index].used = 0;
+    timers[index].generation = (timers[index].generation + 1) & (UINT32_MAX >> HANDLE_INDEX_BITS);
+    timers[index].next = freeHead;
+    freeHead = index;
+
+    if (!--armedCount)
+    {
+        stopTicking();
+    }
+}
+
+static uint64_t monotonicNow()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
 }
+/* -------------------- HELPER FUNCTIONS -------------------- */
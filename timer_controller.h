@@ -1,12 +1,60 @@
 #ifndef _TIMER_CONTROLLER_H_
 #define _TIMER_CONTROLLER_H_
 
+#include <stdint.h>
 #include <time.h>
 
-/*Function for timer initialization.*/
-void timerSetAndStart(timer_t *timerId, time_t triggerSec, void *callback);
+#define TIMER_TICK_MS 10     // wheel resolution
+#define TIMER_WHEEL_SLOTS 256 // one wheel turn is 2.56 s, longer timers wait for more turns
+#define TIMER_MAX_TIMERS 32
 
-/*Function for timer deinitialization.*/
-void timerStopAndDelete(timer_t *timerId);
+typedef enum _timerControllerStatus
+{
+    TIMER_CONTROLLER_NO_ERROR = 0,
+    TIMER_CONTROLLER_ERROR
+} timerControllerStatus;
+
+/* 0 is never a valid handle, so zero initialized handle means "not armed" */
+typedef uint32_t timerHandle;
+
+typedef void (*timerCallback)();
+
+/****************************************************************************
+ * @brief    Function for adding wheel timerfd to event loop. Callbacks are
+ *           called on event loop thread, timer functions have to be called
+ *           from that thread too.
+ *
+ * @return   TIMER_CONTROLLER_NO_ERROR, if there are no errors.
+ *           TIMER_CONTROLLER_ERROR, in case of an error.
+****************************************************************************/
+timerControllerStatus timerControllerInit();
+
+/****************************************************************************
+ * @brief    Function for removing wheel timerfd from event loop. Armed timers
+ *           are dropped without calling their callbacks.
+ *
+ * @return   TIMER_CONTROLLER_NO_ERROR, if there are no errors.
+ *           TIMER_CONTROLLER_ERROR, in case of an error.
+****************************************************************************/
+timerControllerStatus timerControllerDeinit();
+
+/****************************************************************************
+ * @brief    Function for arming timer. If handle still refers to armed timer,
+ *           that timer is moved to new expiry instead of creating another one.
+ *
+ * @param    timer - [in/out] Timer handle, receives handle of armed timer.
+ *           triggerSec - [in] Seconds until callback is called.
+ *           callback - [in] Function called from event loop on expiry.
+ *
+ * @return   TIMER_CONTROLLER_NO_ERROR, if there are no errors.
+ *           TIMER_CONTROLLER_ERROR, if timer controller is not initialized or all timers are in use.
+****************************************************************************/
+timerControllerStatus timerSetAndStart(timerHandle *timer, time_t triggerSec, timerCallback callback);
+
+/*Function for arming timer with millisecond delay, rounded up to TIMER_TICK_MS. Same as timerSetAndStart otherwise.*/
+timerControllerStatus timerSetAndStartMs(timerHandle *timer, uint32_t triggerMs, timerCallback callback);
+
+/*Function for cancelling timer, handle is reset. Expired or already cancelled handles are ignored.*/
+void timerStopAndDelete(timerHandle *timer);
 
 #endif
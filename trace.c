@@ -0,0 +1,348 @@
+#include "trace.h"
+#include "event_loop.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+
+/* helper keywords needed only for trace module */
+#define TRACE_THREAD_NAME_SIZE 16
+
+typedef struct _traceEvent
+{
+    uint32_t sequence; // index + 1 of span held by slot, 0 while slot is written
+    const char *name;
+    uint64_t start;    // ns
+    uint64_t duration; // ns
+} traceEvent;
+
+/* written only by owning thread, writeIndex is published with release store */
+typedef struct _traceBuffer
+{
+    uint32_t threadId;
+    char threadName[TRACE_THREAD_NAME_SIZE];
+    uint32_t writeIndex;
+    traceEvent events[TRACE_BUFFER_EVENTS];
+} traceBuffer;
+
+/* helper variables needed only for trace module */
+uint8_t traceEnabled;
+
+static uint8_t statisticsEnabled;
+
+static traceBuffer *buffers[TRACE_MAX_THREADS];
+static uint32_t bufferCount;
+static uint32_t droppedThreads;
+static __thread traceBuffer *threadBuffer;
+static __thread uint8_t threadDropped;
+static int32_t dumpFileDesc = -1; // signalfd of TRACE_DUMP_SIGNAL
+
+/* helper functions needed only for trace module */
+static traceBuffer *getThreadBuffer();
+static uint8_t readEvent(traceBuffer *buffer, uint32_t index, traceEvent *copy);
+static void writeJsonString(FILE *file, const char *string);
+static void dumpSignalReadable(int32_t fd, uint32_t events);
+
+void traceInit()
+{
+    const char *fileName = getenv(TRACE_FILE_ENV);
+    const char *statistics = getenv(TRACE_STATISTICS_ENV);
+    sigset_t signals;
+
+    traceEnabled = fileName && *fileName;
+    statisticsEnabled = traceEnabled || (statistics && *statistics);
+    if (!traceEnabled)
+    {
+        return;
+    }
+
+    sigemptyset(&signals);
+    sigaddset(&signals, TRACE_DUMP_SIGNAL);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+}
+
+traceStatus traceDumpTriggerInit()
+{
+    sigset_t signals;
+
+    if (!traceEnabled)
+    {
+        return TRACE_NO_ERROR;
+    }
+
+    sigemptyset(&signals);
+    sigaddset(&signals, TRACE_DUMP_SIGNAL);
+    dumpFileDesc = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (dumpFileDesc < 0)
+    {
+        printf("traceDumpTriggerInit: %s\n", strerror(errno));
+        return TRACE_ERROR;
+    }
+
+    if (eventLoopAddSource(dumpFileDesc, dumpSignalReadable) != EVENT_LOOP_NO_ERROR)
+    {
+        close(dumpFileDesc);
+        dumpFileDesc = -1;
+        return TRACE_ERROR;
+    }
+
+    return TRACE_NO_ERROR;
+}
+
+traceStatus traceDumpTriggerDeinit()
+{
+    if (dumpFileDesc < 0)
+    {
+        return TRACE_NO_ERROR;
+    }
+
+    eventLoopRemoveSource(dumpFileDesc);
+    close(dumpFileDesc);
+    dumpFileDesc = -1;
+
+    return TRACE_NO_ERROR;
+}
+
+void traceStatistics(const char *format, ...)
+{
+    va_list arguments;
+
+    if (!statisticsEnabled)
+    {
+        return;
+    }
+
+    va_start(arguments, format);
+    vprintf(format, arguments);
+    va_end(arguments);
+}
+
+void traceSetThreadName(const char *name)
+{
+    traceBuffer *buffer;
+
+    if (!traceEnabled || !(buffer = getThreadBuffer()))
+    {
+        return;
+    }
+
+    strncpy(buffer->threadName, name, TRACE_THREAD_NAME_SIZE - 1);
+}
+
+uint64_t traceNow()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void traceRecord(const char *name, uint64_t start, uint64_t end)
+{
+    traceBuffer *buffer = getThreadBuffer();
+    traceEvent *event;
+    uint32_t index;
+
+    if (!buffer)
+    {
+        return;
+    }
+
+    index = buffer->writeIndex;
+    event = &buffer->events[index % TRACE_BUFFER_EVENTS];
+
+    /* slot is marked as being written first, dump drops it if sequence changes while it is copied */
+    __atomic_store_n(&event->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&event->name, name, __ATOMIC_RELAXED);
+    __atomic_store_n(&event->start, start, __ATOMIC_RELAXED);
+    __atomic_store_n(&event->duration, end - start, __ATOMIC_RELAXED);
+    __atomic_store_n(&event->sequence, index + 1, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&buffer->writeIndex, index + 1, __ATOMIC_RELEASE);
+}
+
+traceStatus traceDump(const char *fileName)
+{
+    FILE *file;
+    traceBuffer *buffer;
+    traceEvent event;
+    char threadName[TRACE_THREAD_NAME_SIZE];
+    uint32_t count;
+    uint32_t torn = 0;
+    uint32_t writeIndex;
+    uint32_t first;
+    uint32_t i;
+    uint32_t j;
+    uint8_t separator = 0;
+
+    if (!fileName)
+    {
+        fileName = getenv(TRACE_FILE_ENV);
+    }
+
+    if (!traceEnabled || !fileName)
+    {
+        return TRACE_ERROR;
+    }
+
+    file = fopen(fileName, "w");
+    if (!file)
+    {
+        return TRACE_ERROR;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+
+    count = __atomic_load_n(&bufferCount, __ATOMIC_ACQUIRE);
+    count = count > TRACE_MAX_THREADS ? TRACE_MAX_THREADS : count;
+    for (i = 0; i < count; i++)
+    {
+        buffer = __atomic_load_n(&buffers[i], __ATOMIC_ACQUIRE);
+        if (!buffer)
+        {
+            continue;
+        }
+
+        memcpy(threadName, buffer->threadName, TRACE_THREAD_NAME_SIZE);
+        threadName[TRACE_THREAD_NAME_SIZE - 1] = '\0';
+        if (threadName[0])
+        {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":",
+                    separator ? ",\n" : "", getpid(), buffer->threadId);
+            writeJsonString(file, threadName);
+            fprintf(file, "}}");
+            separator = 1;
+        }
+
+        /* only the newest TRACE_BUFFER_EVENTS spans are kept */
+        writeIndex = __atomic_load_n(&buffer->writeIndex, __ATOMIC_ACQUIRE);
+        first = writeIndex > TRACE_BUFFER_EVENTS ? writeIndex - TRACE_BUFFER_EVENTS : 0;
+        for (j = first; j < writeIndex; j++)
+        {
+            if (!readEvent(buffer, j, &event))
+            {
+                torn++;
+                continue;
+            }
+
+            fprintf(file, "%s{\"name\":", separator ? ",\n" : "");
+            writeJsonString(file, event.name);
+            fprintf(file, ",\"cat\":\"tv_app\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u}",
+                    event.start / 1000.0, event.duration / 1000.0, getpid(), buffer->threadId);
+            separator = 1;
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    if (droppedThreads)
+    {
+        printf("traceDump: spans of %u threads dropped, all %d trace buffers in use\n", droppedThreads, TRACE_MAX_THREADS);
+    }
+    if (torn)
+    {
+        printf("traceDump: %u spans dropped, overwritten while being written out\n", torn);
+    }
+
+    return TRACE_NO_ERROR;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for getting buffer of calling thread, buffer is allocated and published on first use.*/
+static traceBuffer *getThreadBuffer()
+{
+    uint32_t slot;
+
+    if (threadBuffer || threadDropped)
+    {
+        return threadBuffer;
+    }
+
+    slot = __atomic_fetch_add(&bufferCount, 1, __ATOMIC_ACQ_REL);
+    if (slot >= TRACE_MAX_THREADS)
+    {
+        threadDropped = 1;
+        __atomic_fetch_add(&droppedThreads, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    threadBuffer = (traceBuffer *)calloc(1, sizeof(traceBuffer));
+    if (!threadBuffer)
+    {
+        return NULL;
+    }
+
+    threadBuffer->threadId = (uint32_t)syscall(SYS_gettid);
+    __atomic_store_n(&buffers[slot], threadBuffer, __ATOMIC_RELEASE);
+
+    return threadBuffer;
+}
+
+/*Function for copying span recorded at index, returns 0 if slot holds another span or was overwritten during copy.*/
+static uint8_t readEvent(traceBuffer *buffer, uint32_t index, traceEvent *copy)
+{
+    traceEvent *event = &buffer->events[index % TRACE_BUFFER_EVENTS];
+
+    if (__atomic_load_n(&event->sequence, __ATOMIC_ACQUIRE) != index + 1)
+    {
+        return 0;
+    }
+
+    copy->name = __atomic_load_n(&event->name, __ATOMIC_RELAXED);
+    copy->start = __atomic_load_n(&event->start, __ATOMIC_RELAXED);
+    copy->duration = __atomic_load_n(&event->duration, __ATOMIC_RELAXED);
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&event->sequence, __ATOMIC_RELAXED) == index + 1;
+}
+
+/*Function for writing string as JSON string literal, quotes, backslashes and control characters are escaped.*/
+static void writeJsonString(FILE *file, const char *string)
+{
+    const unsigned char *character;
+
+    fputc('"', file);
+    for (character = (const unsigned char *)string; *character; character++)
+    {
+        if (*character == '"' || *character == '\\')
+        {
+            fprintf(file, "\\%c", *character);
+        }
+        else if (*character < 0x20)
+        {
+            fprintf(file, "\\u%04x", *character);
+        }
+        else
+        {
+            fputc(*character, file);
+        }
+    }
+    fputc('"', file);
+}
+
+/*Function for writing trace file on event loop once dump signal was received, signals received meanwhile give one dump.*/
+static void dumpSignalReadable(int32_t fd, uint32_t events)
+{
+    struct signalfd_siginfo info;
+    uint8_t received = 0;
+
+    while (read(fd, &info, sizeof(info)) == sizeof(info))
+    {
+        received = 1;
+    }
+
+    if (received && traceDump(NULL) == TRACE_NO_ERROR)
+    {
+        printf("Trace written to %s\n", getenv(TRACE_FILE_ENV));
+    }
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
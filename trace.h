@@ -0,0 +1,98 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+#include <signal.h>
+
+#define TRACE_FILE_ENV "TV_APP_TRACE" // tracing is enabled when set, value is output file name
+#define TRACE_DUMP_SIGNAL SIGUSR1     // writes trace file while application runs, e.g. kill -USR1 <pid>
+#define TRACE_STATISTICS_ENV "TV_APP_STATISTICS" // module statistics are printed on deinit when set
+#define TRACE_MAX_THREADS 64
+#define TRACE_BUFFER_EVENTS 4096 // per thread, oldest spans are overwritten
+
+typedef enum _traceStatus
+{
+    TRACE_NO_ERROR = 0,
+    TRACE_ERROR
+} traceStatus;
+
+/* set once by traceInit, read on every span */
+extern uint8_t traceEnabled;
+
+/* span around SDK or other call, result receives return value of call */
+#define TRACE_CALL(result, name, call)              \
+    {                                               \
+        uint64_t traceCallStart = traceBegin();     \
+        result = call;                              \
+        traceEnd(name, traceCallStart);             \
+    }
+
+/*Function for enabling tracing when TV_APP_TRACE environment variable is set. Has to be called before any
+  thread is started: TRACE_DUMP_SIGNAL is blocked here, so threads inherit the mask and the signal is only
+  received through traceDumpTriggerInit.*/
+void traceInit();
+
+/****************************************************************************
+ * @brief    Function for dumping trace on event loop whenever process gets
+ *           TRACE_DUMP_SIGNAL. Does nothing when tracing is disabled.
+ *
+ * @return   TRACE_NO_ERROR, if there are no errors or tracing is disabled.
+ *           TRACE_ERROR, if signal descriptor can not be created or added to loop.
+****************************************************************************/
+traceStatus traceDumpTriggerInit();
+
+/*Function for removing dump trigger from event loop.*/
+traceStatus traceDumpTriggerDeinit();
+
+/*Function for printing module statistics on deinit, output is dropped unless TV_APP_STATISTICS or TV_APP_TRACE is set.*/
+void traceStatistics(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/*Function for naming calling thread in trace output.*/
+void traceSetThreadName(const char *name);
+
+/*Function for reading monotonic time in nanoseconds.*/
+uint64_t traceNow();
+
+/*Function for storing finished span in buffer of calling thread. Name has to be a string literal.*/
+void traceRecord(const char *name, uint64_t start, uint64_t end);
+
+/****************************************************************************
+ * @brief    Function for writing all recorded spans as Chrome trace-event JSON
+ *           (load in chrome://tracing or Perfetto). Can be called at any time,
+ *           spans recorded while dumping may be missing from output, span
+ *           overwritten while it is read is dropped.
+ *
+ * @param    fileName - [in] Output file, NULL for file named by TV_APP_TRACE.
+ *
+ * @return   TRACE_NO_ERROR, if there are no errors.
+ *           TRACE_ERROR, if tracing is disabled or file can not be written.
+****************************************************************************/
+traceStatus traceDump(const char *fileName);
+
+#ifdef TRACE_DISABLED
+static inline uint64_t traceBegin()
+{
+    return 0;
+}
+
+static inline void traceEnd(const char *name, uint64_t start)
+{
+}
+#else
+/*Function for starting span, returns 0 when tracing is disabled.*/
+static inline uint64_t traceBegin()
+{
+    return traceEnabled ? traceNow() : 0;
+}
+
+/*Function for finishing span started with traceBegin.*/
+static inline void traceEnd(const char *name, uint64_t start)
+{
+    if (start)
+    {
+        traceRecord(name, start, traceNow());
+    }
+}
+#endif // TRACE_DISABLED
+
+#endif // _TRACE_H_
@@ -0,0 +1,328 @@
+#include "ts_scanner.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* vector paths are built only on request, they did not beat the scalar loop reliably (see ts_scanner_benchmark) */
+#if defined(TS_SCANNER_SIMD) && defined(__AVX2__)
+#define TS_SCANNER_AVX2
+#elif defined(TS_SCANNER_SIMD) && defined(__SSE2__)
+#define TS_SCANNER_SSE2
+#endif
+
+#if defined(TS_SCANNER_AVX2) || defined(TS_SCANNER_SSE2)
+#include <immintrin.h>
+#endif
+
+/* helper keywords needed only for ts scanner module */
+#define TRANSPORT_ERROR_BIT 0x80
+
+/* helper functions needed only for ts scanner module */
+static void resetBatches(tsScanner *scanner);
+static inline uint32_t loadHeader(const uint8_t *packet);
+static inline void classifyHeader(tsScanner *scanner, uint32_t header, uint32_t offset);
+#if defined(TS_SCANNER_AVX2)
+static uint32_t classifyAvx2(tsScanner *scanner, const uint8_t *buffer, uint32_t packetCount);
+#elif defined(TS_SCANNER_SSE2)
+static uint32_t classifySse2(tsScanner *scanner, const uint8_t *buffer, uint32_t packetCount);
+#endif
+
+tsScannerStatus tsScannerInit(tsScanner *scanner, uint32_t maxPackets)
+{
+    memset(scanner, 0, sizeof(tsScanner));
+    scanner->maxPackets = maxPackets;
+
+    scanner->batches[TS_SCANNER_UNTRACKED_SLOT].offsets = (uint32_t *)malloc(maxPackets * sizeof(uint32_t));
+    if (!scanner->batches[TS_SCANNER_UNTRACKED_SLOT].offsets)
+    {
+        return TS_SCANNER_ERROR;
+    }
+
+    tsScannerClearPids(scanner);
+
+    return TS_SCANNER_NO_ERROR;
+}
+
+void tsScannerDeinit(tsScanner *scanner)
+{
+    int32_t i;
+
+    for (i = 0; i <= TS_SCANNER_MAX_PIDS; i++)
+    {
+        free(scanner->batches[i].offsets);
+        scanner->batches[i].offsets = NULL;
+    }
+}
+
+tsScannerStatus tsScannerAddPid(tsScanner *scanner, uint16_t pid)
+{
+    tsPidBatch *batch;
+
+    if (pid >= TS_PID_COUNT || scanner->batchCount == TS_SCANNER_MAX_PIDS)
+    {
+        return TS_SCANNER_ERROR;
+    }
+
+    if (scanner->pidSlot[pid] != TS_SCANNER_UNTRACKED_SLOT)
+    {
+        /* already tracked */
+        return TS_SCANNER_NO_ERROR;
+    }
+
+    /* batch storage is kept between clears and reused */
+    batch = &scanner->batches[scanner->batchCount];
+    if (!batch->offsets)
+    {
+        batch->offsets = (uint32_t *)malloc(scanner->maxPackets * sizeof(uint32_t));
+        if (!batch->offsets)
+        {
+            return TS_SCANNER_ERROR;
+        }
+    }
+
+    batch->pid = pid;
+    batch->count = 0;
+    scanner->pidSlot[pid] = scanner->batchCount++;
+
+    return TS_SCANNER_NO_ERROR;
+}
+
+void tsScannerClearPids(tsScanner *scanner)
+{
+    memset(scanner->pidSlot, TS_SCANNER_UNTRACKED_SLOT, sizeof(scanner->pidSlot));
+    scanner->batchCount = 0;
+    resetBatches(scanner);
+}
+
+uint32_t tsScannerClassify(tsScanner *scanner, const uint8_t *buffer, uint32_t packetCount)
+{
+#if defined(TS_SCANNER_AVX2)
+    return classifyAvx2(scanner, buffer, packetCount);
+#elif defined(TS_SCANNER_SSE2)
+    return classifySse2(scanner, buffer, packetCount);
+#else
+    return tsScannerClassifyScalar(scanner, buffer, packetCount);
+#endif
+}
+
+uint32_t tsScannerClassifyScalar(tsScanner *scanner, const uint8_t *buffer, uint32_t packetCount)
+{
+    uint32_t i;
+
+    if (packetCount > scanner->maxPackets)
+    {
+        packetCount = scanner->maxPackets;
+    }
+
+    resetBatches(scanner);
+
+    for (i = 0; i < packetCount; i++)
+    {
+        classifyHeader(scanner, loadHeader(buffer + i * TS_PACKET_SIZE), i * TS_PACKET_SIZE);
+    }
+
+    return packetCount - scanner->syncErrors;
+}
+
+const char *tsScannerImplementation()
+{
+#if defined(TS_SCANNER_AVX2)
+    return "AVX2";
+#elif defined(TS_SCANNER_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for emptying all batches before a new scan.*/
+static void resetBatches(tsScanner *scanner)
+{
+    int32_t i;
+
+    for (i = 0; i < scanner->batchCount; i++)
+    {
+        scanner->batches[i].count = 0;
+    }
+    scanner->batches[TS_SCANNER_UNTRACKED_SLOT].count = 0;
+    scanner->syncErrors = 0;
+    scanner->transportErrors = 0;
+}
+
+/*Function for reading first four packet bytes as little endian word (sync byte in lowest byte).*/
+static inline uint32_t loadHeader(const uint8_t *packet)
+{
+    return packet[0] | (packet[1] << 8) | (packet[2] << 16) | ((uint32_t)packet[3] << 24);
+}
+
+/*Function for appending packet offset to batch of its PID.*/
+static inline void classifyHeader(tsScanner *scanner, uint32_t header, uint32_t offset)
+{
+    tsPidBatch *batch;
+
+    if ((header & 0xFF) != TS_SYNC_BYTE)
+    {
+        scanner->syncErrors++;
+        return;
+    }
+
+    if (header & (TRANSPORT_ERROR_BIT << 8))
+    {
+        scanner->transportErrors++;
+        return;
+    }
+
+    /* untracked PIDs map to sink slot, so there is no branch on lookup result */
+    batch = &scanner->batches[scanner->pidSlot[(header & 0x1F00) | ((header >> 16) & 0xFF)]];
+    batch->offsets[batch->count++] = offset;
+}
+
+#if defined(TS_SCANNER_AVX2)
+/*Function for classifying eight packets per iteration, headers are fetched with one gather.*/
+static uint32_t classifyAvx2(tsScanner *scanner, const uint8_t *buffer, uint32_t packetCount)
+{
+    const __m256i packetIndex = _mm256_setr_epi32(0, 1 * TS_PACKET_SIZE, 2 * TS_PACKET_SIZE, 3 * TS_PACKET_SIZE,
+                                                  4 * TS_PACKET_SIZE, 5 * TS_PACKET_SIZE, 6 * TS_PACKET_SIZE, 7 * TS_PACKET_SIZE);
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256i syncByte = _mm256_set1_epi32(TS_SYNC_BYTE);
+    const __m256i errorBit = _mm256_set1_epi32(TRANSPORT_ERROR_BIT << 8);
+    const __m256i pidHighMask = _mm256_set1_epi32(0x1F00);
+    uint32_t pids[8] __attribute__((aligned(32)));
+    uint32_t i;
+    uint32_t j;
+
+    if (packetCount > scanner->maxPackets)
+    {
+        packetCount = scanner->maxPackets;
+    }
+
+    resetBatches(scanner);
+
+    for (i = 0; i + 8 <= packetCount; i += 8)
+    {
+        const uint8_t *block = buffer + i * TS_PACKET_SIZE;
+        __m256i header = _mm256_i32gather_epi32((const int *)block, packetIndex, 1);
+        __m256i valid = _mm256_cmpeq_epi32(_mm256_and_si256(header, byteMask), syncByte);
+        __m256i error = _mm256_cmpeq_epi32(_mm256_and_si256(header, errorBit), errorBit);
+        __m256i pid = _mm256_or_si256(_mm256_and_si256(header, pidHighMask),
+                                      _mm256_and_si256(_mm256_srli_epi32(header, 16), byteMask));
+        uint32_t validMask = _mm256_movemask_ps(_mm256_castsi256_ps(valid));
+        uint32_t errorMask = _mm256_movemask_ps(_mm256_castsi256_ps(error));
+        __m256i samePid;
+
+        if (validMask != 0xFF || errorMask)
+        {
+            /* rare case, handle block packet by packet */
+            for (j = 0; j < 8; j++)
+            {
+                classifyHeader(scanner, loadHeader(block + j * TS_PACKET_SIZE), (i + j) * TS_PACKET_SIZE);
+            }
+            continue;
+        }
+
+        /* video and stuffing come in long single PID runs, whole block goes to one batch with one store */
+        samePid = _mm256_cmpeq_epi32(pid, _mm256_permutevar8x32_epi32(pid, _mm256_setzero_si256()));
+        if (_mm256_movemask_ps(_mm256_castsi256_ps(samePid)) == 0xFF)
+        {
+            tsPidBatch *batch = &scanner->batches[scanner->pidSlot[_mm256_cvtsi256_si32(pid)]];
+            _mm256_storeu_si256((__m256i *)(batch->offsets + batch->count),
+                                _mm256_add_epi32(packetIndex, _mm256_set1_epi32(i * TS_PACKET_SIZE)));
+            batch->count += 8;
+            continue;
+        }
+
+        _mm256_store_si256((__m256i *)pids, pid);
+        for (j = 0; j < 8; j++)
+        {
+            tsPidBatch *batch = &scanner->batches[scanner->pidSlot[pids[j]]];
+            batch->offsets[batch->count++] = (i + j) * TS_PACKET_SIZE;
+        }
+    }
+
+    for (; i < packetCount; i++)
+    {
+        classifyHeader(scanner, loadHeader(buffer + i * TS_PACKET_SIZE), i * TS_PACKET_SIZE);
+    }
+
+    return packetCount - scanner->syncErrors;
+}
+#elif defined(TS_SCANNER_SSE2)
+/*Function for classifying four packets per iteration.*/
+static uint32_t classifySse2(tsScanner *scanner, const uint8_t *buffer, uint32_t packetCount)
+{
+    const __m128i packetIndex = _mm_setr_epi32(0, 1 * TS_PACKET_SIZE, 2 * TS_PACKET_SIZE, 3 * TS_PACKET_SIZE);
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    const __m128i syncByte = _mm_set1_epi32(TS_SYNC_BYTE);
+    const __m128i errorBit = _mm_set1_epi32(TRANSPORT_ERROR_BIT << 8);
+    const __m128i pidHighMask = _mm_set1_epi32(0x1F00);
+    uint32_t pids[4] __attribute__((aligned(16)));
+    uint32_t words[4];
+    uint32_t i;
+    uint32_t j;
+
+    if (packetCount > scanner->maxPackets)
+    {
+        packetCount = scanner->maxPackets;
+    }
+
+    resetBatches(scanner);
+
+    for (i = 0; i + 4 <= packetCount; i += 4)
+    {
+        const uint8_t *block = buffer + i * TS_PACKET_SIZE;
+        __m128i header;
+        __m128i valid;
+        __m128i error;
+        __m128i pid;
+        uint32_t validMask;
+        uint32_t errorMask;
+
+        memcpy(&words[0], block, 4);
+        memcpy(&words[1], block + TS_PACKET_SIZE, 4);
+        memcpy(&words[2], block + 2 * TS_PACKET_SIZE, 4);
+        memcpy(&words[3], block + 3 * TS_PACKET_SIZE, 4);
+        header = _mm_loadu_si128((const __m128i *)words);
+
+        valid = _mm_cmpeq_epi32(_mm_and_si128(header, byteMask), syncByte);
+        error = _mm_cmpeq_epi32(_mm_and_si128(header, errorBit), errorBit);
+        pid = _mm_or_si128(_mm_and_si128(header, pidHighMask), _mm_and_si128(_mm_srli_epi32(header, 16), byteMask));
+        validMask = _mm_movemask_ps(_mm_castsi128_ps(valid));
+        errorMask = _mm_movemask_ps(_mm_castsi128_ps(error));
+
+        if (validMask != 0x0F || errorMask)
+        {
+            for (j = 0; j < 4; j++)
+            {
+                classifyHeader(scanner, loadHeader(block + j * TS_PACKET_SIZE), (i + j) * TS_PACKET_SIZE);
+            }
+            continue;
+        }
+
+        /* single PID run, whole block goes to one batch with one store */
+        if (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(pid, _mm_shuffle_epi32(pid, 0)))) == 0x0F)
+        {
+            tsPidBatch *batch = &scanner->batches[scanner->pidSlot[_mm_cvtsi128_si32(pid)]];
+            _mm_storeu_si128((__m128i *)(batch->offsets + batch->count),
+                             _mm_add_epi32(packetIndex, _mm_set1_epi32(i * TS_PACKET_SIZE)));
+            batch->count += 4;
+            continue;
+        }
+
+        _mm_store_si128((__m128i *)pids, pid);
+        for (j = 0; j < 4; j++)
+        {
+            tsPidBatch *batch = &scanner->batches[scanner->pidSlot[pids[j]]];
+            batch->offsets[batch->count++] = (i + j) * TS_PACKET_SIZE;
+        }
+    }
+
+    for (; i < packetCount; i++)
+    {
+        classifyHeader(scanner, loadHeader(buffer + i * TS_PACKET_SIZE), i * TS_PACKET_SIZE);
+    }
+
+    return packetCount - scanner->syncErrors;
+}
+#endif
+/* -------------------- HELPER FUNCTIONS -------------------- */
@@ -0,0 +1,56 @@
+#ifndef _TS_SCANNER_H_
+#define _TS_SCANNER_H_
+
+#include "section_assembler.h"
+
+#define TS_SCANNER_MAX_PIDS 64
+#define TS_SCANNER_UNTRACKED_SLOT TS_SCANNER_MAX_PIDS // packets of other PIDs are collected here
+
+typedef enum _tsScannerStatus
+{
+    TS_SCANNER_NO_ERROR = 0,
+    TS_SCANNER_ERROR
+} tsScannerStatus;
+
+/* offsets (in bytes from buffer start) of all packets of one PID found in last scanned buffer */
+typedef struct _tsPidBatch
+{
+    uint16_t pid;
+    uint32_t count;
+    uint32_t *offsets;
+} tsPidBatch;
+
+typedef struct _tsScanner
+{
+    int8_t pidSlot[TS_PID_COUNT];
+    tsPidBatch batches[TS_SCANNER_MAX_PIDS + 1];
+    uint8_t batchCount;
+    uint32_t maxPackets;
+
+    /* results of last scan, untracked packets are in batches[TS_SCANNER_UNTRACKED_SLOT] */
+    uint32_t syncErrors;
+    uint32_t transportErrors;
+} tsScanner;
+
+/*Function for allocating scanner able to classify buffers of up to maxPackets packets.*/
+tsScannerStatus tsScannerInit(tsScanner *scanner, uint32_t maxPackets);
+
+/*Function for freeing scanner memory.*/
+void tsScannerDeinit(tsScanner *scanner);
+
+/*Function for adding PID whose packets are collected into a batch.*/
+tsScannerStatus tsScannerAddPid(tsScanner *scanner, uint16_t pid);
+
+/*Function for removing all tracked PIDs.*/
+void tsScannerClearPids(tsScanner *scanner);
+
+/*Function for checking sync bytes and sorting packet offsets into per-PID batches, vector path only when built with TS_SCANNER_SIMD.*/
+uint32_t tsScannerClassify(tsScanner *scanner, const uint8_t *buffer, uint32_t packetCount);
+
+/*Function for classifying packets with plain per-packet loop, used as fallback and as benchmark reference.*/
+uint32_t tsScannerClassifyScalar(tsScanner *scanner, const uint8_t *buffer, uint32_t packetCount);
+
+/*Function returning name of instruction set used by tsScannerClassify.*/
+const char *tsScannerImplementation();
+
+#endif // _TS_SCANNER_H_
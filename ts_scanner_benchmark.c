@@ -0,0 +1,195 @@
+/**
+ * @file ts_scanner_benchmark.c
+ *
+ * @brief Microbenchmark comparing vectorised and scalar packet classification of ts_scanner.
+ *
+ * Usage: ts_scanner_benchmark [capture.ts]
+ * Without argument a synthetic multiplex with 48 PIDs is generated. The benchmark
+ * is built with TS_SCANNER_SIMD, the application uses the vector path only when
+ * it is built with that flag as well.
+ */
+
+#include "ts_scanner.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* helper keywords needed only for benchmark */
+#define BENCHMARK_PACKETS 200000
+#define BENCHMARK_CHUNK_PACKETS 4096
+#define BENCHMARK_ROUNDS 20
+#define BENCHMARK_PIDS 48
+#define BENCHMARK_TRACKED_PIDS 32
+#define NULL_PID 0x1FFF
+
+typedef uint32_t (*classifyFunction)(tsScanner *scanner, const uint8_t *buffer, uint32_t packetCount);
+
+/* helper functions needed only for benchmark */
+static uint8_t *generateMultiplex(uint32_t packetCount, uint16_t *pids);
+static uint8_t *loadCapture(const char *fileName, uint32_t *packetCount);
+static double runClassifier(tsScanner *scanner, classifyFunction classify, const uint8_t *buffer, uint32_t packetCount, uint64_t *checksum);
+
+int main(int argc, char **argv)
+{
+    tsScanner scanner;
+    uint16_t pids[BENCHMARK_PIDS];
+    uint8_t *buffer;
+    uint32_t packetCount = BENCHMARK_PACKETS;
+    uint64_t scalarChecksum;
+    uint64_t vectorChecksum;
+    double scalarSeconds;
+    double vectorSeconds;
+    int32_t i;
+
+    if (argc > 1)
+    {
+        buffer = loadCapture(argv[1], &packetCount);
+    }
+    else
+    {
+        buffer = generateMultiplex(packetCount, pids);
+    }
+
+    if (!buffer || tsScannerInit(&scanner, BENCHMARK_CHUNK_PACKETS))
+    {
+        printf("Benchmark setup failed!\n");
+        return 1;
+    }
+
+    /* track PAT, EIT and a typical set of PMT and elementary stream PIDs */
+    tsScannerAddPid(&scanner, 0x0000);
+    tsScannerAddPid(&scanner, 0x0012);
+    for (i = 0; i < BENCHMARK_TRACKED_PIDS - 2; i++)
+    {
+        tsScannerAddPid(&scanner, 0x0100 + i * 0x10);
+    }
+
+    scalarSeconds = runClassifier(&scanner, tsScannerClassifyScalar, buffer, packetCount, &scalarChecksum);
+    vectorSeconds = runClassifier(&scanner, tsScannerClassify, buffer, packetCount, &vectorChecksum);
+
+    printf("packets per round: %u, best of %d rounds\n", packetCount, BENCHMARK_ROUNDS);
+    printf("scalar: %10.2f Mpackets/s\n", packetCount / scalarSeconds / 1e6);
+    printf("%-6s: %10.2f Mpackets/s\n", tsScannerImplementation(), packetCount / vectorSeconds / 1e6);
+    printf("speedup: %.2fx\n", scalarSeconds / vectorSeconds);
+
+    if (scalarChecksum != vectorChecksum)
+    {
+        printf("Results of scalar and %s path differ!\n", tsScannerImplementation());
+        return 1;
+    }
+
+    tsScannerDeinit(&scanner);
+    free(buffer);
+
+    return 0;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/*Function for generating packets with random PIDs, roughly a fifth of them null packets.*/
+static uint8_t *generateMultiplex(uint32_t packetCount, uint16_t *pids)
+{
+    uint8_t *buffer = (uint8_t *)malloc((size_t)packetCount * TS_PACKET_SIZE);
+    uint32_t i;
+
+    if (!buffer)
+    {
+        return NULL;
+    }
+
+    pids[0] = 0x0000;
+    pids[1] = 0x0012;
+    for (i = 2; i < BENCHMARK_PIDS; i++)
+    {
+        pids[i] = 0x0100 + (i - 2) * 0x10;
+    }
+
+    srand(1);
+    for (i = 0; i < packetCount; i++)
+    {
+        uint8_t *packet = buffer + (size_t)i * TS_PACKET_SIZE;
+        uint16_t pid = (rand() % 5 == 0) ? NULL_PID : pids[rand() % BENCHMARK_PIDS];
+
+        memset(packet, 0xFF, TS_PACKET_SIZE);
+        packet[0] = TS_SYNC_BYTE;
+        packet[1] = (pid >> 8) & 0x1F;
+        packet[2] = pid & 0xFF;
+        packet[3] = 0x10 | (i & 0x0F);
+    }
+
+    return buffer;
+}
+
+/*Function for loading whole capture file into memory.*/
+static uint8_t *loadCapture(const char *fileName, uint32_t *packetCount)
+{
+    FILE *file = fopen(fileName, "rb");
+    uint8_t *buffer;
+    long size;
+
+    if (!file)
+    {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    rewind(file);
+
+    *packetCount = size / TS_PACKET_SIZE;
+    buffer = (uint8_t *)malloc((size_t)*packetCount * TS_PACKET_SIZE);
+    if (buffer && fread(buffer, TS_PACKET_SIZE, *packetCount, file) != *packetCount)
+    {
+        free(buffer);
+        buffer = NULL;
+    }
+
+    fclose(file);
+    return buffer;
+}
+
+/*Function for timing classifier over whole buffer in demux sized chunks, returns fastest round.*/
+static double runClassifier(tsScanner *scanner, classifyFunction classify, const uint8_t *buffer, uint32_t packetCount, uint64_t *checksum)
+{
+    struct timespec start;
+    struct timespec end;
+    double seconds;
+    double bestSeconds = 0;
+    uint32_t offset;
+    uint32_t chunk;
+    int32_t round;
+    int32_t i;
+
+    *checksum = 0;
+
+    for (round = 0; round < BENCHMARK_ROUNDS; round++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (offset = 0; offset < packetCount; offset += chunk)
+        {
+            chunk = packetCount - offset < BENCHMARK_CHUNK_PACKETS ? packetCount - offset : BENCHMARK_CHUNK_PACKETS;
+            classify(scanner, buffer + (size_t)offset * TS_PACKET_SIZE, chunk);
+
+            /* consume results, so work can not be optimised away and both paths can be compared */
+            for (i = 0; i < scanner->batchCount; i++)
+            {
+                *checksum += scanner->batches[i].count * (i + 1);
+                if (scanner->batches[i].count)
+                {
+                    *checksum += scanner->batches[i].offsets[scanner->batches[i].count - 1];
+                }
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        if (round == 0 || seconds < bestSeconds)
+        {
+            bestSeconds = seconds;
+        }
+    }
+
+    return bestSeconds;
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
@@ -1,12 +1,15 @@
 #include "remote_controller.h"
+#include "config_watcher.h"
+#include "graphics_controller.h"
+#include "timer_controller.h"
+#include "event_loop.h"
+#include "trace.h"
 
-#include <pthread.h>
+#include <stdlib.h>
 
 int main(int argc, char **argv)
 {
     initialConfig config;
-    pthread_t remoteThreadHandle;
-    pthread_t channelsSetupHandle;
 
     if (argc != 2)
     {
@@ -14,12 +17,24 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    /* tracing is enabled by TV_APP_TRACE environment variable */
+    traceInit();
+    traceSetThreadName("main");
+
     /* parse initial configuration file  */
     ASSERT_TDP_RESULT(parseConfigurationFile(argv[1], &config), "parseConfigurationFile");
 
+    /* event loop initialization, input, OSD timeouts and sections are handled on main thread */
+    ASSERT_TDP_RESULT(eventLoopInit(), "eventLoopInit");
+
+    /* trace is written on TRACE_DUMP_SIGNAL too, not only at exit */
+    ASSERT_TDP_RESULT(traceDumpTriggerInit(), "traceDumpTriggerInit");
+
+    /* timer initialization, OSD and channel number timers run on event loop */
+    ASSERT_TDP_RESULT(timerControllerInit(), "timerControllerInit");
+
     /* remote controller initialization */
     ASSERT_TDP_RESULT(remoteControllerInit(), "remoteControllerInit");
-    ASSERT_TDP_RESULT(pthread_create(&remoteThreadHandle, NULL, &remoteControllerEvent, NULL), "remote controller thread create");
 
     /* graphics controller initialization */
     ASSERT_TDP_RESULT(graphicsControllerInit(), "graphicsControllerInit");
@@ -28,15 +43,29 @@ int main(int argc, char **argv)
     ASSERT_TDP_RESULT(streamControllerInit(&config), "streamControllerInit");
     ASSERT_TDP_RESULT(startPlayerStream(&config.startingChannel), "startPlayerStream");
 
-    /* channel configuration thread initialization */
-    ASSERT_TDP_RESULT(pthread_create(&channelsSetupHandle, NULL, &channelsSetup, NULL), "channel setup thread create");
+    /* channel scan is started here and continues on event loop */
+    ASSERT_TDP_RESULT(channelsSetup(), "channelsSetup");
 
-    /* wait for exit key press */
-    ASSERT_TDP_RESULT(pthread_join(remoteThreadHandle, NULL), "remote controller thread handle join");
+    /* configuration file changes are applied without restart */
+    ASSERT_TDP_RESULT(configWatcherInit(argv[1], &config), "configWatcherInit");
+
+    /* handle events until exit key press */
+    eventLoopRun();
 
     /* deinitialization and deallocation */
+    ASSERT_TDP_RESULT(configWatcherDeinit(), "configWatcherDeinit");
+    ASSERT_TDP_RESULT(remoteControllerDeinit(), "remoteControllerDeinit");
     ASSERT_TDP_RESULT(streamControllerDeinit(), "streamControllerDeinit");
     ASSERT_TDP_RESULT(graphicsControllerDeinit(), "graphicsControllerDeinit");
+    ASSERT_TDP_RESULT(timerControllerDeinit(), "timerControllerDeinit");
+    ASSERT_TDP_RESULT(traceDumpTriggerDeinit(), "traceDumpTriggerDeinit");
+    ASSERT_TDP_RESULT(eventLoopDeinit(), "eventLoopDeinit");
+    freeConfiguration(&config);
+
+    if (traceEnabled && traceDump(NULL) == TRACE_NO_ERROR)
+    {
+        printf("Trace written to %s\n", getenv(TRACE_FILE_ENV));
+    }
 
     return 0;
 }
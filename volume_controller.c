@@ -0,0 +1,175 @@
+#include "volume_controller.h"
+#include "graphics_controller.h"
+#include "timer_controller.h"
+#include "trace.h"
+
+#include <stdio.h>
+#include <limits.h>
+
+/* helper keywords needed only for volume controller module */
+#define VOLUME_MAX INT_MAX
+#define VOLUME_MIN 0
+#define VOLUME_STEP (VOLUME_MAX / 20) // increase volume by 5%
+
+/* helper variables needed only for volume controller module */
+static uint32_t player;
+static uint32_t currentVolume; // level shown and restored on unmute, player is never read after init
+static uint8_t volumeMuted;
+static uint32_t playerVolume; // last value written to player
+static uint8_t changePending; // change made while frame window was open
+static timerHandle frameTimer; // armed while frame window is open
+
+/* helper functions needed only for volume controller module */
+static volumeControllerStatus volumeChanged();
+static volumeControllerStatus applyVolume();
+static volumeControllerStatus writeVolume();
+static void frameElapsed();
+
+volumeControllerStatus volumeControllerInit(uint32_t playerHandle)
+{
+    uint8_t result;
+
+    player = playerHandle;
+
+    TRACE_CALL(result, "Player_Volume_Get", Player_Volume_Get(player, &currentVolume));
+    if (result != NO_ERROR)
+    {
+        printf("volumeControllerInit: Player_Volume_Get fail\n");
+        return VOLUME_CONTROLLER_ERROR;
+    }
+
+    playerVolume = currentVolume;
+    volumeMuted = 0;
+    changePending = 0;
+
+    return VOLUME_CONTROLLER_NO_ERROR;
+}
+
+volumeControllerStatus volumeControllerDeinit()
+{
+    timerStopAndDelete(&frameTimer);
+
+    /* last change of a burst may still be waiting for its frame, bar is not redrawn any more */
+    changePending = 0;
+
+    return writeVolume();
+}
+
+volumeControllerStatus volumeMute()
+{
+    volumeMuted = !volumeMuted;
+
+    return volumeChanged();
+}
+
+volumeControllerStatus volumeUp()
+{
+    /* key press while muted only unmutes, as it always did */
+    if (!volumeMuted)
+    {
+        currentVolume = currentVolume > VOLUME_MAX - VOLUME_STEP ? VOLUME_MAX : currentVolume + VOLUME_STEP;
+    }
+    volumeMuted = 0;
+
+    return volumeChanged();
+}
+
+volumeControllerStatus volumeDown()
+{
+    if (!volumeMuted)
+    {
+        currentVolume = currentVolume < VOLUME_MIN + VOLUME_STEP ? VOLUME_MIN : currentVolume - VOLUME_STEP;
+    }
+    volumeMuted = 0;
+
+    return volumeChanged();
+}
+
+volumeControllerStatus showVolumeInfo()
+{
+    uint8_t result;
+    float volumePercent;
+
+    if (volumeMuted)
+        volumePercent = 0.0;
+    else
+        volumePercent = (float)currentVolume / VOLUME_MAX;
+
+    result = drawVolumeInfo(volumePercent);
+    if (result != GRAPHICS_CONTROLLER_NO_ERROR)
+    {
+        printf("showVolumeInfo: drawVolumeInfo fail\n");
+        return VOLUME_CONTROLLER_ERROR;
+    }
+
+    drawOnScreen();
+
+    return VOLUME_CONTROLLER_NO_ERROR;
+}
+
+/* -------------------- HELPER FUNCTIONS -------------------- */
+/****************************************************************************
+ * @brief    Function for applying changed level at most once per frame.
+ *           First change is applied at once and opens a frame window, changes
+ *           made while window is open (key autorepeat) are merged and applied
+ *           when it closes.
+****************************************************************************/
+static volumeControllerStatus volumeChanged()
+{
+    if (frameTimer)
+    {
+        changePending = 1;
+        return VOLUME_CONTROLLER_NO_ERROR;
+    }
+
+    timerSetAndStartMs(&frameTimer, VOLUME_FRAME_MS, frameElapsed);
+
+    return applyVolume();
+}
+
+/*Function for writing level to player and redrawing volume bar.*/
+static volumeControllerStatus applyVolume()
+{
+    if (writeVolume() != VOLUME_CONTROLLER_NO_ERROR)
+    {
+        return VOLUME_CONTROLLER_ERROR;
+    }
+
+    return showVolumeInfo();
+}
+
+/*Function for writing level to player, SDK is only called if level differs from the last written one.*/
+static volumeControllerStatus writeVolume()
+{
+    uint8_t result;
+    uint32_t volume = volumeMuted ? VOLUME_MIN : currentVolume;
+
+    if (volume == playerVolume)
+    {
+        return VOLUME_CONTROLLER_NO_ERROR;
+    }
+
+    TRACE_CALL(result, "Player_Volume_Set", Player_Volume_Set(player, volume));
+    if (result != NO_ERROR)
+    {
+        printf("writeVolume: Player_Volume_Set fail\n");
+        return VOLUME_CONTROLLER_ERROR;
+    }
+    playerVolume = volume;
+
+    return VOLUME_CONTROLLER_NO_ERROR;
+}
+
+/*Function for closing frame window at timer trigger, window stays open while changes keep coming.*/
+static void frameElapsed()
+{
+    frameTimer = 0;
+
+    if (changePending)
+    {
+        changePending = 0;
+        timerSetAndStartMs(&frameTimer, VOLUME_FRAME_MS, frameElapsed);
+        applyVolume();
+    }
+}
+/* -------------------- HELPER FUNCTIONS -------------------- */
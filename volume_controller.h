@@ -0,0 +1,40 @@
+#ifndef _VOLUME_CONTROLLER_H_
+#define _VOLUME_CONTROLLER_H_
+
+#include <stdint.h>
+
+#define VOLUME_FRAME_MS 40 // one SDK volume set and one bar redraw per frame at most (25 fps)
+
+typedef enum _volumeControllerStatus
+{
+    VOLUME_CONTROLLER_NO_ERROR = 0,
+    VOLUME_CONTROLLER_ERROR
+} volumeControllerStatus;
+
+/****************************************************************************
+ * @brief    Function for reading initial volume of player once. Later volume
+ *           level is kept in memory, player is only written.
+ *
+ * @param    playerHandle - [in] Handle of initialized player.
+ *
+ * @return   VOLUME_CONTROLLER_NO_ERROR, if there are no errors.
+ *           VOLUME_CONTROLLER_ERROR, in case of an error.
+****************************************************************************/
+volumeControllerStatus volumeControllerInit(uint32_t playerHandle);
+
+/*Function for writing pending volume change to player, has to be called before player is deinitialized.*/
+volumeControllerStatus volumeControllerDeinit();
+
+/*Function for muting or unmuting volume.*/
+volumeControllerStatus volumeMute();
+
+/*Function for increasing volume.*/
+volumeControllerStatus volumeUp();
+
+/*Function for decreasing volume.*/
+volumeControllerStatus volumeDown();
+
+/*Function for calling functions for drawing and showing channel volume banner.*/
+volumeControllerStatus showVolumeInfo();
+
+#endif // _VOLUME_CONTROLLER_H_